@@ -28,12 +28,18 @@ if %ERRORLEVEL% EQU 0 (
     g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/ElectionData.cpp -o obj/ElectionData.o
     g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/CSVReader.cpp -o obj/CSVReader.o
     g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/ElectionAnalyzer.cpp -o obj/ElectionAnalyzer.o
+    g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/QuantileSketch.cpp -o obj/QuantileSketch.o
+    g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/SearchIndex.cpp -o obj/SearchIndex.o
+    g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/ElectionCube.cpp -o obj/ElectionCube.o
+    g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/JSONWriter.cpp -o obj/JSONWriter.o
+    g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/RecordStore.cpp -o obj/RecordStore.o
+    g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/Trace.cpp -o obj/Trace.o
+    g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/BinaryWriter.cpp -o obj/BinaryWriter.o
     
     REM Link main
-    g++ -std=c++17 -Wall -Wextra -O2 -Iinclude obj/ElectionData.o obj/CSVReader.o obj/ElectionAnalyzer.o src/main.cpp -o bin/election_analysis.exe
+    g++ -std=c++17 -Wall -Wextra -O2 -Iinclude obj/ElectionData.o obj/CSVReader.o obj/ElectionAnalyzer.o obj/QuantileSketch.o obj/SearchIndex.o obj/ElectionCube.o obj/JSONWriter.o obj/RecordStore.o obj/Trace.o obj/BinaryWriter.o src/main.cpp -o bin/election_analysis.exe
     
-    REM Link tests
-    g++ -std=c++17 -Wall -Wextra -O2 -Iinclude obj/ElectionData.o obj/CSVReader.o obj/ElectionAnalyzer.o tests/test_main.cpp -o bin/election_tests.exe
+    REM The tests cover the web server too; build_web.bat links them
     
     echo.
     echo Build complete! Executables are in bin\
@@ -28,9 +28,102 @@ echo   Compiling HTTPServer...
 g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/HTTPServer.cpp -o obj/HTTPServer.o
 if errorlevel 1 goto error
 
+echo   Compiling QuantileSketch...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/QuantileSketch.cpp -o obj/QuantileSketch.o
+if errorlevel 1 goto error
+
+echo   Compiling SearchIndex...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/SearchIndex.cpp -o obj/SearchIndex.o
+if errorlevel 1 goto error
+
+echo   Compiling ElectionCube...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/ElectionCube.cpp -o obj/ElectionCube.o
+if errorlevel 1 goto error
+
+echo   Compiling ThreadPool...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/ThreadPool.cpp -o obj/ThreadPool.o
+if errorlevel 1 goto error
+
+echo   Compiling HTTPServerEpoll...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/HTTPServerEpoll.cpp -o obj/HTTPServerEpoll.o
+if errorlevel 1 goto error
+
+echo   Compiling BufferPool...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/BufferPool.cpp -o obj/BufferPool.o
+if errorlevel 1 goto error
+
+echo   Compiling RequestParser...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/RequestParser.cpp -o obj/RequestParser.o
+if errorlevel 1 goto error
+
+echo   Compiling StaticAssetCache...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/StaticAssetCache.cpp -o obj/StaticAssetCache.o
+if errorlevel 1 goto error
+
+echo   Compiling OutputQueue...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/OutputQueue.cpp -o obj/OutputQueue.o
+if errorlevel 1 goto error
+
+echo   Compiling ResponseCache...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/ResponseCache.cpp -o obj/ResponseCache.o
+if errorlevel 1 goto error
+
+echo   Compiling JSONWriter...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/JSONWriter.cpp -o obj/JSONWriter.o
+if errorlevel 1 goto error
+
+echo   Compiling Compressor...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/Compressor.cpp -o obj/Compressor.o
+if errorlevel 1 goto error
+
+echo   Compiling LiveHub...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/LiveHub.cpp -o obj/LiveHub.o
+if errorlevel 1 goto error
+
+echo   Compiling AdmissionControl...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/AdmissionControl.cpp -o obj/AdmissionControl.o
+if errorlevel 1 goto error
+
+echo   Compiling RecordStore...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/RecordStore.cpp -o obj/RecordStore.o
+if errorlevel 1 goto error
+
+echo   Compiling WriteAheadLog...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/WriteAheadLog.cpp -o obj/WriteAheadLog.o
+if errorlevel 1 goto error
+
+echo   Compiling ServerMetrics...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/ServerMetrics.cpp -o obj/ServerMetrics.o
+if errorlevel 1 goto error
+
+echo   Compiling Trace...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/Trace.cpp -o obj/Trace.o
+if errorlevel 1 goto error
+
+echo   Compiling IoUring...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/IoUring.cpp -o obj/IoUring.o
+if errorlevel 1 goto error
+
+echo   Compiling HTTPServerUring...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/HTTPServerUring.cpp -o obj/HTTPServerUring.o
+if errorlevel 1 goto error
+
+echo   Compiling BinaryWriter...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/BinaryWriter.cpp -o obj/BinaryWriter.o
+if errorlevel 1 goto error
+
+echo   Compiling AnalysisMemo...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/AnalysisMemo.cpp -o obj/AnalysisMemo.o
+if errorlevel 1 goto error
+
 echo.
 echo Linking web executable...
-g++ -std=c++17 -Wall -Wextra -O2 -Iinclude obj/ElectionData.o obj/CSVReader.o obj/ElectionAnalyzer.o obj/HTTPServer.o src/main_web.cpp -o bin/election_web.exe -lws2_32
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude obj/ElectionData.o obj/CSVReader.o obj/ElectionAnalyzer.o obj/HTTPServer.o obj/QuantileSketch.o obj/SearchIndex.o obj/ElectionCube.o obj/ThreadPool.o obj/HTTPServerEpoll.o obj/BufferPool.o obj/RequestParser.o obj/StaticAssetCache.o obj/OutputQueue.o obj/ResponseCache.o obj/JSONWriter.o obj/Compressor.o obj/LiveHub.o obj/AdmissionControl.o obj/RecordStore.o obj/WriteAheadLog.o obj/ServerMetrics.o obj/Trace.o obj/IoUring.o obj/HTTPServerUring.o obj/BinaryWriter.o obj/AnalysisMemo.o src/main_web.cpp -o bin/election_web.exe -lws2_32
+if errorlevel 1 goto error
+
+echo.
+echo Linking test executable...
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude obj/ElectionData.o obj/CSVReader.o obj/ElectionAnalyzer.o obj/HTTPServer.o obj/QuantileSketch.o obj/SearchIndex.o obj/ElectionCube.o obj/ThreadPool.o obj/HTTPServerEpoll.o obj/BufferPool.o obj/RequestParser.o obj/StaticAssetCache.o obj/OutputQueue.o obj/ResponseCache.o obj/JSONWriter.o obj/Compressor.o obj/LiveHub.o obj/AdmissionControl.o obj/RecordStore.o obj/WriteAheadLog.o obj/ServerMetrics.o obj/Trace.o obj/IoUring.o obj/HTTPServerUring.o obj/BinaryWriter.o obj/AnalysisMemo.o tests/test_main.cpp -o bin/election_tests.exe -lws2_32
 if errorlevel 1 goto error
 
 echo.
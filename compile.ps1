@@ -59,7 +59,14 @@ Write-Host "Using compiler: $compiler" -ForegroundColor Cyan
 $sourceFiles = @(
     "ElectionData.cpp",
     "CSVReader.cpp",
-    "ElectionAnalyzer.cpp"
+    "ElectionAnalyzer.cpp",
+    "QuantileSketch.cpp",
+    "SearchIndex.cpp",
+    "ElectionCube.cpp",
+    "JSONWriter.cpp",
+    "RecordStore.cpp",
+    "Trace.cpp",
+    "BinaryWriter.cpp"
 )
 
 $objectFiles = @()
@@ -103,22 +110,6 @@ if ($LASTEXITCODE -ne 0) {
     exit 1
 }
 
-# Link test executable
-Write-Host "Linking test executable..." -ForegroundColor Yellow
-$testSource = Join-Path $projectDir "tests\test_main.cpp"
-$testExe = Join-Path $binDir "election_tests.exe"
-
-if ($compiler -eq "cl") {
-    & $compiler $compilerFlags $objectFiles $testSource /Fe:$testExe
-} else {
-    & $compiler $compilerFlags $objectFiles $testSource -o $testExe
-}
-
-if ($LASTEXITCODE -ne 0) {
-    Write-Host "WARNING: Failed to link test executable" -ForegroundColor Yellow
-} else {
-    Write-Host "Build complete!" -ForegroundColor Green
-    Write-Host "Main executable: $mainExe" -ForegroundColor Cyan
-    Write-Host "Test executable: $testExe" -ForegroundColor Cyan
-}
-
+# The tests cover the web server too; compile_web.ps1 links them
+Write-Host "Build complete!" -ForegroundColor Green
+Write-Host "Main executable: $mainExe" -ForegroundColor Cyan
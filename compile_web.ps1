@@ -19,7 +19,29 @@ $sources = @(
     @{Name="ElectionData"; File="src/ElectionData.cpp"},
     @{Name="CSVReader"; File="src/CSVReader.cpp"},
     @{Name="ElectionAnalyzer"; File="src/ElectionAnalyzer.cpp"},
-    @{Name="HTTPServer"; File="src/HTTPServer.cpp"}
+    @{Name="HTTPServer"; File="src/HTTPServer.cpp"},
+    @{Name="QuantileSketch"; File="src/QuantileSketch.cpp"},
+    @{Name="SearchIndex"; File="src/SearchIndex.cpp"},
+    @{Name="ElectionCube"; File="src/ElectionCube.cpp"},
+    @{Name="ThreadPool"; File="src/ThreadPool.cpp"},
+    @{Name="HTTPServerEpoll"; File="src/HTTPServerEpoll.cpp"},
+    @{Name="BufferPool"; File="src/BufferPool.cpp"},
+    @{Name="RequestParser"; File="src/RequestParser.cpp"},
+    @{Name="StaticAssetCache"; File="src/StaticAssetCache.cpp"},
+    @{Name="OutputQueue"; File="src/OutputQueue.cpp"},
+    @{Name="ResponseCache"; File="src/ResponseCache.cpp"},
+    @{Name="JSONWriter"; File="src/JSONWriter.cpp"},
+    @{Name="Compressor"; File="src/Compressor.cpp"},
+    @{Name="LiveHub"; File="src/LiveHub.cpp"},
+    @{Name="AdmissionControl"; File="src/AdmissionControl.cpp"},
+    @{Name="RecordStore"; File="src/RecordStore.cpp"},
+    @{Name="WriteAheadLog"; File="src/WriteAheadLog.cpp"},
+    @{Name="ServerMetrics"; File="src/ServerMetrics.cpp"},
+    @{Name="Trace"; File="src/Trace.cpp"},
+    @{Name="IoUring"; File="src/IoUring.cpp"},
+    @{Name="HTTPServerUring"; File="src/HTTPServerUring.cpp"},
+    @{Name="BinaryWriter"; File="src/BinaryWriter.cpp"},
+    @{Name="AnalysisMemo"; File="src/AnalysisMemo.cpp"}
 )
 
 $success = $true
@@ -45,7 +67,19 @@ if (-not $success) {
 # Link web executable
 Write-Host ""
 Write-Host "Linking web executable..." -ForegroundColor Yellow
-$output = g++ -std=c++17 -Wall -Wextra -O2 -Iinclude obj/ElectionData.o obj/CSVReader.o obj/ElectionAnalyzer.o obj/HTTPServer.o src/main_web.cpp -o bin/election_web.exe -lws2_32 2>&1
+$output = g++ -std=c++17 -Wall -Wextra -O2 -Iinclude obj/ElectionData.o obj/CSVReader.o obj/ElectionAnalyzer.o obj/HTTPServer.o obj/QuantileSketch.o obj/SearchIndex.o obj/ElectionCube.o obj/ThreadPool.o obj/HTTPServerEpoll.o obj/BufferPool.o obj/RequestParser.o obj/StaticAssetCache.o obj/OutputQueue.o obj/ResponseCache.o obj/JSONWriter.o obj/Compressor.o obj/LiveHub.o obj/AdmissionControl.o obj/RecordStore.o obj/WriteAheadLog.o obj/ServerMetrics.o obj/Trace.o obj/IoUring.o obj/HTTPServerUring.o obj/BinaryWriter.o obj/AnalysisMemo.o src/main_web.cpp -o bin/election_web.exe -lws2_32 2>&1
+
+if ($LASTEXITCODE -eq 0) {
+    Write-Host "  Linking... OK" -ForegroundColor Green
+} else {
+    Write-Host "  Linking... FAILED" -ForegroundColor Red
+    Write-Host $output
+    exit 1
+}
+
+# Link test executable
+Write-Host "Linking test executable..." -ForegroundColor Yellow
+$output = g++ -std=c++17 -Wall -Wextra -O2 -Iinclude obj/ElectionData.o obj/CSVReader.o obj/ElectionAnalyzer.o obj/HTTPServer.o obj/QuantileSketch.o obj/SearchIndex.o obj/ElectionCube.o obj/ThreadPool.o obj/HTTPServerEpoll.o obj/BufferPool.o obj/RequestParser.o obj/StaticAssetCache.o obj/OutputQueue.o obj/ResponseCache.o obj/JSONWriter.o obj/Compressor.o obj/LiveHub.o obj/AdmissionControl.o obj/RecordStore.o obj/WriteAheadLog.o obj/ServerMetrics.o obj/Trace.o obj/IoUring.o obj/HTTPServerUring.o obj/BinaryWriter.o obj/AnalysisMemo.o tests/test_main.cpp -o bin/election_tests.exe -lws2_32 2>&1
 
 if ($LASTEXITCODE -eq 0) {
     Write-Host "  Linking... OK" -ForegroundColor Green
@@ -0,0 +1,89 @@
+#ifndef ADMISSION_CONTROL_H
+#define ADMISSION_CONTROL_H
+
+#include <string>
+#include <atomic>
+
+/**
+ * @brief How expensive an API endpoint is to compute
+ */
+enum class CostClass {
+    Cheap,      // Lookups answered from indexes (countries, server stats)
+    Standard,   // One election's aggregates or a bounded list
+    Heavy       // Several elections or arbitrary cube slices
+};
+
+/**
+ * @brief Counters of one cost class
+ */
+struct CostClassStats {
+    int inFlight;
+    int limit;          // 0 = unlimited
+    long long admitted;
+    long long shed;
+};
+
+/**
+ * @brief Per-cost-class concurrency limits for API requests
+ *
+ * While the server is saturated, a request is admitted only if fewer
+ * than its class limit of the same class are being computed, so heavy
+ * comparisons can never occupy every worker and starve cheap lookups.
+ * With spare capacity every request is admitted. Refused requests are
+ * meant to be answered at once with 503 and Retry-After. Lock-free;
+ * counters are atomics shared by all threads.
+ */
+class AdmissionControl {
+public:
+    AdmissionControl(int standardLimit, int heavyLimit);
+
+    static CostClass classify(const std::string& endpoint);
+    static const char* className(CostClass cost);
+
+    /**
+     * @brief Take a slot of the class; false if the request should be shed
+     *
+     * Limits are only enforced when saturated is true (work is waiting).
+     */
+    bool tryAdmit(CostClass cost, bool saturated);
+
+    /**
+     * @brief Give back a slot taken by tryAdmit
+     */
+    void release(CostClass cost);
+
+    /**
+     * @brief Count a connection refused before any request was read
+     */
+    void recordShedConnection();
+
+    CostClassStats getStats(CostClass cost) const;
+    long long shedConnections() const;
+
+private:
+    static const int CLASS_COUNT = 3;
+
+    int limits[CLASS_COUNT];
+    std::atomic<int> inFlight[CLASS_COUNT];
+    std::atomic<long long> admitted[CLASS_COUNT];
+    std::atomic<long long> shed[CLASS_COUNT];
+    std::atomic<long long> shedConnectionCount;
+};
+
+/**
+ * @brief Gives back a slot taken by AdmissionControl::tryAdmit when it goes out of scope
+ */
+class AdmissionSlot {
+public:
+    AdmissionSlot(AdmissionControl& control, CostClass cost) : control(control), cost(cost) {}
+    ~AdmissionSlot() { control.release(cost); }
+
+    AdmissionSlot(const AdmissionSlot&) = delete;
+    AdmissionSlot& operator=(const AdmissionSlot&) = delete;
+
+private:
+    AdmissionControl& control;
+    CostClass cost;
+};
+
+#endif // ADMISSION_CONTROL_H
@@ -0,0 +1,60 @@
+#ifndef ANALYSIS_MEMO_H
+#define ANALYSIS_MEMO_H
+
+#include "ElectionAnalyzer.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <future>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief Analyzer results shared by the queries of one batch
+ *
+ * The sub-queries of a POST /api/batch tend to ask about the same few
+ * elections: their statistics, a comparison of two of them, their top
+ * candidates. Each election is aggregated once, by the first query that
+ * needs it; queries arriving meanwhile wait for that result rather than
+ * computing it again, while queries about other elections proceed in
+ * parallel. A comparison reuses the statistics of both its elections,
+ * and top-candidate queries of one election share a single ranking
+ * whatever their n. A memo reads one dataset snapshot and lives as long
+ * as its batch. Thread-safe.
+ */
+class AnalysisMemo {
+public:
+    explicit AnalysisMemo(ElectionData& data);
+
+    AnalysisMemo(const AnalysisMemo&) = delete;
+    AnalysisMemo& operator=(const AnalysisMemo&) = delete;
+
+    /**
+     * @brief ElectionAnalyzer::calculateElectionStats, computed once per election
+     */
+    ElectionStats electionStats(const std::string& country, int year);
+
+    /**
+     * @brief ElectionAnalyzer::compareElections from the shared statistics
+     */
+    ComparativeAnalysis compareElections(const std::string& country, int year1, int year2);
+
+    /**
+     * @brief ElectionAnalyzer::getTopCandidates, ranking each election once
+     */
+    std::vector<ElectionRecord> topCandidates(const std::string& country, int year, int n);
+
+private:
+    typedef std::pair<std::string, int> ElectionKey;
+
+    ElectionData& data;
+    std::mutex mutex;
+    std::map<ElectionKey, std::shared_future<ElectionStats>> stats;
+    std::map<ElectionKey, std::shared_future<std::vector<ElectionRecord>>> rankings;
+
+    template <typename T, typename Compute>
+    std::shared_future<T> shared(std::map<ElectionKey, std::shared_future<T>>& results,
+                                 const ElectionKey& key, Compute compute);
+};
+
+#endif // ANALYSIS_MEMO_H
@@ -0,0 +1,96 @@
+#ifndef BINARY_WRITER_H
+#define BINARY_WRITER_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Binary encodings BinaryWriter can produce
+ */
+enum class BinaryFormat {
+    MessagePack,
+    CBOR        // RFC 8949
+};
+
+/**
+ * @brief Streaming MessagePack/CBOR writer with the JSONWriter interface
+ *
+ * Code that serializes through a template Writer parameter can emit JSON,
+ * MessagePack or CBOR from the same calls. Both formats want the element
+ * count ahead of a map or array, which a streaming writer does not know
+ * yet, so each container header is inserted when the container is closed,
+ * in its smallest encoding. Integers also take their smallest encoding
+ * and doubles are written as 64-bit floats; non-finite doubles are
+ * written as null, as JSONWriter does.
+ *
+ * Containers may nest up to MAX_DEPTH levels.
+ *
+ * Example:
+ *   std::string out;
+ *   BinaryWriter writer(out, BinaryFormat::MessagePack);
+ *   writer.beginObject().field("country", "Jordan").field("year", 2016).endObject();
+ */
+class BinaryWriter {
+public:
+    static const size_t MAX_DEPTH = 16;
+
+    BinaryWriter(std::string& out, BinaryFormat format);
+
+    BinaryWriter& beginObject();
+    BinaryWriter& endObject();
+    BinaryWriter& beginArray();
+    BinaryWriter& endArray();
+
+    /**
+     * @brief Write a map key; the next value belongs to it
+     */
+    BinaryWriter& key(const char* name);
+    BinaryWriter& key(const std::string& name);
+
+    BinaryWriter& value(const std::string& text);
+    BinaryWriter& value(const char* text);
+    BinaryWriter& value(bool flag);
+    BinaryWriter& value(int number);
+    BinaryWriter& value(long number);
+    BinaryWriter& value(long long number);
+    BinaryWriter& value(unsigned long number);
+    BinaryWriter& value(unsigned long long number);
+    BinaryWriter& value(double number);
+    BinaryWriter& null();
+
+    /**
+     * @brief Write one value that is already encoded in this format
+     */
+    BinaryWriter& raw(const std::string& encoded);
+
+    /**
+     * @brief Shorthand for key(name).value(v)
+     */
+    template <typename T>
+    BinaryWriter& field(const char* name, const T& v) {
+        key(name);
+        return value(v);
+    }
+
+private:
+    struct Container {
+        size_t start;       // Offset of the first element in out
+        uint32_t count;     // Keys for a map, elements for an array
+        bool isMap;
+    };
+
+    std::string& out;
+    BinaryFormat format;
+    Container open[MAX_DEPTH];
+    size_t depth;
+
+    void counted();
+    BinaryWriter& begin(bool isMap);
+    BinaryWriter& end();
+    void text(const char* data, size_t length);
+    void signedInteger(long long number);
+    void unsignedInteger(unsigned long long number);
+};
+
+#endif // BINARY_WRITER_H
@@ -0,0 +1,36 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Pool of reusable byte buffers
+ *
+ * Not thread-safe: each worker or event loop thread owns its own pool,
+ * so connections reuse buffers instead of allocating new ones.
+ */
+class BufferPool {
+public:
+    BufferPool(size_t bufferSize, size_t maxPooled);
+    ~BufferPool();
+
+    /**
+     * @brief Take a buffer of at least bufferSize bytes
+     */
+    std::vector<char>* acquire();
+
+    /**
+     * @brief Give a buffer back (oversized buffers are freed instead)
+     */
+    void release(std::vector<char>* buffer);
+
+    size_t pooled() const { return freeBuffers.size(); }
+
+private:
+    size_t bufferSize;
+    size_t maxPooled;
+    std::vector<std::vector<char>*> freeBuffers;
+};
+
+#endif // BUFFER_POOL_H
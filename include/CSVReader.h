@@ -20,6 +20,14 @@ public:
      */
     static ElectionRecord parseLine(const std::string& line);
 
+    /**
+     * @brief Parse one CSV line, rejecting it unless every field is valid
+     *
+     * Needs exactly seven columns, a country, a candidate, a year between
+     * 1 and 9999 and a vote count that fits in an int, both plain digits.
+     */
+    static bool tryParseLine(const std::string& line, ElectionRecord& record);
+
 private:
     /**
      * @brief Split a string by comma
@@ -35,6 +43,11 @@ private:
      * @brief Convert string to integer (simple version)
      */
     static int stringToInt(const std::string& str);
+
+    /**
+     * @brief Parse a whole field of digits into [0, max]; false otherwise
+     */
+    static bool parseCount(const std::string& str, int max, int& value);
 };
 
 #endif // CSV_READER_H
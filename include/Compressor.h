@@ -0,0 +1,47 @@
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * @brief Reusable gzip compressor
+ *
+ * Wraps one zlib deflate stream that is reset, not reallocated, between
+ * bodies, so a worker thread can keep one around. Built without zlib
+ * (ELECTION_HAVE_ZLIB undefined) it compresses nothing and callers fall
+ * back to identity encoding.
+ */
+class Compressor {
+public:
+    explicit Compressor(int level = 6);
+    ~Compressor();
+
+    Compressor(const Compressor&) = delete;
+    Compressor& operator=(const Compressor&) = delete;
+
+    /**
+     * @brief Whether gzip support was compiled in
+     */
+    static bool available();
+
+    /**
+     * @brief Whether an Accept-Encoding header value allows gzip
+     */
+    static bool acceptsGzip(const std::string& acceptEncoding);
+
+    /**
+     * @brief Whether a content type is worth compressing (text formats)
+     */
+    static bool compressible(const std::string& contentType);
+
+    /**
+     * @brief gzip data into out (replacing its contents); false if unavailable
+     */
+    bool gzip(const char* data, size_t length, std::string& out);
+
+private:
+    void* stream;   // z_stream, kept opaque so zlib.h stays out of the header
+};
+
+#endif // COMPRESSOR_H
@@ -10,7 +10,7 @@
  */
 struct PartyStats {
     std::string party;
-    int totalVotes;
+    long long totalVotes;
     int seatsWon;
     double voteShare;
     int candidatesCount;
@@ -29,7 +29,7 @@ struct PartyStats {
 struct ElectionStats {
     std::string country;
     int year;
-    int totalVotes;
+    long long totalVotes;
     int totalSeats;
     int totalCandidates;
     int constituencies;
@@ -59,7 +59,7 @@ struct SeatInfo {
  */
 struct PartyChange {
     std::string party;
-    int voteChange;
+    long long voteChange;
     int seatChange;
 };
 
@@ -70,7 +70,7 @@ struct ComparativeAnalysis {
     std::string country;
     int year1;
     int year2;
-    int voteChange;
+    long long voteChange;
     double voteChangePercent;
     std::vector<PartyChange> partyChanges;
     std::vector<std::string> newParties;
@@ -85,6 +85,109 @@ struct PartyTrend {
     PartyStats stats;
 };
 
+/**
+ * @brief Summary of one vote distribution
+ */
+struct VoteDistribution {
+    long long count;
+    double min;
+    double max;
+    double p50;
+    double p90;
+    double p99;
+    std::vector<HistogramBin> histogram;
+
+    VoteDistribution() {
+        count = 0;
+        min = 0.0;
+        max = 0.0;
+        p50 = 0.0;
+        p90 = 0.0;
+        p99 = 0.0;
+    }
+};
+
+/**
+ * @brief Vote distributions of an election
+ */
+struct ElectionDistribution {
+    std::string country;
+    int year;
+    VoteDistribution candidates;
+    VoteDistribution constituencies;
+
+    ElectionDistribution() {
+        year = 0;
+    }
+};
+
+/**
+ * @brief An election a search result appears in
+ */
+struct ElectionRef {
+    std::string country;
+    int year;
+    int records;
+};
+
+/**
+ * @brief One fuzzy search result with its election context
+ */
+struct SearchResult {
+    std::string field;
+    std::string name;
+    double score;
+    std::vector<ElectionRef> elections;
+    std::vector<ElectionRecord> records;  // Only filled for candidates
+};
+
+/**
+ * @brief Career of one candidate across elections
+ */
+struct CandidateHistory {
+    std::string name;
+    int electionsContested;
+    int seatsWon;
+    std::vector<ElectionRecord> records;  // Sorted by year
+
+    CandidateHistory() {
+        electionsContested = 0;
+        seatsWon = 0;
+    }
+};
+
+/**
+ * @brief How many winners of the previous election held their seat
+ */
+struct IncumbencyStats {
+    std::string country;
+    int year;
+    int previousYear;
+    int incumbents;           // Elected in previous election
+    int incumbentsStanding;   // ...and standing again
+    int reelected;            // ...and elected again
+    double reelectionRate;    // reelected / incumbents (percent)
+
+    IncumbencyStats() {
+        year = 0;
+        previousYear = 0;
+        incumbents = 0;
+        incumbentsStanding = 0;
+        reelected = 0;
+        reelectionRate = 0.0;
+    }
+};
+
+/**
+ * @brief Everything the overview of one election shows
+ */
+struct ElectionDashboard {
+    ElectionStats stats;                        // partyStats ranked by votes
+    std::vector<SeatInfo> seats;                // As getSeatDistribution
+    std::vector<ElectionRecord> topCandidates;  // As getTopCandidates
+    std::vector<ElectionRecord> winners;        // As getWinningCandidates
+};
+
 /**
  * @brief Simple class for analyzing election data
  */
@@ -93,7 +196,7 @@ public:
     /**
      * @brief Calculate total votes for an election
      */
-    static int calculateTotalVotes(ElectionData& data, const std::string& country, int year);
+    static long long calculateTotalVotes(ElectionData& data, const std::string& country, int year);
 
     /**
      * @brief Calculate total seats won
@@ -130,15 +233,55 @@ public:
      */
     static std::vector<ElectionRecord> getWinningCandidates(ElectionData& data, const std::string& country, int year);
 
+    /**
+     * @brief Statistics, party ranking, seats, top candidates and winners
+     *        from a single scan of the election's records
+     *
+     * Same results as calling calculateElectionStats, getSeatDistribution,
+     * getTopCandidates and getWinningCandidates in turn, which would scan
+     * and sort the election once each.
+     */
+    static ElectionDashboard buildDashboard(ElectionData& data, const std::string& country, int year, int topN);
+
     /**
      * @brief Compare two elections
      */
     static ComparativeAnalysis compareElections(ElectionData& data, const std::string& country, int year1, int year2);
 
+    /**
+     * @brief Compare two elections of the same country from their statistics
+     */
+    static ComparativeAnalysis compareElections(const ElectionStats& stats1, const ElectionStats& stats2);
+
     /**
      * @brief Get party trend across multiple years
      */
     static std::vector<PartyTrend> getPartyTrend(ElectionData& data, const std::string& country, const std::string& party, std::vector<int> years);
+
+    /**
+     * @brief Get per-candidate and per-constituency vote distributions
+     */
+    static ElectionDistribution getVoteDistribution(ElectionData& data, const std::string& country, int year, int bins);
+
+    /**
+     * @brief Fuzzy search of candidate, party and constituency names
+     */
+    static std::vector<SearchResult> searchNames(ElectionData& data, const std::string& query, int limit);
+
+    /**
+     * @brief Get a candidate's records across years and countries
+     */
+    static CandidateHistory getCandidateHistory(ElectionData& data, const std::string& name, const std::string& party);
+
+    /**
+     * @brief Calculate incumbency of one election against the previous one
+     */
+    static IncumbencyStats calculateIncumbency(ElectionData& data, const std::string& country, int previousYear, int year);
+
+    /**
+     * @brief Calculate incumbency for every election of a country (in parallel)
+     */
+    static std::vector<IncumbencyStats> calculateIncumbencyTrend(ElectionData& data, const std::string& country);
 };
 
 #endif // ELECTION_ANALYZER_H
@@ -0,0 +1,140 @@
+#ifndef ELECTION_CUBE_H
+#define ELECTION_CUBE_H
+
+#include "ElectionRecord.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <array>
+
+/**
+ * @brief Filter for a cube query (empty string / 0 means "any")
+ */
+struct CubeSlice {
+    std::string country;
+    int year;
+    std::string party;
+    std::string constituency;
+
+    CubeSlice() {
+        year = 0;
+    }
+};
+
+/**
+ * @brief One aggregated cell of the cube
+ *
+ * Only the dimensions that were grouped by (or sliced on) are filled in.
+ */
+struct CubeCell {
+    std::string country;
+    int year;
+    std::string party;
+    std::string constituency;
+    long long votes;
+    int seats;
+    int candidates;
+    int constituencies;  // Distinct constituencies in the cell
+
+    CubeCell() {
+        year = 0;
+        votes = 0;
+        seats = 0;
+        candidates = 0;
+        constituencies = 0;
+    }
+};
+
+/**
+ * @brief Pre-aggregated cube over country x year x party x constituency
+ *
+ * All 16 roll-up levels (one per subset of dimensions) are kept up to
+ * date on insert, so any roll-up, drill-down or slice is answered from
+ * the matching level without touching the records.
+ *
+ * Cells stay small: names are interned once as integer ids, so a key is
+ * four ints, and a cell holds only its counters. Distinct constituencies
+ * need no per-cell set: a record brings a new constituency into a cell
+ * exactly when it creates a cell at the level that also groups by country
+ * and constituency.
+ *
+ * Time Complexity:
+ * - Add record: O(16 log c) where c is cells per level
+ * - Query: O(k log c + k log k) where k is cells at the queried level
+ */
+class ElectionCube {
+public:
+    enum Dimension {
+        Country = 1,
+        Year = 2,
+        Party = 4,
+        Constituency = 8
+    };
+
+    /**
+     * @brief Add one record to every roll-up level
+     */
+    void addRecord(const ElectionRecord& record);
+
+    /**
+     * @brief Get the cells grouped by the given dimensions within a slice
+     */
+    std::vector<CubeCell> query(int groupBy, const CubeSlice& slice) const;
+
+    /**
+     * @brief Get the single cell of a slice (everything rolled up)
+     */
+    CubeCell total(const CubeSlice& slice) const;
+
+    /**
+     * @brief Parse "country,year,party,constituency" into a dimension mask
+     */
+    static int parseDimensions(const std::string& list);
+
+    /**
+     * @brief Clear the cube
+     */
+    void clear();
+
+private:
+    struct Aggregate {
+        long long votes;
+        int seats;
+        int candidates;
+        int constituencies;
+
+        Aggregate() {
+            votes = 0;
+            seats = 0;
+            candidates = 0;
+            constituencies = 0;
+        }
+    };
+
+    /**
+     * @brief Names interned as dense ids, in both directions
+     */
+    struct Dictionary {
+        std::map<std::string, int> ids;
+        std::vector<std::string> names;
+
+        int intern(const std::string& name);
+        int find(const std::string& name) const;   // -1 if never seen
+    };
+
+    // Country id, year, party id, constituency id; 0 where not in the level
+    typedef std::array<int, 4> Key;
+
+    static const int LEVELS = 16;
+
+    // One map per roll-up level, keyed by the values of its dimensions
+    std::map<Key, Aggregate> levels[LEVELS];
+
+    Dictionary countries;
+    Dictionary parties;
+    Dictionary constituencyNames;
+
+    static Key makeKey(int mask, const Key& values);
+};
+
+#endif // ELECTION_CUBE_H
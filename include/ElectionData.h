@@ -2,8 +2,18 @@
 #define ELECTION_DATA_H
 
 #include "ElectionRecord.h"
+#include "QuantileSketch.h"
+#include "SearchIndex.h"
+#include "ElectionCube.h"
+#include "RecordStore.h"
 #include <vector>
 #include <string>
+#include <map>
+#include <unordered_map>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
 
 /**
  * @brief Simple data structure for storing and managing election data
@@ -15,11 +25,57 @@
  * - Insert: O(1)
  * - Search: O(n) where n is number of records
  * - Get records: O(n)
+ *
+ * Vote distributions are kept up to date on every insert, so
+ * quantiles and histograms never need to sort the records.
+ * Names are added to a trigram index for fuzzy search, and each
+ * candidate's records are linked by normalized name across elections.
+ * Votes, seats and candidates are rolled up into an aggregation cube.
+ *
+ * Records may be added while other threads query. Records are kept in
+ * a RecordStore, so scans read a consistent prefix without locking; the
+ * indexes are guarded by a reader/writer lock that writers hold only
+ * while updating them. Writers are serialized with each other.
  */
 class ElectionData {
 private:
-    // Simple vector to store all records
-    std::vector<ElectionRecord> records;
+    /**
+     * @brief Running vote distribution of one election
+     */
+    struct DistributionIndex {
+        QuantileSketch candidateVotes;
+        std::map<std::string, long long> constituencyVotes;
+    };
+
+    // Append-only storage, readable without a lock
+    RecordStore records;
+
+    // One writer at a time (addRecord, clear, listener changes)
+    std::mutex writeMutex;
+
+    // Guards every index below; shared by readers, exclusive while indexing
+    mutable std::shared_mutex indexMutex;
+
+    // Distributions per election (country + year)
+    std::map<std::pair<std::string, int>, DistributionIndex> distributions;
+
+    // Trigram index over candidate, party and constituency names
+    SearchIndex searchIndex;
+
+    // Record positions of each candidate, keyed by normalized name
+    std::unordered_map<std::string, std::vector<int>> candidatePostings;
+
+    // Pre-aggregated totals over country x year x party x constituency
+    ElectionCube cube;
+
+    // Bumped on every change so derived caches can tell they are stale
+    std::atomic<unsigned long long> version{0};
+
+    // Told about every added record (live result feeds)
+    std::function<void(const ElectionRecord&)> listener;
+
+    // Update every index for a record about to be stored (both locks held)
+    void indexRecord(const ElectionRecord& record);
 
 public:
     /**
@@ -27,6 +83,11 @@ public:
      */
     void addRecord(const ElectionRecord& record);
 
+    /**
+     * @brief Add several records; queries see either none or all of them indexed
+     */
+    void addRecords(const std::vector<ElectionRecord>& batch);
+
     /**
      * @brief Get all records for a specific election (country + year)
      */
@@ -48,7 +109,77 @@ public:
     std::vector<ElectionRecord> getAllRecords();
 
     /**
-     * @brief Clear all data
+     * @brief Get the years with elections for a country, in order
+     */
+    std::vector<int> getElectionYears(const std::string& country);
+
+    /**
+     * @brief Get one record by its position (0 to getTotalRecords() - 1)
+     */
+    ElectionRecord getRecord(int index);
+
+    /**
+     * @brief Visit matching records in storage order, starting at position start
+     *
+     * An empty country or a year of 0 matches any. Looks at no more than
+     * maxScanned records and stops early when visit returns false. Returns
+     * the position to resume from, or -1 once the last record was scanned.
+     * Records are only ever appended, so positions make stable cursors.
+     */
+    int scanRecords(const std::string& country, int year, int start, int maxScanned,
+                    const std::function<bool(const ElectionRecord&)>& visit);
+
+    /**
+     * @brief Fuzzy search of candidate, party and constituency names
+     */
+    std::vector<SearchMatch> searchNames(const std::string& query, int limit);
+
+    /**
+     * @brief Get all records of a candidate across years and countries
+     *
+     * Names are compared after normalization. If party is not empty,
+     * only records for that party are returned.
+     */
+    std::vector<ElectionRecord> getCandidateRecords(const std::string& name, const std::string& party = "");
+
+    /**
+     * @brief Get aggregated cells grouped by the given ElectionCube dimensions
+     */
+    std::vector<CubeCell> queryCube(int groupBy, const CubeSlice& slice);
+
+    /**
+     * @brief Get the fully rolled-up cell of a slice
+     */
+    CubeCell getCubeTotal(const CubeSlice& slice);
+
+    /**
+     * @brief Get the sketch of per-candidate votes for an election
+     */
+    QuantileSketch getCandidateVoteSketch(const std::string& country, int year);
+
+    /**
+     * @brief Get total votes of each constituency in an election
+     */
+    std::map<std::string, long long> getConstituencyVotes(const std::string& country, int year);
+
+    /**
+     * @brief Get a counter that changes whenever the data changes
+     *
+     * Versions are drawn from one process-wide sequence, so two datasets
+     * (e.g. before and after a reload) never report the same non-zero version.
+     */
+    unsigned long long getVersion() const;
+
+    /**
+     * @brief Set a function called after each record is added (empty to remove)
+     *
+     * It runs on the thread that adds the record, after every index is
+     * updated and with the index lock released, so it may query this data.
+     */
+    void setChangeListener(std::function<void(const ElectionRecord&)> callback);
+
+    /**
+     * @brief Clear all data (not while other threads are reading)
      */
     void clear();
 };
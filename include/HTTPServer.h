@@ -2,30 +2,255 @@
 #define HTTP_SERVER_H
 
 #include "ElectionData.h"
+#include "ThreadPool.h"
+#include "RequestParser.h"
+#include "BufferPool.h"
+#include "StaticAssetCache.h"
+#include "OutputQueue.h"
+#include "ResponseCache.h"
+#include "LiveHub.h"
+#include "AdmissionControl.h"
+#include "WriteAheadLog.h"
+#include "ServerMetrics.h"
+#include "AnalysisMemo.h"
 #include <string>
 #include <map>
 #include <functional>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <cstdint>
+
+/**
+ * @brief Keep-alive bookkeeping for one client connection
+ */
+struct ConnectionContext {
+    int requestsServed;
+    bool closeAfterWrite;
+    std::shared_ptr<LiveSubscription> live;   // Set once the connection is an /api/live stream
+
+    ConnectionContext() {
+        requestsServed = 0;
+        closeAfterWrite = false;
+    }
+};
+
+/**
+ * @brief How the server multiplexes connections
+ */
+enum class ServerMode {
+    Blocking,   // Acceptor + worker pool, one blocking connection per worker
+    EventLoop,  // Non-blocking sockets on epoll (Linux only)
+    IoUring     // Completions from io_uring (Linux 5.19+), epoll where unavailable
+};
+
+/**
+ * @brief Encoding of API response bodies, negotiated from the Accept header
+ */
+enum class ResponseFormat {
+    JSON,
+    MessagePack,
+    CBOR
+};
+
+/**
+ * @brief Tuning options for the HTTP server
+ */
+struct ServerOptions {
+    ServerMode mode;
+    int threads;        // Worker threads handling connections
+    int queueSize;      // Accepted connections waiting for a worker
+    int backlog;        // Kernel listen backlog
+    int idleTimeoutMs;  // Close connections idle for this long (also between keep-alive requests)
+    int eventThreads;   // Event loop threads (EventLoop and IoUring modes)
+    int maxRequestsPerConnection;  // Close a keep-alive connection after this many
+    size_t maxBodySize; // Largest request body accepted (413 above this)
+    int assetRefreshMs; // How often web/ is checked for changes (0 = never)
+    size_t responseCacheBytes;  // Memory for cached API responses (0 = no cache)
+    size_t compressMinBytes;    // gzip API bodies at least this big (0 = no compression)
+    int maxQueueWaitMs; // Connections that waited longer for a worker get 503
+    int standardLimit;  // Standard-cost API requests computed at once (0 = auto)
+    int heavyLimit;     // Heavy-cost API requests computed at once (0 = auto)
+    std::string adminToken;     // Bearer token for /api/admin/* and POST /api/records (empty = disabled)
+
+    ServerOptions() {
+        mode = ServerMode::Blocking;
+        threads = 4;
+        queueSize = 256;
+        backlog = 128;
+        idleTimeoutMs = 5000;
+        eventThreads = 2;
+        maxRequestsPerConnection = 1000;
+        maxBodySize = 1024 * 1024;
+        assetRefreshMs = 1000;
+        responseCacheBytes = 16 * 1024 * 1024;
+        compressMinBytes = 1024;
+        maxQueueWaitMs = 500;
+        standardLimit = 0;
+        heavyLimit = 0;
+    }
+};
 
 /**
  * @brief Simple HTTP server for serving the GUI and handling API requests
+ *
+ * In blocking mode the acceptor thread hands each connection to a fixed
+ * pool of workers through a bounded queue, so one slow client does not
+ * stall the rest. In event loop mode a few threads multiplex all
+ * connections with epoll, so idle clients cost no thread at all. The
+ * io_uring mode runs the same loop on completions instead of readiness:
+ * multishot accepts and receives into a provided buffer ring, gathered
+ * sends, and the final send of a connection linked to its close, so a
+ * busy connection costs one io_uring_enter per batch of events rather
+ * than a system call per read and write. It falls back to epoll when the
+ * kernel lacks io_uring or the needed features. All backends hand
+ * parsed requests to the same processRequests.
+ *
+ * Connections are kept alive (HTTP/1.1 default) and pipelined requests
+ * are answered in order by both backends. Requests are read
+ * incrementally (headers, then any Content-Length body) into buffers
+ * taken from a per-thread BufferPool. Static files are served from an
+ * in-memory StaticAssetCache with ETags. Responses are queued as
+ * header and body segments (OutputQueue) and written with gathered
+ * sendmsg, or sendfile for large files, without being concatenated.
+ * Successful API responses are kept in an LRU ResponseCache until the
+ * election data changes. Clients sending Accept-Encoding: gzip get
+ * precompressed static files and gzipped API bodies (when built with zlib).
+ * Clients sending Accept: application/msgpack or application/cbor get
+ * API bodies in that encoding instead of JSON, written by a BinaryWriter
+ * from the same serialization code; each encoding is cached separately.
+ * /api/records streams NDJSON with chunked encoding, generated as the
+ * socket drains so memory use does not grow with the result.
+ * /api/live holds the connection open and pushes result deltas from a
+ * LiveHub as Server-Sent Events.
+ *
+ * Under overload work is shed instead of queued without bound: a full
+ * worker queue, or a connection that waited too long for a worker, gets
+ * an immediate 503 with Retry-After, and AdmissionControl caps how many
+ * standard and heavy API requests are computed at once.
+ *
+ * The dataset is an immutable-once-published snapshot behind a
+ * shared_ptr read with std::atomic_load. A reload (SIGHUP or POST
+ * /api/admin/reload) builds a new one in the background and swaps it in;
+ * requests already running keep the snapshot they started with.
+ * POST /api/records appends rows to the current snapshot while it is
+ * being queried (see ElectionData), after a WriteAheadLog made them durable.
+ * POST /api/batch answers many API queries in one round trip, in parallel
+ * against one dataset, sharing per-election work through an AnalysisMemo.
+ *
+ * Every request is counted and timed per endpoint (ServerMetrics) and
+ * the results are served at /metrics in Prometheus text format.
  */
 class HTTPServer {
 public:
-    HTTPServer(int port, ElectionData* data);
+    HTTPServer(int port, std::shared_ptr<ElectionData> data, const ServerOptions& options = ServerOptions());
     ~HTTPServer();
     
     void start();
     void stop();
     
+    /**
+     * @brief Set how a fresh dataset is built when a reload is requested
+     *
+     * The loader runs on a background thread and returns null on failure,
+     * in which case the current dataset is kept. Records in the append log
+     * are replayed on top of its result by the server, not the loader.
+     */
+    void setDatasetLoader(std::function<std::shared_ptr<ElectionData>()> loader);
+    
+    /**
+     * @brief Ask the background thread to reload the dataset
+     */
+    void requestReload();
+    
+    /**
+     * @brief Log every POST /api/records batch here before acknowledging it
+     *
+     * Reloads replay the log on top of what the dataset loader returns.
+     */
+    void setAppendLog(std::shared_ptr<WriteAheadLog> log);
+    
 private:
+    // Largest request line + headers we accept (431 above this)
+    static constexpr size_t MAX_HEADER_SIZE = 64 * 1024;
+    // Bytes asked of recv at a time
+    static constexpr size_t READ_CHUNK_SIZE = 16 * 1024;
+    // Comment line sent to idle /api/live clients this often
+    static constexpr int LIVE_HEARTBEAT_MS = 15000;
+    
     int port;
-    ElectionData* electionData;
-    bool running;
+    std::shared_ptr<ElectionData> dataset;   // Only through std::atomic_load / atomic_store
+    ServerOptions options;
+    std::atomic<bool> running;
+    std::unique_ptr<ThreadPool> workers;
+    StaticAssetCache assets;
+    std::unique_ptr<ResponseCache> responseCache;
+    LiveHub live;
+    std::unique_ptr<AdmissionControl> admission;
+    ServerMetrics metrics;
+    
+    std::function<std::shared_ptr<ElectionData>()> datasetLoader;
+    std::thread reloadThread;
+    std::mutex reloadMutex;
+    std::condition_variable reloadWake;
+    bool reloadRequested;
+    std::atomic<long long> reloadCount;
+    std::shared_ptr<WriteAheadLog> appendLog;
+    std::shared_mutex ingestMutex;  // Shared by ingest requests, exclusive during a reload
+    
+    std::shared_ptr<ElectionData> currentData() const;
+    void reloadLoop();
+    void reloadDataset();
+    bool isAdmin(const HTTPRequest& request) const;
+    void handleAdminReload(const HTTPRequest& request, bool keepAlive, OutputQueue& output);
+    void handleAdminTrace(const HTTPRequest& request, std::map<std::string, std::string> params,
+                          bool keepAlive, OutputQueue& output);
+    void handleRecordIngest(const HTTPRequest& request, bool keepAlive, OutputQueue& output);
+    void handleBatch(const HTTPRequest& request, bool keepAlive, OutputQueue& output);
     
-    std::string handleRequest(const std::string& request);
-    std::string handleAPIRequest(const std::string& endpoint, const std::string& query);
-    std::string getContentType(const std::string& path);
-    std::string readFile(const std::string& path);
+    void runBlocking(SocketHandle serverSocket);
+    void handleConnection(SocketHandle clientSocket, std::chrono::steady_clock::time_point acceptedAt);
+    static void rejectConnection(SocketHandle clientSocket);
+#ifdef __linux__
+    void runEventLoop(SocketHandle serverSocket);
+    void eventLoopThread(SocketHandle serverSocket);
+#endif
+#ifdef ELECTION_HAVE_IO_URING
+    static bool probeIoUring(std::string& reason);
+    void runIoUring(SocketHandle serverSocket);
+    void ioUringThread(SocketHandle serverSocket);
+#endif
+    static BufferPool& threadBufferPool();
+    int processRequests(RequestParser& parser, OutputQueue& output, ConnectionContext& context);
+    bool handleRequest(const HTTPRequest& request, bool keepAlive, OutputQueue& output, ConnectionContext& context);
+    static std::string buildHeaders(const std::string& status, const std::string& contentType,
+                                    const std::string& extraHeaders, size_t contentLength);
+    void queueResponse(OutputQueue& output, const std::string& status, const std::string& contentType,
+                       std::string&& body, const std::string& extraHeaders, bool keepAlive);
+    void queueCachedResponse(OutputQueue& output, std::shared_ptr<const CachedResponse> response,
+                             bool keepAlive, bool gzip);
+    std::shared_ptr<CachedResponse> buildAPIResponse(const std::string& status, const std::string& contentType,
+                                                     std::string&& body, bool withGzip);
+    bool acceptsGzip(const HTTPRequest& request) const;
+    static ResponseFormat acceptedFormat(const HTTPRequest& request);
+    bool queueRecordStream(const HTTPRequest& request, std::map<std::string, std::string> params,
+                           bool keepAlive, OutputQueue& output);
+    void queueLiveStream(std::map<std::string, std::string> params, bool keepAlive,
+                         OutputQueue& output, ConnectionContext& context);
+    bool queueLiveEvents(ConnectionContext& context, OutputQueue& output);
+    void serveLiveBlocking(SocketHandle clientSocket, ConnectionContext& context, OutputQueue& output);
+    static bool wantsKeepAlive(const HTTPRequest& request);
+    std::string handleAPIRequest(ElectionData* electionData, const std::string& endpoint,
+                                 std::map<std::string, std::string> params, ResponseFormat format,
+                                 AnalysisMemo* memo);
+    template <typename Writer>
+    void writeAPIResponse(Writer& writer, ElectionData* electionData, const std::string& endpoint,
+                          std::map<std::string, std::string>& params, AnalysisMemo* memo,
+                          std::chrono::steady_clock::time_point& computedAt);
     std::map<std::string, std::string> parseQuery(const std::string& query);
     std::string urlDecode(const std::string& str);
 };
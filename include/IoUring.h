@@ -0,0 +1,125 @@
+#ifndef IO_URING_H
+#define IO_URING_H
+
+// Set by CMake when <linux/io_uring.h> has everything used here
+#ifdef ELECTION_HAVE_IO_URING
+
+#include <linux/io_uring.h>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief One io_uring instance, driven with the raw system calls
+ *
+ * Entries are prepared in the mapped submission queue with nextSqe() and
+ * handed to the kernel by submit(), which can also wait for completions;
+ * drain() then visits every completion ready in the mapped completion
+ * queue. Head and tail indexes shared with the kernel are read with
+ * acquire and published with release ordering, as the kernel ABI
+ * requires. An instance is meant to be used by a single thread.
+ *
+ * initBuffers() registers a provided buffer ring: receives submitted with
+ * IOSQE_BUFFER_SELECT take a buffer from it as data arrives, so idle
+ * connections hold no receive buffer at all. A buffer goes back to the
+ * ring with recycleBuffer() once its data has been consumed.
+ */
+class IoUring {
+public:
+    IoUring();
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    /**
+     * @brief Create the ring with room for entries submissions
+     */
+    bool init(unsigned entries, std::string& error);
+
+    /**
+     * @brief Whether the kernel knows an opcode (IORING_REGISTER_PROBE)
+     */
+    bool supports(int opcode) const;
+
+    /**
+     * @brief Zeroed submission entry, or null if the queue is full even
+     *        after submitting what was queued
+     */
+    io_uring_sqe* nextSqe();
+
+    /**
+     * @brief Submit queued entries and wait for at least waitFor completions
+     *
+     * Returns the number submitted, or -errno.
+     */
+    int submit(unsigned waitFor);
+
+    /**
+     * @brief Call visit(const io_uring_cqe&) for each ready completion
+     */
+    template <typename Visit>
+    unsigned drain(Visit visit) {
+        unsigned head = *cqHead;
+        unsigned seen = 0;
+        while (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+            io_uring_cqe cqe = cqes[head & cqMask];
+            head++;
+            seen++;
+            // Released before visiting, so visit may submit and wait again
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            visit(cqe);
+        }
+        return seen;
+    }
+
+    /**
+     * @brief Register count buffers of size bytes as buffer group group
+     *
+     * count must be a power of two.
+     */
+    bool initBuffers(uint16_t group, unsigned count, unsigned size, std::string& error);
+
+    char* bufferData(uint16_t id) const { return buffers + static_cast<size_t>(id) * bufferSize; }
+
+    /**
+     * @brief Hand a selected buffer back to the kernel
+     */
+    void recycleBuffer(uint16_t id);
+
+private:
+    int ringFd;
+    unsigned sqEntries;
+
+    void* sqRing;
+    size_t sqRingSize;
+    void* cqRing;
+    size_t cqRingSize;
+    io_uring_sqe* sqes;
+    size_t sqesSize;
+
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned sqMask;
+    unsigned localTail;         // Entries prepared, including those not yet submitted
+    unsigned submittedTail;
+
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned cqMask;
+    io_uring_cqe* cqes;
+
+    io_uring_probe* probe;
+
+    io_uring_buf_ring* bufferRing;
+    size_t bufferRingSize;
+    char* buffers;
+    size_t buffersSize;
+    unsigned bufferCount;
+    unsigned bufferSize;
+    uint16_t bufferTail;
+};
+
+#endif // ELECTION_HAVE_IO_URING
+
+#endif // IO_URING_H
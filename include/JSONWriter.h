@@ -0,0 +1,74 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * @brief Streaming JSON writer that appends to a caller-owned buffer
+ *
+ * Commas and colons are inserted automatically, strings are escaped
+ * (quotes, backslashes and control characters) and numbers are formatted
+ * with std::to_chars, so there is no iostream or locale involved.
+ * Non-finite doubles are written as null.
+ *
+ * Example:
+ *   std::string out;
+ *   JSONWriter json(out);
+ *   json.beginObject().field("country", "Jordan").field("year", 2016).endObject();
+ */
+class JSONWriter {
+public:
+    explicit JSONWriter(std::string& out);
+
+    JSONWriter& beginObject();
+    JSONWriter& endObject();
+    JSONWriter& beginArray();
+    JSONWriter& endArray();
+
+    /**
+     * @brief Write an object key; the next value belongs to it
+     */
+    JSONWriter& key(const char* name);
+    JSONWriter& key(const std::string& name);
+
+    JSONWriter& value(const std::string& text);
+    JSONWriter& value(const char* text);
+    JSONWriter& value(bool flag);
+    JSONWriter& value(int number);
+    JSONWriter& value(long number);
+    JSONWriter& value(long long number);
+    JSONWriter& value(unsigned long number);
+    JSONWriter& value(unsigned long long number);
+    JSONWriter& value(double number);
+    JSONWriter& null();
+
+    /**
+     * @brief Write a value that is already encoded as JSON
+     */
+    JSONWriter& raw(const std::string& encoded);
+
+    /**
+     * @brief Shorthand for key(name).value(v)
+     */
+    template <typename T>
+    JSONWriter& field(const char* name, const T& v) {
+        key(name);
+        return value(v);
+    }
+
+    /**
+     * @brief Append text as an escaped JSON string (with quotes)
+     */
+    static void escape(std::string& out, const char* text, size_t length);
+
+private:
+    std::string& out;
+    bool needComma;
+
+    void separator();
+    template <typename T>
+    JSONWriter& integer(T number);
+};
+
+#endif // JSON_WRITER_H
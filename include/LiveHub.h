@@ -0,0 +1,115 @@
+#ifndef LIVE_HUB_H
+#define LIVE_HUB_H
+
+#include "ElectionData.h"
+#include <string>
+#include <deque>
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/**
+ * @brief Server-Sent Events waiting to be written to one /api/live client
+ *
+ * Events are shared between subscribers; each one holds a pointer, not a
+ * copy. A client that falls too far behind is closed rather than being
+ * allowed to queue without bound.
+ */
+class LiveSubscription {
+public:
+    LiveSubscription(const std::string& country, int year);
+
+    const std::string& getCountry() const { return country; }
+    int getYear() const { return year; }
+
+    /**
+     * @brief Move queued events onto out; false once the subscription is closed
+     */
+    bool take(std::deque<std::shared_ptr<const std::string>>& out);
+
+    /**
+     * @brief Wait up to timeoutMs for an event (or close)
+     */
+    void wait(int timeoutMs);
+
+    /**
+     * @brief Called with the subscription locked whenever an event is queued
+     *
+     * The event loop uses it to wake its epoll_wait; blocking workers
+     * leave it empty and wait() instead. Once setWake(nullptr) returns the
+     * old callback is never called again, so whatever it uses may go.
+     */
+    void setWake(std::function<void()> callback);
+
+    void close();
+
+private:
+    friend class LiveHub;
+
+    std::string country;
+    int year;
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::shared_ptr<const std::string>> events;
+    bool closed;
+    std::function<void()> wake;
+
+    void push(const std::shared_ptr<const std::string>& event);
+};
+
+/**
+ * @brief Fans out election result deltas to /api/live subscribers
+ *
+ * publish() is called for every record added to ElectionData. When an
+ * election has subscribers, the delta (the record's party totals, the
+ * election totals and the seat if one was declared) is serialized once
+ * as an SSE "delta" event and queued for each of them. Deltas carry raw
+ * totals only; every party's share changes with the election total, so
+ * clients compute shares themselves.
+ * Elections nobody watches cost one map lookup.
+ */
+class LiveHub {
+public:
+    explicit LiveHub(std::shared_ptr<ElectionData> data);
+
+    /**
+     * @brief Switch to a reloaded dataset; every subscriber gets a new snapshot
+     */
+    void setData(std::shared_ptr<ElectionData> data);
+
+    /**
+     * @brief Register a client; its first event is a full "snapshot"
+     */
+    std::shared_ptr<LiveSubscription> subscribe(const std::string& country, int year);
+    void unsubscribe(const std::shared_ptr<LiveSubscription>& subscription);
+
+    /**
+     * @brief Push the change made by a newly added record
+     */
+    void publish(const ElectionRecord& record);
+
+    /**
+     * @brief Close every subscription (server shutdown)
+     */
+    void closeAll();
+
+    size_t subscriberCount();
+    long long eventsPublished();
+
+private:
+    typedef std::pair<std::string, int> ElectionKey;
+
+    std::shared_ptr<ElectionData> data;
+    std::mutex mutex;
+    std::map<ElectionKey, std::vector<std::shared_ptr<LiveSubscription>>> subscribers;
+    size_t subscriberTotal;
+    long long published;
+
+    std::string buildSnapshot(const std::string& country, int year);
+};
+
+#endif // LIVE_HUB_H
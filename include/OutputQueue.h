@@ -0,0 +1,129 @@
+#ifndef OUTPUT_QUEUE_H
+#define OUTPUT_QUEUE_H
+
+#include <string>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+typedef uintptr_t SocketHandle;
+#else
+typedef int SocketHandle;
+#endif
+
+#ifdef __linux__
+struct iovec;
+
+/**
+ * @brief Open file kept alive while any queued response still refers to it
+ */
+struct SharedFile {
+    int fd;
+
+    explicit SharedFile(int fd) : fd(fd) {}
+    ~SharedFile();
+
+    SharedFile(const SharedFile&) = delete;
+    SharedFile& operator=(const SharedFile&) = delete;
+};
+#endif
+
+/**
+ * @brief Response bytes waiting to be written to one connection
+ *
+ * A response is queued as separate segments (headers, then body) instead
+ * of being concatenated: owned strings are moved in, long-lived buffers
+ * such as cached static files are referenced without copying, and file
+ * ranges are sent with sendfile on Linux. flush() writes consecutive
+ * memory segments with a single gathered sendmsg (writev semantics).
+ * Streamed bodies are generated one piece at a time, only once everything
+ * queued before them has been written, so they hold one piece in memory.
+ */
+class OutputQueue {
+public:
+    enum class FlushResult {
+        Done,        // Everything queued has been written
+        WouldBlock,  // Non-blocking socket is full; call again when writable
+        Error        // Connection is broken
+    };
+
+    OutputQueue();
+
+    /**
+     * @brief Queue a string; small ones are merged into the previous owned segment
+     */
+    void append(std::string&& data);
+    void append(const char* data, size_t length);
+
+    /**
+     * @brief Queue bytes owned by someone else, kept alive through owner
+     */
+    void appendShared(const char* data, size_t length, std::shared_ptr<const void> owner);
+
+#ifdef __linux__
+    /**
+     * @brief Queue a range of an open file, sent with sendfile
+     */
+    void appendFile(std::shared_ptr<SharedFile> file, size_t offset, size_t length);
+#endif
+
+    /**
+     * @brief Queue a body produced on demand
+     *
+     * produce appends the next piece to its argument and returns false
+     * after the last one.
+     */
+    void appendStream(std::function<bool(std::string&)> produce);
+
+    FlushResult flush(SocketHandle sock);
+
+#ifdef __linux__
+    /**
+     * @brief Describe the memory segments at the front for an asynchronous send
+     *
+     * Streams at the front are produced first. Returns how many entries of
+     * iov were filled: 0 when the queue is empty or a file range is next
+     * (send that with flush). all tells whether iov covers everything
+     * queued. Nothing may be appended until written() has been called for
+     * the send, since appending can move the last owned segment.
+     */
+    size_t gather(iovec* iov, size_t maxCount, bool& all);
+
+    /**
+     * @brief Drop bytes sent from gather()ed segments
+     */
+    void written(size_t bytes) { consume(bytes); }
+#endif
+
+    size_t pending() const { return pendingBytes; }     // Excludes bytes not yet streamed
+    bool empty() const { return segments.empty(); }
+    void clear();
+
+private:
+    struct Segment {
+        std::string owned;          // Used when data is null
+        const char* data;           // Shared or static buffer
+        size_t length;
+        size_t offset;              // Bytes of this segment already written
+        std::shared_ptr<const void> owner;
+#ifdef __linux__
+        std::shared_ptr<SharedFile> file;   // Sends length bytes from fileStart
+        size_t fileStart;
+#endif
+        std::function<bool(std::string&)> stream;   // Placeholder for bytes still to produce
+
+        Segment() : data(nullptr), length(0), offset(0) {}
+        const char* bytes() const { return data != nullptr ? data : owned.data(); }
+    };
+
+    std::deque<Segment> segments;
+    size_t pendingBytes;
+
+    void consume(size_t bytes);
+    void produce();
+};
+
+#endif // OUTPUT_QUEUE_H
@@ -0,0 +1,77 @@
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <map>
+#include <vector>
+
+/**
+ * @brief One bar of a histogram
+ */
+struct HistogramBin {
+    double lower;
+    double upper;
+    long long count;
+};
+
+/**
+ * @brief Streaming quantile sketch with relative error guarantees
+ *
+ * Values are counted in logarithmic buckets: bucket i holds values in
+ * (gamma^(i-1), gamma^i], so any quantile is reported within the
+ * configured relative accuracy. Values are never stored or sorted.
+ *
+ * Time Complexity:
+ * - Add: O(log b) where b is number of non-empty buckets
+ * - Quantile: O(b)
+ * - Histogram: O(b + bins)
+ */
+class QuantileSketch {
+private:
+    double gamma;
+    double logGamma;
+    long long zeroCount;
+    long long totalCount;
+    double minValue;
+    double maxValue;
+    std::map<int, long long> buckets;
+
+    int bucketIndex(double value) const;
+    double bucketValue(int index) const;
+
+public:
+    /**
+     * @brief Create a sketch with the given relative accuracy (default 1%)
+     */
+    explicit QuantileSketch(double relativeAccuracy = 0.01);
+
+    /**
+     * @brief Add one non-negative value
+     */
+    void add(double value);
+
+    /**
+     * @brief Merge another sketch with the same accuracy into this one
+     */
+    void merge(const QuantileSketch& other);
+
+    /**
+     * @brief Estimate the q-th quantile (q in [0, 1])
+     */
+    double quantile(double q) const;
+
+    /**
+     * @brief Build an equal-width histogram between min and max
+     */
+    std::vector<HistogramBin> histogram(int bins) const;
+
+    long long count() const { return totalCount; }
+    double min() const { return minValue; }
+    double max() const { return maxValue; }
+
+    /**
+     * @brief Clear all values
+     */
+    void clear();
+};
+
+#endif // QUANTILE_SKETCH_H
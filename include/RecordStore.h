@@ -0,0 +1,61 @@
+#ifndef RECORD_STORE_H
+#define RECORD_STORE_H
+
+#include "ElectionRecord.h"
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief Append-only record storage that can be read while it grows
+ *
+ * Records are kept in chunks that never move once allocated. Chunk k
+ * holds FIRST_CHUNK << k records, so a fixed table of chunk pointers
+ * covers any realistic size and no append ever reallocates storage a
+ * reader may be looking at (unlike std::vector::push_back).
+ *
+ * The writer copies a record into its slot and then publishes it with a
+ * release-store of the committed count. Readers load the count with
+ * acquire and may read every record below it without taking a lock, so
+ * they always see a consistent prefix. Only one thread may append at a
+ * time; clear() must not run while anyone is reading.
+ */
+class RecordStore {
+public:
+    RecordStore();
+    ~RecordStore();
+
+    RecordStore(const RecordStore&) = delete;
+    RecordStore& operator=(const RecordStore&) = delete;
+
+    /**
+     * @brief Copy a record to the end and publish it
+     */
+    void append(const ElectionRecord& record);
+
+    /**
+     * @brief Number of published records; all of them are safe to read
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get a published record (index < size())
+     */
+    const ElectionRecord& operator[](size_t index) const;
+
+    /**
+     * @brief Remove every record and free the chunks
+     */
+    void clear();
+
+private:
+    // Records in chunk 0; each later chunk is twice the previous one
+    static const size_t FIRST_CHUNK = 1024;
+    static const int MAX_CHUNKS = 32;
+
+    ElectionRecord* chunks[MAX_CHUNKS];
+    std::atomic<size_t> committed;
+
+    static void locate(size_t index, int& chunk, size_t& offset);
+};
+
+#endif // RECORD_STORE_H
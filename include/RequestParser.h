@@ -0,0 +1,95 @@
+#ifndef REQUEST_PARSER_H
+#define REQUEST_PARSER_H
+
+#include "BufferPool.h"
+#include <string>
+#include <map>
+#include <vector>
+
+/**
+ * @brief A parsed HTTP request (header names are lowercase)
+ */
+struct HTTPRequest {
+    std::string method;
+    std::string path;
+    std::string version;
+    std::map<std::string, std::string> headers;
+    std::string body;
+};
+
+/**
+ * @brief Incremental HTTP/1.1 request reader for one connection
+ *
+ * Bytes are received straight into a buffer borrowed from a BufferPool
+ * (prepare/commit), and next() hands out each request once its headers
+ * and Content-Length body have fully arrived. Fragmented and pipelined
+ * input both work; the header search resumes where the last one stopped
+ * instead of rescanning the buffer. Once everything received has been
+ * consumed the buffer goes back to the pool, so idle keep-alive
+ * connections hold no buffer at all.
+ */
+class RequestParser {
+public:
+    enum class Status {
+        Incomplete,  // Need more bytes
+        Complete,    // A request was returned
+        Error        // Malformed or too large; see errorStatus()
+    };
+
+    RequestParser(BufferPool* pool, size_t maxHeaderSize, size_t maxBodySize);
+    ~RequestParser();
+
+    RequestParser(const RequestParser&) = delete;
+    RequestParser& operator=(const RequestParser&) = delete;
+
+    /**
+     * @brief Get room for at least minimum more bytes at the end of the buffer
+     *
+     * The buffer is taken from the pool on first use; space() tells how
+     * much can actually be written.
+     */
+    char* prepare(size_t minimum);
+    size_t space() const;
+
+    /**
+     * @brief Mark size bytes written after prepare() as received
+     */
+    void commit(size_t size);
+
+    /**
+     * @brief Take the next complete request, if one has arrived
+     */
+    Status next(HTTPRequest& request);
+
+    /**
+     * @brief HTTP status line for the last Error (e.g. "413 Payload Too Large")
+     */
+    const std::string& errorStatus() const { return error; }
+
+    /**
+     * @brief Bytes received but not yet returned as a request
+     */
+    size_t buffered() const { return length - start; }
+
+private:
+    BufferPool* pool;
+    std::vector<char>* buffer;
+    size_t maxHeaderSize;
+    size_t maxBodySize;
+
+    size_t start;       // First byte of the current request
+    size_t length;      // End of received data
+    size_t scanned;     // Header terminator search resumes here
+
+    bool headerDone;    // Current request's headers parsed, body pending
+    size_t bodyStart;
+    size_t bodyLength;
+    HTTPRequest pending;
+    std::string error;
+
+    Status fail(const std::string& status);
+    bool parseHeader(const char* begin, const char* end);
+    void releaseBuffer();
+};
+
+#endif // REQUEST_PARSER_H
@@ -0,0 +1,86 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <string>
+#include <map>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * @brief A serialized API response (headers without Connection, and body)
+ */
+struct CachedResponse {
+    std::string headers;
+    std::string body;
+    unsigned long long dataVersion;
+    std::shared_ptr<const CachedResponse> gzipped;  // Same response gzip-encoded, if worth it
+
+    CachedResponse() : dataVersion(0) {}
+};
+
+/**
+ * @brief Hit/miss counters and memory use of a ResponseCache
+ */
+struct ResponseCacheStats {
+    long long hits;
+    long long misses;
+    long long evictions;
+    size_t entries;
+    size_t bytes;
+    size_t capacityBytes;
+    double hitRatio;
+};
+
+/**
+ * @brief Bounded LRU cache of serialized API responses
+ *
+ * Keyed by endpoint plus the decoded query parameters in sorted order, so
+ * "?year=2016&country=Jordan" and "?country=Jordan&year=2016" share an
+ * entry. Each entry remembers the ElectionData version it was built from
+ * and is dropped on lookup once the data has changed. Thread-safe.
+ */
+class ResponseCache {
+public:
+    explicit ResponseCache(size_t capacityBytes);
+
+    /**
+     * @brief Build the cache key for an endpoint and its parsed parameters
+     */
+    static std::string makeKey(const std::string& endpoint, const std::map<std::string, std::string>& params);
+
+    /**
+     * @brief Get a response built from dataVersion, or null
+     */
+    std::shared_ptr<const CachedResponse> find(const std::string& key, unsigned long long dataVersion);
+
+    /**
+     * @brief Store a response, evicting least recently used entries to fit
+     */
+    void insert(const std::string& key, std::shared_ptr<const CachedResponse> response);
+
+    ResponseCacheStats getStats();
+    void clear();
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const CachedResponse> response;
+        size_t bytes;
+    };
+
+    size_t capacityBytes;
+    size_t bytes;
+    long long hits;
+    long long misses;
+    long long evictions;
+
+    std::mutex mutex;
+    std::list<Entry> entries;   // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+    void erase(std::list<Entry>::iterator it);
+};
+
+#endif // RESPONSE_CACHE_H
@@ -0,0 +1,84 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include "ElectionRecord.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+/**
+ * @brief Kind of name a search match refers to
+ */
+enum class SearchField {
+    Candidate,
+    Party,
+    Constituency
+};
+
+/**
+ * @brief One matched name with the records it appears in
+ */
+struct SearchMatch {
+    SearchField field;
+    std::string name;
+    double score;
+    std::vector<int> recordIds;
+};
+
+/**
+ * @brief Trigram inverted index over candidate, party and constituency names
+ *
+ * Every distinct name is stored once as a term. Each trigram of the
+ * normalized name points to the terms containing it, so a query only
+ * touches the terms that share at least one trigram with it.
+ *
+ * Time Complexity:
+ * - Add record: O(L) where L is the length of the names
+ * - Search: O(P + m log k) where P is the postings touched, m the matches
+ *   and k the limit
+ */
+class SearchIndex {
+private:
+    struct Term {
+        SearchField field;
+        std::string name;
+        int trigramCount;
+        std::vector<int> recordIds;
+    };
+
+    std::vector<Term> terms;
+    std::map<std::pair<int, std::string>, int> termIds;
+    std::unordered_map<std::string, std::vector<int>> postings;
+
+    void addName(SearchField field, const std::string& name, int recordId);
+
+public:
+    /**
+     * @brief Index the names of one record
+     */
+    void addRecord(const ElectionRecord& record, int recordId);
+
+    /**
+     * @brief Find at most limit names similar to the query, best matches
+     *        first; none when limit is not positive
+     */
+    std::vector<SearchMatch> search(const std::string& query, int limit) const;
+
+    /**
+     * @brief Clear the index
+     */
+    void clear();
+
+    /**
+     * @brief Lowercase a name and turn punctuation into single spaces
+     */
+    static std::string normalize(const std::string& str);
+
+    /**
+     * @brief Get the distinct trigrams of a normalized string
+     */
+    static std::vector<std::string> trigrams(const std::string& normalized);
+};
+
+#endif // SEARCH_INDEX_H
@@ -0,0 +1,120 @@
+#ifndef SERVER_METRICS_H
+#define SERVER_METRICS_H
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Lock-free log-linear latency histogram (HDR-style)
+ *
+ * Durations are counted in 256 ns units. Below 16 units every unit has a
+ * bucket; above, each power of two is split into 16 equal buckets, so any
+ * recorded value is known to within about 6% using a few hundred
+ * counters. record() is one bucket lookup and two relaxed atomic
+ * additions; the count is only added up when read.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(uint64_t nanos);
+
+    uint64_t count() const;
+    uint64_t sumNanos() const { return sum.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Recorded values at or below limitNanos (bucket upper bounds)
+     */
+    uint64_t countAtMost(uint64_t limitNanos) const;
+
+    /**
+     * @brief Approximate value below which fraction q of the recordings fall
+     */
+    uint64_t quantile(double q) const;
+
+    /**
+     * @brief Add another histogram's counts to this one
+     */
+    void merge(const LatencyHistogram& other);
+
+private:
+    static const int UNIT_SHIFT = 8;    // 256 ns
+    static const int SUB_BUCKETS = 16;
+    static const int SUB_BITS = 4;
+    static const int MAX_BITS = 32;     // Values are capped at 2^32 units (~18 minutes)
+    static const int BUCKET_COUNT = (MAX_BITS - SUB_BITS + 1) * SUB_BUCKETS;
+
+    std::atomic<uint64_t> buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> sum;
+
+    static int bucketFor(uint64_t units);
+    static uint64_t upperBound(int bucket);
+};
+
+/**
+ * @brief Request counters and latency histograms per endpoint
+ *
+ * Every endpoint has a fixed slot (see endpointIndex), so recording takes
+ * no lock and allocates nothing. Counters are split into shards and each
+ * thread records into its own, so workers serving the same endpoint do
+ * not fight over cache lines; render() adds the shards up. For API endpoints the time spent
+ * computing results (ElectionAnalyzer, indexes) and the time spent
+ * serializing them are counted separately. render() writes everything
+ * in the Prometheus text exposition format.
+ */
+class ServerMetrics {
+public:
+    ServerMetrics();
+
+    /**
+     * @brief Slot of a request path (query string ignored)
+     *
+     * Known API endpoints and /metrics get their own slot; other /api/
+     * paths share "other" and everything else is "static".
+     */
+    static int endpointIndex(const std::string& path);
+
+    /**
+     * @brief Count one answered request
+     */
+    void recordRequest(int endpoint, uint64_t nanos, int status, size_t bytes);
+
+    /**
+     * @brief Split of one API response into computing and serializing
+     */
+    void recordAPI(int endpoint, uint64_t computeNanos, uint64_t serializeNanos);
+
+    /**
+     * @brief Append the Prometheus text format of every metric to out
+     */
+    void render(std::string& out) const;
+
+private:
+    static const int ENDPOINT_COUNT = 19;
+    static const char* const ENDPOINT_NAMES[ENDPOINT_COUNT];
+
+    static const int SHARD_COUNT = 8;
+
+    // One cache line apart so slots never share a line
+    struct alignas(64) EndpointMetrics {
+        std::atomic<uint64_t> errors;
+        std::atomic<uint64_t> bytes;
+        std::atomic<uint64_t> computeNanos;
+        std::atomic<uint64_t> serializeNanos;
+        LatencyHistogram latency;   // Its count is the number of requests
+
+        EndpointMetrics() : errors(0), bytes(0), computeNanos(0), serializeNanos(0) {}
+    };
+
+    struct Shard {
+        EndpointMetrics endpoints[ENDPOINT_COUNT];
+    };
+
+    std::unique_ptr<Shard[]> shards;
+
+    EndpointMetrics& localSlot(int endpoint);
+};
+
+#endif // SERVER_METRICS_H
@@ -0,0 +1,90 @@
+#ifndef STATIC_ASSET_CACHE_H
+#define STATIC_ASSET_CACHE_H
+
+#include "OutputQueue.h"
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @brief One preloaded file with its response headers already built
+ *
+ * okHeaders and notModifiedHeaders hold the status line and every header
+ * except Connection and the blank line that ends the header block. On
+ * Linux, large files keep an open descriptor for sendfile instead of an
+ * in-memory body. Text assets may carry a gzipped variant with its own
+ * body, ETag and headers.
+ */
+struct StaticAsset {
+    std::string contentType;
+    std::string body;
+    size_t size;
+#ifdef __linux__
+    std::shared_ptr<SharedFile> file;
+#endif
+    std::string etag;
+    std::string okHeaders;
+    std::string notModifiedHeaders;
+    std::shared_ptr<const StaticAsset> gzipped;   // Null if not worth compressing
+
+    /**
+     * @brief Whether an If-None-Match header value matches this asset
+     */
+    bool matches(const std::string& ifNoneMatch) const;
+};
+
+/**
+ * @brief Immutable in-memory copy of the web/ directory
+ *
+ * Every file is loaded once with a strong ETag (hash of its contents) and
+ * precomputed headers, and text files are gzipped once at load time when
+ * precompress is set. Lookups read the current snapshot and never touch
+ * the filesystem; a background thread polls the directory and swaps in a
+ * new snapshot when a file is added, removed or modified.
+ */
+class StaticAssetCache {
+public:
+    explicit StaticAssetCache(const std::string& root, bool precompress = false);
+    ~StaticAssetCache();
+
+    /**
+     * @brief Load every file under the root (replaces the current snapshot)
+     */
+    void load();
+
+    /**
+     * @brief Poll the root every intervalMs and reload when it changes
+     */
+    void startWatching(int intervalMs);
+    void stopWatching();
+
+    /**
+     * @brief Look up a request path ("/" means "/index.html"); null if absent
+     */
+    std::shared_ptr<const StaticAsset> find(const std::string& path) const;
+
+    size_t assetCount() const;
+
+    static std::string getContentType(const std::string& path);
+
+private:
+    typedef std::unordered_map<std::string, std::shared_ptr<const StaticAsset>> AssetTable;
+
+    std::string root;
+    bool precompress;
+    std::shared_ptr<const AssetTable> assets;   // Accessed with atomic_load/atomic_store
+    std::string signature;                      // Names, sizes and mtimes of the loaded files
+
+    std::thread watcher;
+    std::mutex watchMutex;
+    std::condition_variable watchWake;
+    bool watching;
+
+    std::string scanSignature() const;
+    void watchLoop(int intervalMs);
+};
+
+#endif // STATIC_ASSET_CACHE_H
@@ -0,0 +1,58 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size pool of worker threads fed by a bounded queue
+ *
+ * submit() blocks while the queue is full, which pushes back on the
+ * producer (the acceptor) instead of letting work pile up in memory.
+ */
+class ThreadPool {
+public:
+    ThreadPool(int threads, int queueCapacity);
+    ~ThreadPool();
+
+    /**
+     * @brief Queue a task, waiting while the queue is full
+     *
+     * Returns false if the pool is shutting down.
+     */
+    bool submit(std::function<void()> task);
+
+    /**
+     * @brief Queue a task only if there is room right now
+     */
+    bool trySubmit(std::function<void()> task);
+
+    /**
+     * @brief Finish queued tasks and join all workers
+     */
+    void shutdown();
+
+    int threadCount() const { return static_cast<int>(workers.size()); }
+
+    /**
+     * @brief Number of tasks waiting for a worker
+     */
+    int queueDepth();
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    size_t capacity;
+    bool stopping;
+
+    void workerLoop();
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,81 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief Timeline of scoped spans, exported as Chrome trace-event JSON
+ *
+ * Spans are opened with TRACE_SPAN("Class::function") and closed when the
+ * enclosing scope ends. Each thread records into its own ring buffer of
+ * the most recent RING_SIZE spans, so recording never waits for other
+ * threads. writeChromeJSON() gathers every buffer into a document that
+ * chrome://tracing or Perfetto can open.
+ *
+ * Everything is compiled out unless ELECTION_TRACING is defined (CMake
+ * option ELECTION_TRACING): TRACE_SPAN expands to nothing and isEnabled()
+ * returns false.
+ */
+class Trace {
+public:
+    static const size_t RING_SIZE = 16384;    // Spans kept per thread
+
+    /**
+     * @brief Whether spans are compiled in
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Nanoseconds since the first call in this process
+     */
+    static uint64_t now();
+
+    /**
+     * @brief Store a finished span in the calling thread's buffer
+     *
+     * name must outlive the trace (a string literal).
+     */
+    static void record(const char* name, uint64_t startNanos, uint64_t endNanos);
+
+    /**
+     * @brief Append {"traceEvents":[...]} with every buffered span to out
+     */
+    static void writeChromeJSON(std::string& out);
+
+    /**
+     * @brief Write the Chrome JSON to a file
+     */
+    static bool writeChromeJSON(const std::string& path, std::string& error);
+
+    /**
+     * @brief Forget every buffered span
+     */
+    static void clear();
+};
+
+/**
+ * @brief Records the time between its construction and destruction
+ */
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name) : name(name), start(Trace::now()) {}
+    ~TraceSpan() { Trace::record(name, start, Trace::now()); }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#ifdef ELECTION_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif
+
+#endif // TRACE_H
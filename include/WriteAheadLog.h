@@ -0,0 +1,109 @@
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include "ElectionData.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Counters of a WriteAheadLog
+ */
+struct WriteAheadLogStats {
+    long long records;      // Records made durable since startup
+    long long batches;      // append() calls
+    long long syncs;        // fsyncs; fewer than batches when commits were grouped
+    long long compactions;
+    long long replayed;     // Records read back from the log at the last load()
+    size_t logBytes;        // Current size of the log file
+};
+
+/**
+ * @brief Durable log of records added at runtime (POST /api/records)
+ *
+ * Records live in two files: a base CSV in the data file format holding
+ * everything compacted so far, and a binary log of the batches appended
+ * since. Each batch is one frame (length, CRC-32, records) so a frame
+ * torn by a crash is detected and cut off on open.
+ *
+ * append() queues the encoded batch and waits until a background thread
+ * has written and fsynced it. Batches that arrive while a sync is in
+ * progress are written together by the next one (group commit), so one
+ * fsync acknowledges many clients. Once the log grows past compactBytes
+ * its records are folded into a new copy of the base CSV, which is
+ * renamed over the old one before the log is emptied. The log header
+ * identifies the base it sits on by row count and CRC-32, and names the
+ * new base before the rename, so a crash between the two steps never
+ * replays records twice and a log is never replayed onto another base.
+ */
+class WriteAheadLog {
+public:
+    WriteAheadLog(const std::string& logPath, const std::string& basePath, size_t compactBytes);
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * @brief Open or create the log, repair a torn tail and start syncing
+     *
+     * Fails when the base CSV is not the one the log was written on.
+     */
+    bool open();
+
+    /**
+     * @brief Add the base CSV and every logged record to data
+     */
+    bool load(ElectionData& data);
+
+    /**
+     * @brief Make a batch durable; returns once it is fsynced (false on I/O error)
+     */
+    bool append(const std::vector<ElectionRecord>& batch);
+
+    /**
+     * @brief Sync anything pending and stop the background thread
+     */
+    void close();
+
+    WriteAheadLogStats getStats();
+
+    const std::string& getLogPath() const { return logPath; }
+    const std::string& getBasePath() const { return basePath; }
+
+private:
+    std::string logPath;
+    std::string basePath;
+    size_t compactBytes;
+    int fd;
+
+    // Guards everything below; file I/O happens under fileMutex instead
+    std::mutex mutex;
+    std::condition_variable work;
+    std::condition_variable synced;
+    std::string pending;            // Encoded frames not yet written
+    uint64_t queuedSeq;             // Last batch added to pending
+    uint64_t durableSeq;            // Last batch fsynced
+    bool failed;
+    bool stopping;
+    WriteAheadLogStats stats;
+
+    // Held while the file is written, compacted or read back
+    std::mutex fileMutex;
+    uint64_t baseRows;              // Identity of the base CSV under the log
+    uint32_t baseCRC;
+    std::atomic<size_t> logSize;
+
+    std::thread flusher;
+
+    void flushLoop();
+    bool compact();
+    bool resetLog(uint64_t rows, uint32_t crc);
+    bool readRecords(std::vector<ElectionRecord>& records);
+};
+
+#endif // WRITE_AHEAD_LOG_H
@@ -0,0 +1,67 @@
+#include "../include/AdmissionControl.h"
+
+AdmissionControl::AdmissionControl(int standardLimit, int heavyLimit) : shedConnectionCount(0) {
+    limits[static_cast<int>(CostClass::Cheap)] = 0;
+    limits[static_cast<int>(CostClass::Standard)] = standardLimit;
+    limits[static_cast<int>(CostClass::Heavy)] = heavyLimit;
+    for (int i = 0; i < CLASS_COUNT; i++) {
+        inFlight[i] = 0;
+        admitted[i] = 0;
+        shed[i] = 0;
+    }
+}
+
+// Endpoints not listed are treated as Standard
+CostClass AdmissionControl::classify(const std::string& endpoint) {
+    if (endpoint == "/api/countries" || endpoint == "/api/server-stats" || endpoint == "/api/live") {
+        return CostClass::Cheap;
+    }
+    if (endpoint == "/api/compare" || endpoint == "/api/incumbency" || endpoint == "/api/cube" ||
+        endpoint == "/api/batch") {
+        return CostClass::Heavy;
+    }
+    return CostClass::Standard;
+}
+
+const char* AdmissionControl::className(CostClass cost) {
+    switch (cost) {
+        case CostClass::Cheap: return "cheap";
+        case CostClass::Standard: return "standard";
+        case CostClass::Heavy: return "heavy";
+    }
+    return "unknown";
+}
+
+bool AdmissionControl::tryAdmit(CostClass cost, bool saturated) {
+    int index = static_cast<int>(cost);
+    int previous = inFlight[index].fetch_add(1);
+    if (saturated && limits[index] > 0 && previous >= limits[index]) {
+        inFlight[index].fetch_sub(1);
+        shed[index]++;
+        return false;
+    }
+    admitted[index]++;
+    return true;
+}
+
+void AdmissionControl::release(CostClass cost) {
+    inFlight[static_cast<int>(cost)].fetch_sub(1);
+}
+
+void AdmissionControl::recordShedConnection() {
+    shedConnectionCount++;
+}
+
+CostClassStats AdmissionControl::getStats(CostClass cost) const {
+    int index = static_cast<int>(cost);
+    CostClassStats stats;
+    stats.inFlight = inFlight[index].load();
+    stats.limit = limits[index];
+    stats.admitted = admitted[index].load();
+    stats.shed = shed[index].load();
+    return stats;
+}
+
+long long AdmissionControl::shedConnections() const {
+    return shedConnectionCount.load();
+}
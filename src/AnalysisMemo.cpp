@@ -0,0 +1,50 @@
+#include "../include/AnalysisMemo.h"
+#include <algorithm>
+#include <limits>
+
+AnalysisMemo::AnalysisMemo(ElectionData& data) : data(data) {
+}
+
+// The first caller for a key computes outside the lock; later callers
+// find its future in the map and wait on it
+template <typename T, typename Compute>
+std::shared_future<T> AnalysisMemo::shared(std::map<ElectionKey, std::shared_future<T>>& results,
+                                           const ElectionKey& key, Compute compute) {
+    std::promise<T> promise;
+    std::shared_future<T> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = results.find(key);
+        if (it != results.end()) {
+            return it->second;
+        }
+        result = promise.get_future().share();
+        results[key] = result;
+    }
+
+    try {
+        promise.set_value(compute());
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+    return result;
+}
+
+ElectionStats AnalysisMemo::electionStats(const std::string& country, int year) {
+    return shared(stats, ElectionKey(country, year), [&] {
+        return ElectionAnalyzer::calculateElectionStats(data, country, year);
+    }).get();
+}
+
+ComparativeAnalysis AnalysisMemo::compareElections(const std::string& country, int year1, int year2) {
+    return ElectionAnalyzer::compareElections(electionStats(country, year1), electionStats(country, year2));
+}
+
+std::vector<ElectionRecord> AnalysisMemo::topCandidates(const std::string& country, int year, int n) {
+    std::shared_future<std::vector<ElectionRecord>> ranking = shared(rankings, ElectionKey(country, year), [&] {
+        return ElectionAnalyzer::getTopCandidates(data, country, year, std::numeric_limits<int>::max());
+    });
+    const std::vector<ElectionRecord>& ranked = ranking.get();
+    size_t count = std::min(ranked.size(), static_cast<size_t>(std::max(n, 0)));
+    return std::vector<ElectionRecord>(ranked.begin(), ranked.begin() + count);
+}
@@ -0,0 +1,206 @@
+#include "../include/BinaryWriter.h"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Big-endian bytes of value after a one-byte tag
+size_t tagged(char* buffer, unsigned char tag, uint64_t value, size_t width) {
+    buffer[0] = static_cast<char>(tag);
+    for (size_t i = 0; i < width; i++) {
+        buffer[width - i] = static_cast<char>(value >> (8 * i));
+    }
+    return width + 1;
+}
+
+// CBOR head: major type in the top three bits, then the argument
+size_t cborHead(char* buffer, unsigned major, uint64_t value) {
+    unsigned char type = static_cast<unsigned char>(major << 5);
+    if (value < 24) {
+        buffer[0] = static_cast<char>(type | value);
+        return 1;
+    }
+    if (value <= 0xFF) return tagged(buffer, type | 24, value, 1);
+    if (value <= 0xFFFF) return tagged(buffer, type | 25, value, 2);
+    if (value <= 0xFFFFFFFFULL) return tagged(buffer, type | 26, value, 4);
+    return tagged(buffer, type | 27, value, 8);
+}
+
+// MessagePack map/array/string head, picking the fix form when it fits
+size_t msgpackHead(char* buffer, unsigned char fix, unsigned fixLimit, const unsigned char* tags, uint64_t length) {
+    if (length < fixLimit) {
+        buffer[0] = static_cast<char>(fix | length);
+        return 1;
+    }
+    if (tags[0] && length <= 0xFF) return tagged(buffer, tags[0], length, 1);
+    if (length <= 0xFFFF) return tagged(buffer, tags[1], length, 2);
+    return tagged(buffer, tags[2], length, 4);
+}
+
+const unsigned char MSGPACK_STR[] = {0xd9, 0xda, 0xdb};
+const unsigned char MSGPACK_ARRAY[] = {0, 0xdc, 0xdd};
+const unsigned char MSGPACK_MAP[] = {0, 0xde, 0xdf};
+
+} // namespace
+
+BinaryWriter::BinaryWriter(std::string& out, BinaryFormat format) : out(out), format(format), depth(0) {
+}
+
+void BinaryWriter::counted() {
+    if (depth > 0 && !open[depth - 1].isMap) {
+        open[depth - 1].count++;
+    }
+}
+
+BinaryWriter& BinaryWriter::begin(bool isMap) {
+    if (depth == MAX_DEPTH) {
+        throw std::length_error("BinaryWriter nested deeper than MAX_DEPTH");
+    }
+    counted();
+    open[depth].start = out.length();
+    open[depth].count = 0;
+    open[depth].isMap = isMap;
+    depth++;
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::end() {
+    const Container& container = open[--depth];
+    char head[9];
+    size_t length;
+    if (format == BinaryFormat::CBOR) {
+        length = cborHead(head, container.isMap ? 5 : 4, container.count);
+    } else if (container.isMap) {
+        length = msgpackHead(head, 0x80, 16, MSGPACK_MAP, container.count);
+    } else {
+        length = msgpackHead(head, 0x90, 16, MSGPACK_ARRAY, container.count);
+    }
+    out.insert(container.start, head, length);
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::beginObject() { return begin(true); }
+BinaryWriter& BinaryWriter::endObject() { return end(); }
+BinaryWriter& BinaryWriter::beginArray() { return begin(false); }
+BinaryWriter& BinaryWriter::endArray() { return end(); }
+
+void BinaryWriter::text(const char* data, size_t length) {
+    char head[9];
+    size_t headLength = format == BinaryFormat::CBOR
+        ? cborHead(head, 3, length)
+        : msgpackHead(head, 0xa0, 32, MSGPACK_STR, length);
+    out.append(head, headLength);
+    out.append(data, length);
+}
+
+BinaryWriter& BinaryWriter::key(const char* name) {
+    open[depth - 1].count++;
+    text(name, std::strlen(name));
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::key(const std::string& name) {
+    open[depth - 1].count++;
+    text(name.data(), name.length());
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::value(const std::string& textValue) {
+    counted();
+    text(textValue.data(), textValue.length());
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::value(const char* textValue) {
+    counted();
+    text(textValue, std::strlen(textValue));
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::value(bool flag) {
+    counted();
+    if (format == BinaryFormat::CBOR) {
+        out += static_cast<char>(flag ? 0xf5 : 0xf4);
+    } else {
+        out += static_cast<char>(flag ? 0xc3 : 0xc2);
+    }
+    return *this;
+}
+
+void BinaryWriter::unsignedInteger(unsigned long long number) {
+    char buffer[9];
+    size_t length;
+    if (format == BinaryFormat::CBOR) {
+        length = cborHead(buffer, 0, number);
+    } else if (number < 0x80) {
+        buffer[0] = static_cast<char>(number);
+        length = 1;
+    } else if (number <= 0xFF) {
+        length = tagged(buffer, 0xcc, number, 1);
+    } else if (number <= 0xFFFF) {
+        length = tagged(buffer, 0xcd, number, 2);
+    } else if (number <= 0xFFFFFFFFULL) {
+        length = tagged(buffer, 0xce, number, 4);
+    } else {
+        length = tagged(buffer, 0xcf, number, 8);
+    }
+    out.append(buffer, length);
+}
+
+void BinaryWriter::signedInteger(long long number) {
+    if (number >= 0) {
+        unsignedInteger(static_cast<unsigned long long>(number));
+        return;
+    }
+
+    char buffer[9];
+    size_t length;
+    if (format == BinaryFormat::CBOR) {
+        // Negative integers carry -1 - n, which cannot overflow
+        length = cborHead(buffer, 1, static_cast<unsigned long long>(-(number + 1)));
+    } else if (number >= -32) {
+        buffer[0] = static_cast<char>(number);
+        length = 1;
+    } else if (number >= -0x80) {
+        length = tagged(buffer, 0xd0, static_cast<uint64_t>(number), 1);
+    } else if (number >= -0x8000) {
+        length = tagged(buffer, 0xd1, static_cast<uint64_t>(number), 2);
+    } else if (number >= -0x80000000LL) {
+        length = tagged(buffer, 0xd2, static_cast<uint64_t>(number), 4);
+    } else {
+        length = tagged(buffer, 0xd3, static_cast<uint64_t>(number), 8);
+    }
+    out.append(buffer, length);
+}
+
+BinaryWriter& BinaryWriter::value(int number) { counted(); signedInteger(number); return *this; }
+BinaryWriter& BinaryWriter::value(long number) { counted(); signedInteger(number); return *this; }
+BinaryWriter& BinaryWriter::value(long long number) { counted(); signedInteger(number); return *this; }
+BinaryWriter& BinaryWriter::value(unsigned long number) { counted(); unsignedInteger(number); return *this; }
+BinaryWriter& BinaryWriter::value(unsigned long long number) { counted(); unsignedInteger(number); return *this; }
+
+BinaryWriter& BinaryWriter::value(double number) {
+    if (!std::isfinite(number)) {
+        return null();
+    }
+
+    counted();
+    uint64_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    char buffer[9];
+    out.append(buffer, tagged(buffer, format == BinaryFormat::CBOR ? 0xfb : 0xcb, bits, 8));
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::null() {
+    counted();
+    out += static_cast<char>(format == BinaryFormat::CBOR ? 0xf6 : 0xc0);
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::raw(const std::string& encoded) {
+    counted();
+    out += encoded;
+    return *this;
+}
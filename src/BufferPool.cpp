@@ -0,0 +1,36 @@
+#include "../include/BufferPool.h"
+
+BufferPool::BufferPool(size_t bufferSize, size_t maxPooled)
+    : bufferSize(bufferSize), maxPooled(maxPooled) {
+}
+
+BufferPool::~BufferPool() {
+    for (size_t i = 0; i < freeBuffers.size(); i++) {
+        delete freeBuffers[i];
+    }
+}
+
+// Reuse a pooled buffer if there is one
+std::vector<char>* BufferPool::acquire() {
+    if (freeBuffers.empty()) {
+        return new std::vector<char>(bufferSize);
+    }
+
+    std::vector<char>* buffer = freeBuffers.back();
+    freeBuffers.pop_back();
+    return buffer;
+}
+
+// Keep normal-sized buffers; free ones that grew for a large request
+void BufferPool::release(std::vector<char>* buffer) {
+    if (buffer == nullptr) {
+        return;
+    }
+
+    if (freeBuffers.size() >= maxPooled || buffer->size() > bufferSize * 4) {
+        delete buffer;
+        return;
+    }
+
+    freeBuffers.push_back(buffer);
+}
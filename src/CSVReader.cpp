@@ -1,9 +1,13 @@
 #include "../include/CSVReader.h"
+#include "../include/Trace.h"
 #include <fstream>
 #include <sstream>
+#include <charconv>
+#include <limits>
 
 // Read CSV file and load data
 bool CSVReader::readFromFile(const std::string& filename, ElectionData& data) {
+    TRACE_SPAN("CSVReader::readFromFile");
     std::ifstream file(filename);
     if (!file.is_open()) {
         return false;
@@ -35,6 +39,7 @@ bool CSVReader::readFromFile(const std::string& filename, ElectionData& data) {
 
 // Parse one CSV line into an ElectionRecord
 ElectionRecord CSVReader::parseLine(const std::string& line) {
+    TRACE_SPAN("CSVReader::parseLine");
     std::vector<std::string> tokens = split(line, ',');
 
     ElectionRecord record;
@@ -54,6 +59,31 @@ ElectionRecord CSVReader::parseLine(const std::string& line) {
     return record;
 }
 
+// Parse one CSV line from an untrusted source; nothing is guessed, so a
+// bad row is rejected rather than stored with shifted or wrapped fields
+bool CSVReader::tryParseLine(const std::string& line, ElectionRecord& record) {
+    std::vector<std::string> tokens = split(line, ',');
+    if (tokens.size() != 7) {
+        return false;
+    }
+
+    ElectionRecord parsed;
+    parsed.country = trim(tokens[0]);
+    parsed.constituency = trim(tokens[2]);
+    parsed.candidate = trim(tokens[3]);
+    parsed.party = trim(tokens[4]);
+    if (parsed.country.empty() || parsed.candidate.empty() ||
+        !parseCount(trim(tokens[1]), 9999, parsed.year) || parsed.year == 0 ||
+        !parseCount(trim(tokens[5]), std::numeric_limits<int>::max(), parsed.votes)) {
+        return false;
+    }
+    std::string electedStr = trim(tokens[6]);
+    parsed.elected = (electedStr == "Yes" || electedStr == "yes" || electedStr == "YES");
+
+    record = parsed;
+    return true;
+}
+
 // Split string by comma
 std::vector<std::string> CSVReader::split(const std::string& str, char delimiter) {
     std::vector<std::string> tokens;
@@ -105,3 +135,13 @@ int CSVReader::stringToInt(const std::string& str) {
     return result;
 }
 
+// Parse a count; signs, spaces inside and trailing characters are rejected
+bool CSVReader::parseCount(const std::string& str, int max, int& value) {
+    if (str.empty() || str[0] < '0' || str[0] > '9') {
+        return false;
+    }
+    const char* end = str.data() + str.length();
+    std::from_chars_result result = std::from_chars(str.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end && value <= max;
+}
+
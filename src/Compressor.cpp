@@ -0,0 +1,106 @@
+#include "../include/Compressor.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+#ifdef ELECTION_HAVE_ZLIB
+    #include <zlib.h>
+#endif
+
+Compressor::Compressor(int level) : stream(nullptr) {
+#ifdef ELECTION_HAVE_ZLIB
+    z_stream* z = new z_stream();
+    // 15 + 16: largest window, gzip header and trailer instead of raw zlib
+    if (deflateInit2(z, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+        stream = z;
+    } else {
+        delete z;
+    }
+#else
+    (void)level;
+#endif
+}
+
+Compressor::~Compressor() {
+#ifdef ELECTION_HAVE_ZLIB
+    if (stream != nullptr) {
+        z_stream* z = static_cast<z_stream*>(stream);
+        deflateEnd(z);
+        delete z;
+    }
+#endif
+}
+
+bool Compressor::available() {
+#ifdef ELECTION_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+// "gzip", "gzip;q=0.8", "*" are accepted; "gzip;q=0" refuses
+bool Compressor::acceptsGzip(const std::string& acceptEncoding) {
+    size_t pos = 0;
+    bool wildcard = false;
+    while (pos < acceptEncoding.length()) {
+        size_t comma = acceptEncoding.find(',', pos);
+        if (comma == std::string::npos) comma = acceptEncoding.length();
+        std::string item = acceptEncoding.substr(pos, comma - pos);
+        pos = comma + 1;
+
+        std::transform(item.begin(), item.end(), item.begin(), ::tolower);
+        item.erase(std::remove_if(item.begin(), item.end(), ::isspace), item.end());
+
+        size_t semicolon = item.find(';');
+        std::string coding = item.substr(0, semicolon);
+        bool refused = false;
+        if (semicolon != std::string::npos) {
+            size_t q = item.find("q=", semicolon);
+            refused = q != std::string::npos && std::atof(item.c_str() + q + 2) <= 0.0;
+        }
+
+        if (coding == "gzip" || coding == "x-gzip") {
+            return !refused;
+        }
+        if (coding == "*") {
+            wildcard = !refused;
+        }
+    }
+    return wildcard;
+}
+
+bool Compressor::compressible(const std::string& contentType) {
+    return contentType.compare(0, 5, "text/") == 0 ||
+           contentType == "application/json" ||
+           contentType == "application/javascript";
+}
+
+bool Compressor::gzip(const char* data, size_t length, std::string& out) {
+#ifdef ELECTION_HAVE_ZLIB
+    if (stream == nullptr) {
+        return false;
+    }
+    z_stream* z = static_cast<z_stream*>(stream);
+    deflateReset(z);
+
+    out.resize(deflateBound(z, length));
+    z->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    z->avail_in = static_cast<uInt>(length);
+    z->next_out = reinterpret_cast<Bytef*>(&out[0]);
+    z->avail_out = static_cast<uInt>(out.size());
+
+    // deflateBound guarantees one call is enough
+    if (deflate(z, Z_FINISH) != Z_STREAM_END) {
+        out.clear();
+        return false;
+    }
+    out.resize(z->total_out);
+    return true;
+#else
+    (void)data;
+    (void)length;
+    out.clear();
+    return false;
+#endif
+}
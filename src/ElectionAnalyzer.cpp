@@ -1,165 +1,120 @@
 #include "../include/ElectionAnalyzer.h"
-
-// Calculate total votes for an election
-int ElectionAnalyzer::calculateTotalVotes(ElectionData& data, const std::string& country, int year) {
-    std::vector<ElectionRecord> records = data.getElectionRecords(country, year);
-    int total = 0;
-
-    for (int i = 0; i < records.size(); i++) {
-        total += records[i].votes;
-    }
-
-    return total;
+#include "../include/Trace.h"
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <map>
+#include <set>
+
+// Calculate total votes for an election (one cube cell)
+long long ElectionAnalyzer::calculateTotalVotes(ElectionData& data, const std::string& country, int year) {
+    TRACE_SPAN("ElectionAnalyzer::calculateTotalVotes");
+    CubeSlice slice;
+    slice.country = country;
+    slice.year = year;
+    return data.getCubeTotal(slice).votes;
 }
 
-// Calculate total seats won
+// Calculate total seats won (one cube cell)
 int ElectionAnalyzer::calculateTotalSeats(ElectionData& data, const std::string& country, int year) {
-    std::vector<ElectionRecord> records = data.getElectionRecords(country, year);
-    int seats = 0;
-
-    for (int i = 0; i < records.size(); i++) {
-        if (records[i].elected) {
-            seats++;
-        }
-    }
-
-    return seats;
+    TRACE_SPAN("ElectionAnalyzer::calculateTotalSeats");
+    CubeSlice slice;
+    slice.country = country;
+    slice.year = year;
+    return data.getCubeTotal(slice).seats;
 }
 
-// Calculate party-wise statistics
+// Calculate party-wise statistics from the party roll-up of the cube
 std::vector<PartyStats> ElectionAnalyzer::calculatePartyVoteShares(ElectionData& data, const std::string& country, int year) {
-    std::vector<ElectionRecord> records = data.getElectionRecords(country, year);
-    std::vector<PartyStats> partyList;
+    TRACE_SPAN("ElectionAnalyzer::calculatePartyVoteShares");
+    CubeSlice slice;
+    slice.country = country;
+    slice.year = year;
 
-    int totalVotes = calculateTotalVotes(data, country, year);
+    long long totalVotes = data.getCubeTotal(slice).votes;
+    std::vector<CubeCell> cells = data.queryCube(ElectionCube::Party, slice);
 
-    // For each record, find or create party stats
-    for (int i = 0; i < records.size(); i++) {
-        // Find if party already exists in list
-        int partyIndex = -1;
-        for (int j = 0; j < partyList.size(); j++) {
-            if (partyList[j].party == records[i].party) {
-                partyIndex = j;
-                break;
-            }
-        }
-
-        // If party not found, create new entry
-        if (partyIndex == -1) {
-            PartyStats newParty;
-            newParty.party = records[i].party;
-            newParty.totalVotes = 0;
-            newParty.seatsWon = 0;
-            newParty.candidatesCount = 0;
-            newParty.voteShare = 0.0;
-            partyList.push_back(newParty);
-            partyIndex = partyList.size() - 1;
-        }
-
-        // Update party stats
-        partyList[partyIndex].totalVotes += records[i].votes;
-        partyList[partyIndex].candidatesCount++;
-        if (records[i].elected) {
-            partyList[partyIndex].seatsWon++;
-        }
-    }
-
-    // Calculate vote shares
-    for (int i = 0; i < partyList.size(); i++) {
+    std::vector<PartyStats> partyList;
+    for (int i = 0; i < cells.size(); i++) {
+        PartyStats ps;
+        ps.party = cells[i].party;
+        ps.totalVotes = cells[i].votes;
+        ps.seatsWon = cells[i].seats;
+        ps.candidatesCount = cells[i].candidates;
         if (totalVotes > 0) {
-            partyList[i].voteShare = (partyList[i].totalVotes * 100.0) / totalVotes;
+            ps.voteShare = (cells[i].votes * 100.0) / totalVotes;
         }
+        partyList.push_back(ps);
     }
 
-    // Sort by total votes (bubble sort - simple!)
-    for (int i = 0; i < partyList.size() - 1; i++) {
-        for (int j = 0; j < partyList.size() - i - 1; j++) {
-            if (partyList[j].totalVotes < partyList[j + 1].totalVotes) {
-                // Swap
-                PartyStats temp = partyList[j];
-                partyList[j] = partyList[j + 1];
-                partyList[j + 1] = temp;
-            }
-        }
-    }
+    // Sort by total votes (ties stay in party name order)
+    std::stable_sort(partyList.begin(), partyList.end(), [](const PartyStats& a, const PartyStats& b) {
+        return a.totalVotes > b.totalVotes;
+    });
 
     return partyList;
 }
 
 // Calculate election statistics
 ElectionStats ElectionAnalyzer::calculateElectionStats(ElectionData& data, const std::string& country, int year) {
+    TRACE_SPAN("ElectionAnalyzer::calculateElectionStats");
     ElectionStats stats;
     stats.country = country;
     stats.year = year;
 
-    std::vector<ElectionRecord> records = data.getElectionRecords(country, year);
-
-    stats.totalVotes = calculateTotalVotes(data, country, year);
-    stats.totalSeats = calculateTotalSeats(data, country, year);
-    stats.totalCandidates = records.size();
+    CubeSlice slice;
+    slice.country = country;
+    slice.year = year;
+    CubeCell total = data.getCubeTotal(slice);
 
-    // Count unique constituencies
-    std::vector<std::string> constituencies;
-    for (int i = 0; i < records.size(); i++) {
-        bool found = false;
-        for (int j = 0; j < constituencies.size(); j++) {
-            if (constituencies[j] == records[i].constituency) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            constituencies.push_back(records[i].constituency);
-        }
-    }
-    stats.constituencies = constituencies.size();
+    stats.totalVotes = total.votes;
+    stats.totalSeats = total.seats;
+    stats.totalCandidates = total.candidates;
+    stats.constituencies = total.constituencies;
 
     stats.partyStats = calculatePartyVoteShares(data, country, year);
 
     return stats;
 }
 
-// Get seat distribution
+// Get seat distribution (parties with at least one seat, most seats first)
 std::vector<SeatInfo> ElectionAnalyzer::getSeatDistribution(ElectionData& data, const std::string& country, int year) {
-    std::vector<ElectionRecord> records = data.getElectionRecords(country, year);
-    std::vector<SeatInfo> seatList;
-
-    for (int i = 0; i < records.size(); i++) {
-        if (records[i].elected) {
-            // Find if party already exists
-            int partyIndex = -1;
-            for (int j = 0; j < seatList.size(); j++) {
-                if (seatList[j].party == records[i].party) {
-                    partyIndex = j;
-                    break;
-                }
-            }
+    TRACE_SPAN("ElectionAnalyzer::getSeatDistribution");
+    CubeSlice slice;
+    slice.country = country;
+    slice.year = year;
+    std::vector<CubeCell> cells = data.queryCube(ElectionCube::Party, slice);
 
-            if (partyIndex == -1) {
-                SeatInfo newSeat;
-                newSeat.party = records[i].party;
-                newSeat.seats = 1;
-                seatList.push_back(newSeat);
-            } else {
-                seatList[partyIndex].seats++;
-            }
+    std::vector<SeatInfo> seatList;
+    for (int i = 0; i < cells.size(); i++) {
+        if (cells[i].seats > 0) {
+            SeatInfo info;
+            info.party = cells[i].party;
+            info.seats = cells[i].seats;
+            seatList.push_back(info);
         }
     }
 
+    std::stable_sort(seatList.begin(), seatList.end(), [](const SeatInfo& a, const SeatInfo& b) {
+        return a.seats > b.seats;
+    });
+
     return seatList;
 }
 
 // Rank parties by votes
 std::vector<PartyStats> ElectionAnalyzer::rankPartiesByVotes(ElectionData& data, const std::string& country, int year) {
+    TRACE_SPAN("ElectionAnalyzer::rankPartiesByVotes");
     return calculatePartyVoteShares(data, country, year);
 }
 
 // Get top N candidates
 std::vector<ElectionRecord> ElectionAnalyzer::getTopCandidates(ElectionData& data, const std::string& country, int year, int n) {
+    TRACE_SPAN("ElectionAnalyzer::getTopCandidates");
     std::vector<ElectionRecord> records = data.getElectionRecords(country, year);
 
     // Sort by votes using bubble sort
-    for (int i = 0; i < records.size() - 1; i++) {
+    for (int i = 0; i + 1 < records.size(); i++) {
         for (int j = 0; j < records.size() - i - 1; j++) {
             if (records[j].votes < records[j + 1].votes) {
                 // Swap
@@ -181,6 +136,7 @@ std::vector<ElectionRecord> ElectionAnalyzer::getTopCandidates(ElectionData& dat
 
 // Get winning candidates
 std::vector<ElectionRecord> ElectionAnalyzer::getWinningCandidates(ElectionData& data, const std::string& country, int year) {
+    TRACE_SPAN("ElectionAnalyzer::getWinningCandidates");
     std::vector<ElectionRecord> records = data.getElectionRecords(country, year);
     std::vector<ElectionRecord> winners;
 
@@ -191,7 +147,7 @@ std::vector<ElectionRecord> ElectionAnalyzer::getWinningCandidates(ElectionData&
     }
 
     // Sort by votes
-    for (int i = 0; i < winners.size() - 1; i++) {
+    for (int i = 0; i + 1 < winners.size(); i++) {
         for (int j = 0; j < winners.size() - i - 1; j++) {
             if (winners[j].votes < winners[j + 1].votes) {
                 ElectionRecord temp = winners[j];
@@ -204,15 +160,88 @@ std::vector<ElectionRecord> ElectionAnalyzer::getWinningCandidates(ElectionData&
     return winners;
 }
 
+// One scan gathers the totals, the party roll-up and the records; one
+// stable sort by votes then gives both the top candidates and the winners
+// in the order the separate functions return them
+ElectionDashboard ElectionAnalyzer::buildDashboard(ElectionData& data, const std::string& country, int year, int topN) {
+    TRACE_SPAN("ElectionAnalyzer::buildDashboard");
+    ElectionDashboard dashboard;
+    ElectionStats& stats = dashboard.stats;
+    stats.country = country;
+    stats.year = year;
+
+    long long totalVotes = 0;
+    std::map<std::string, PartyStats> parties;     // Party name order, as the cube
+    std::set<std::string> constituencies;
+    std::vector<ElectionRecord> ranked;
+    data.scanRecords(country, year, 0, std::numeric_limits<int>::max(), [&](const ElectionRecord& record) {
+        totalVotes += record.votes;
+        PartyStats& party = parties[record.party];
+        party.totalVotes += record.votes;
+        party.candidatesCount++;
+        if (record.elected) {
+            party.seatsWon++;
+            stats.totalSeats++;
+        }
+        constituencies.insert(record.constituency);
+        ranked.push_back(record);
+        return true;
+    });
+    stats.totalVotes = totalVotes;
+    stats.totalCandidates = static_cast<int>(ranked.size());
+    stats.constituencies = static_cast<int>(constituencies.size());
+
+    for (auto& pair : parties) {
+        PartyStats& party = pair.second;
+        party.party = pair.first;
+        if (totalVotes > 0) {
+            party.voteShare = (party.totalVotes * 100.0) / totalVotes;
+        }
+        stats.partyStats.push_back(party);
+        if (party.seatsWon > 0) {
+            SeatInfo info;
+            info.party = party.party;
+            info.seats = party.seatsWon;
+            dashboard.seats.push_back(info);
+        }
+    }
+    std::stable_sort(stats.partyStats.begin(), stats.partyStats.end(), [](const PartyStats& a, const PartyStats& b) {
+        return a.totalVotes > b.totalVotes;
+    });
+    std::stable_sort(dashboard.seats.begin(), dashboard.seats.end(), [](const SeatInfo& a, const SeatInfo& b) {
+        return a.seats > b.seats;
+    });
+
+    std::stable_sort(ranked.begin(), ranked.end(), [](const ElectionRecord& a, const ElectionRecord& b) {
+        return a.votes > b.votes;
+    });
+    for (const ElectionRecord& record : ranked) {
+        if (static_cast<int>(dashboard.topCandidates.size()) < topN) {
+            dashboard.topCandidates.push_back(record);
+        }
+        if (record.elected) {
+            dashboard.winners.push_back(record);
+        }
+    }
+
+    return dashboard;
+}
+
 // Compare two elections
 ComparativeAnalysis ElectionAnalyzer::compareElections(ElectionData& data, const std::string& country, int year1, int year2) {
-    ComparativeAnalysis analysis;
-    analysis.country = country;
-    analysis.year1 = year1;
-    analysis.year2 = year2;
-
+    TRACE_SPAN("ElectionAnalyzer::compareElections");
     ElectionStats stats1 = calculateElectionStats(data, country, year1);
     ElectionStats stats2 = calculateElectionStats(data, country, year2);
+    return compareElections(stats1, stats2);
+}
+
+// Compare two elections whose statistics are already known
+ComparativeAnalysis ElectionAnalyzer::compareElections(const ElectionStats& stats1, const ElectionStats& stats2) {
+    ComparativeAnalysis analysis;
+    analysis.country = stats1.country;
+    analysis.year1 = stats1.year;
+    analysis.year2 = stats2.year;
+    analysis.voteChangePercent = 0.0;
 
     analysis.voteChange = stats2.totalVotes - stats1.totalVotes;
     if (stats1.totalVotes > 0) {
@@ -222,11 +251,11 @@ ComparativeAnalysis ElectionAnalyzer::compareElections(ElectionData& data, const
     // Compare parties
     for (int i = 0; i < stats1.partyStats.size(); i++) {
         std::string party = stats1.partyStats[i].party;
-        int votes1 = stats1.partyStats[i].totalVotes;
+        long long votes1 = stats1.partyStats[i].totalVotes;
         int seats1 = stats1.partyStats[i].seatsWon;
 
         // Find same party in year2
-        int votes2 = 0;
+        long long votes2 = 0;
         int seats2 = 0;
         bool foundInYear2 = false;
 
@@ -272,6 +301,7 @@ ComparativeAnalysis ElectionAnalyzer::compareElections(ElectionData& data, const
 
 // Get party trend across years
 std::vector<PartyTrend> ElectionAnalyzer::getPartyTrend(ElectionData& data, const std::string& country, const std::string& party, std::vector<int> years) {
+    TRACE_SPAN("ElectionAnalyzer::getPartyTrend");
     std::vector<PartyTrend> trend;
 
     for (int i = 0; i < years.size(); i++) {
@@ -291,3 +321,179 @@ std::vector<PartyTrend> ElectionAnalyzer::getPartyTrend(ElectionData& data, cons
     return trend;
 }
 
+
+// Summarize one sketch as quantiles and a histogram
+static VoteDistribution summarizeSketch(const QuantileSketch& sketch, int bins) {
+    VoteDistribution dist;
+    dist.count = sketch.count();
+    dist.min = sketch.min();
+    dist.max = sketch.max();
+    dist.p50 = sketch.quantile(0.50);
+    dist.p90 = sketch.quantile(0.90);
+    dist.p99 = sketch.quantile(0.99);
+    dist.histogram = sketch.histogram(bins);
+    return dist;
+}
+
+// Get vote distributions from the sketches kept by ElectionData
+ElectionDistribution ElectionAnalyzer::getVoteDistribution(ElectionData& data, const std::string& country, int year, int bins) {
+    TRACE_SPAN("ElectionAnalyzer::getVoteDistribution");
+    ElectionDistribution result;
+    result.country = country;
+    result.year = year;
+
+    result.candidates = summarizeSketch(data.getCandidateVoteSketch(country, year), bins);
+
+    // Constituency totals change as candidates are added, so they are
+    // sketched here (one value per constituency, no sorting needed)
+    QuantileSketch constituencySketch;
+    std::map<std::string, long long> constituencyVotes = data.getConstituencyVotes(country, year);
+    for (const auto& pair : constituencyVotes) {
+        constituencySketch.add(pair.second);
+    }
+    result.constituencies = summarizeSketch(constituencySketch, bins);
+
+    return result;
+}
+
+// Fuzzy search names and attach the elections they appear in
+std::vector<SearchResult> ElectionAnalyzer::searchNames(ElectionData& data, const std::string& query, int limit) {
+    TRACE_SPAN("ElectionAnalyzer::searchNames");
+    std::vector<SearchResult> results;
+    std::vector<SearchMatch> matches = data.searchNames(query, limit);
+
+    for (int i = 0; i < matches.size(); i++) {
+        SearchResult result;
+        result.name = matches[i].name;
+        result.score = matches[i].score;
+        switch (matches[i].field) {
+            case SearchField::Candidate: result.field = "candidate"; break;
+            case SearchField::Party: result.field = "party"; break;
+            case SearchField::Constituency: result.field = "constituency"; break;
+        }
+
+        for (int j = 0; j < matches[i].recordIds.size(); j++) {
+            ElectionRecord record = data.getRecord(matches[i].recordIds[j]);
+
+            // Find if election already listed
+            int electionIndex = -1;
+            for (int k = 0; k < result.elections.size(); k++) {
+                if (result.elections[k].country == record.country && result.elections[k].year == record.year) {
+                    electionIndex = k;
+                    break;
+                }
+            }
+
+            if (electionIndex == -1) {
+                ElectionRef ref;
+                ref.country = record.country;
+                ref.year = record.year;
+                ref.records = 1;
+                result.elections.push_back(ref);
+            } else {
+                result.elections[electionIndex].records++;
+            }
+
+            if (matches[i].field == SearchField::Candidate) {
+                result.records.push_back(record);
+            }
+        }
+
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+// Get a candidate's career from the candidate index
+CandidateHistory ElectionAnalyzer::getCandidateHistory(ElectionData& data, const std::string& name, const std::string& party) {
+    TRACE_SPAN("ElectionAnalyzer::getCandidateHistory");
+    CandidateHistory history;
+    history.records = data.getCandidateRecords(name, party);
+    if (history.records.empty()) {
+        return history;
+    }
+    history.name = history.records[0].candidate;
+
+    std::stable_sort(history.records.begin(), history.records.end(),
+                     [](const ElectionRecord& a, const ElectionRecord& b) {
+                         if (a.year != b.year) return a.year < b.year;
+                         return a.country < b.country;
+                     });
+
+    // Count distinct elections and seats (a candidate may stand in two lists)
+    std::set<std::pair<std::string, int>> elections;
+    std::set<std::pair<std::string, int>> won;
+    for (int i = 0; i < history.records.size(); i++) {
+        std::pair<std::string, int> key(history.records[i].country, history.records[i].year);
+        elections.insert(key);
+        if (history.records[i].elected) {
+            won.insert(key);
+        }
+    }
+    history.electionsContested = elections.size();
+    history.seatsWon = won.size();
+
+    return history;
+}
+
+// Check each previous winner with one index lookup
+IncumbencyStats ElectionAnalyzer::calculateIncumbency(ElectionData& data, const std::string& country, int previousYear, int year) {
+    TRACE_SPAN("ElectionAnalyzer::calculateIncumbency");
+    IncumbencyStats stats;
+    stats.country = country;
+    stats.year = year;
+    stats.previousYear = previousYear;
+
+    // Distinct winners of the previous election, by the normalized name
+    // the career lookup uses, so spelling variants count once
+    std::set<std::string> incumbents;
+    std::vector<ElectionRecord> previous = data.getElectionRecords(country, previousYear);
+    for (int i = 0; i < previous.size(); i++) {
+        if (previous[i].elected) {
+            incumbents.insert(SearchIndex::normalize(previous[i].candidate));
+        }
+    }
+    stats.incumbents = incumbents.size();
+
+    for (const std::string& name : incumbents) {
+        std::vector<ElectionRecord> career = data.getCandidateRecords(name);
+        bool standing = false;
+        bool elected = false;
+        for (int i = 0; i < career.size(); i++) {
+            if (career[i].country == country && career[i].year == year) {
+                standing = true;
+                if (career[i].elected) {
+                    elected = true;
+                }
+            }
+        }
+        if (standing) stats.incumbentsStanding++;
+        if (elected) stats.reelected++;
+    }
+
+    if (stats.incumbents > 0) {
+        stats.reelectionRate = (stats.reelected * 100.0) / stats.incumbents;
+    }
+
+    return stats;
+}
+
+// Calculate incumbency for consecutive elections, one task per election
+std::vector<IncumbencyStats> ElectionAnalyzer::calculateIncumbencyTrend(ElectionData& data, const std::string& country) {
+    TRACE_SPAN("ElectionAnalyzer::calculateIncumbencyTrend");
+    std::vector<int> years = data.getElectionYears(country);
+
+    std::vector<std::future<IncumbencyStats>> tasks;
+    for (int i = 1; i < years.size(); i++) {
+        tasks.push_back(std::async(std::launch::async, calculateIncumbency,
+                                   std::ref(data), country, years[i - 1], years[i]));
+    }
+
+    std::vector<IncumbencyStats> trend;
+    for (int i = 0; i < tasks.size(); i++) {
+        trend.push_back(tasks[i].get());
+    }
+
+    return trend;
+}
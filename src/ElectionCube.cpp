@@ -0,0 +1,188 @@
+#include "../include/ElectionCube.h"
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+const int DIMENSIONS[] = {ElectionCube::Country, ElectionCube::Year, ElectionCube::Party, ElectionCube::Constituency};
+
+// Levels that pin a single (country, constituency) pair
+const int PAIR_MASK = ElectionCube::Country | ElectionCube::Constituency;
+
+} // namespace
+
+int ElectionCube::Dictionary::intern(const std::string& name) {
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    int id = names.size();
+    ids[name] = id;
+    names.push_back(name);
+    return id;
+}
+
+int ElectionCube::Dictionary::find(const std::string& name) const {
+    auto it = ids.find(name);
+    return it == ids.end() ? -1 : it->second;
+}
+
+// Build the key of a level from the dimensions in its mask
+ElectionCube::Key ElectionCube::makeKey(int mask, const Key& values) {
+    Key key = {0, 0, 0, 0};
+    for (int d = 0; d < 4; d++) {
+        if (mask & DIMENSIONS[d]) key[d] = values[d];
+    }
+    return key;
+}
+
+// Add the record to the matching cell of every level
+void ElectionCube::addRecord(const ElectionRecord& record) {
+    Key values = {countries.intern(record.country), record.year, parties.intern(record.party),
+                  constituencyNames.intern(record.constituency)};
+
+    // A cell gains a distinct constituency when this record opens the
+    // matching cell at its level plus country and constituency
+    bool firstOfPair[LEVELS] = {};
+    for (int mask = PAIR_MASK; mask < LEVELS; mask++) {
+        if ((mask & PAIR_MASK) == PAIR_MASK) {
+            firstOfPair[mask] = levels[mask][makeKey(mask, values)].candidates == 0;
+        }
+    }
+
+    for (int mask = 0; mask < LEVELS; mask++) {
+        Aggregate& cell = levels[mask][makeKey(mask, values)];
+        cell.votes += record.votes;
+        cell.candidates++;
+        if (record.elected) {
+            cell.seats++;
+        }
+        if (firstOfPair[mask | PAIR_MASK]) {
+            cell.constituencies++;
+        }
+    }
+}
+
+// Read the level for groupBy plus sliced dimensions
+std::vector<CubeCell> ElectionCube::query(int groupBy, const CubeSlice& slice) const {
+    std::vector<CubeCell> result;
+
+    int sliceMask = 0;
+    Key filter = {0, 0, 0, 0};
+    if (!slice.country.empty()) {
+        sliceMask |= Country;
+        filter[0] = countries.find(slice.country);
+    }
+    if (slice.year != 0) {
+        sliceMask |= Year;
+        filter[1] = slice.year;
+    }
+    if (!slice.party.empty()) {
+        sliceMask |= Party;
+        filter[2] = parties.find(slice.party);
+    }
+    if (!slice.constituency.empty()) {
+        sliceMask |= Constituency;
+        filter[3] = constituencyNames.find(slice.constituency);
+    }
+    // A name never seen matches nothing
+    if (filter[0] < 0 || filter[2] < 0 || filter[3] < 0) {
+        return result;
+    }
+
+    int mask = (groupBy | sliceMask) & (LEVELS - 1);
+
+    // Sliced dimensions at the start of the key narrow the range directly;
+    // positions outside the level are always 0
+    Key start = makeKey(mask, filter);
+    int prefixEnd = 0;
+    while (prefixEnd < 4 && (!(mask & DIMENSIONS[prefixEnd]) || (sliceMask & DIMENSIONS[prefixEnd]))) {
+        prefixEnd++;
+    }
+    for (int d = prefixEnd; d < 4; d++) {
+        if (mask & DIMENSIONS[d]) start[d] = std::numeric_limits<int>::min();
+    }
+
+    const std::map<Key, Aggregate>& level = levels[mask];
+    for (auto it = level.lower_bound(start); it != level.end(); ++it) {
+        const Key& key = it->first;
+
+        bool inPrefix = true;
+        for (int d = 0; d < prefixEnd; d++) {
+            if (key[d] != start[d]) {
+                inPrefix = false;
+                break;
+            }
+        }
+        if (!inPrefix) {
+            break;
+        }
+
+        bool matches = true;
+        for (int d = prefixEnd; d < 4; d++) {
+            if ((sliceMask & DIMENSIONS[d]) && key[d] != filter[d]) {
+                matches = false;
+                break;
+            }
+        }
+        if (!matches) {
+            continue;
+        }
+
+        CubeCell cell;
+        if (mask & Country) cell.country = countries.names[key[0]];
+        if (mask & Year) cell.year = key[1];
+        if (mask & Party) cell.party = parties.names[key[2]];
+        if (mask & Constituency) cell.constituency = constituencyNames.names[key[3]];
+        cell.votes = it->second.votes;
+        cell.seats = it->second.seats;
+        cell.candidates = it->second.candidates;
+        cell.constituencies = it->second.constituencies;
+        result.push_back(cell);
+    }
+
+    // Ids follow first appearance; callers expect cells in name order
+    std::sort(result.begin(), result.end(), [](const CubeCell& a, const CubeCell& b) {
+        if (a.country != b.country) return a.country < b.country;
+        if (a.year != b.year) return a.year < b.year;
+        if (a.party != b.party) return a.party < b.party;
+        return a.constituency < b.constituency;
+    });
+    return result;
+}
+
+// Roll everything in the slice up into one cell
+CubeCell ElectionCube::total(const CubeSlice& slice) const {
+    std::vector<CubeCell> cells = query(0, slice);
+    if (cells.empty()) {
+        return CubeCell();
+    }
+    return cells[0];
+}
+
+// Parse a comma separated list of dimension names
+int ElectionCube::parseDimensions(const std::string& list) {
+    int mask = 0;
+    std::istringstream iss(list);
+    std::string name;
+
+    while (std::getline(iss, name, ',')) {
+        if (name == "country") mask |= Country;
+        else if (name == "year") mask |= Year;
+        else if (name == "party") mask |= Party;
+        else if (name == "constituency") mask |= Constituency;
+    }
+
+    return mask;
+}
+
+// Clear the cube
+void ElectionCube::clear() {
+    for (int mask = 0; mask < LEVELS; mask++) {
+        levels[mask].clear();
+    }
+    countries = Dictionary();
+    parties = Dictionary();
+    constituencyNames = Dictionary();
+}
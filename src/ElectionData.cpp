@@ -1,16 +1,73 @@
 #include "../include/ElectionData.h"
+#include "../include/Trace.h"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+// Shared by every instance, so a reloaded dataset never repeats a version
+std::atomic<unsigned long long> versionCounter(0);
+
+} // namespace
+
+// Update the indexes for the record that will be stored next
+void ElectionData::indexRecord(const ElectionRecord& record) {
+    int position = records.size();
+    searchIndex.addRecord(record, position);
+    candidatePostings[SearchIndex::normalize(record.candidate)].push_back(position);
+    cube.addRecord(record);
+
+    // Update the running distribution of this election
+    DistributionIndex& dist = distributions[std::make_pair(record.country, record.year)];
+    dist.candidateVotes.add(record.votes);
+    dist.constituencyVotes[record.constituency] += record.votes;
+
+    // Published last, so no index ever points past the stored records
+    records.append(record);
+}
 
 // Add a new record to the list
 void ElectionData::addRecord(const ElectionRecord& record) {
-    records.push_back(record);
+    TRACE_SPAN("ElectionData::addRecord");
+    std::lock_guard<std::mutex> writer(writeMutex);
+    {
+        std::unique_lock<std::shared_mutex> lock(indexMutex);
+        indexRecord(record);
+    }
+    version = ++versionCounter;
+
+    if (listener) {
+        listener(record);
+    }
+}
+
+// Add a batch under one exclusive lock
+void ElectionData::addRecords(const std::vector<ElectionRecord>& batch) {
+    TRACE_SPAN("ElectionData::addRecords");
+    std::lock_guard<std::mutex> writer(writeMutex);
+    {
+        std::unique_lock<std::shared_mutex> lock(indexMutex);
+        for (size_t i = 0; i < batch.size(); i++) {
+            indexRecord(batch[i]);
+        }
+    }
+    version = ++versionCounter;
+
+    if (listener) {
+        for (size_t i = 0; i < batch.size(); i++) {
+            listener(batch[i]);
+        }
+    }
 }
 
 // Get all records for a specific election (country + year)
 std::vector<ElectionRecord> ElectionData::getElectionRecords(const std::string& country, int year) {
+    TRACE_SPAN("ElectionData::getElectionRecords");
     std::vector<ElectionRecord> result;
     
-    // Simple loop through all records
-    for (int i = 0; i < records.size(); i++) {
+    // Simple loop through the records published so far
+    size_t count = records.size();
+    for (size_t i = 0; i < count; i++) {
         if (records[i].country == country && records[i].year == year) {
             result.push_back(records[i]);
         }
@@ -21,10 +78,12 @@ std::vector<ElectionRecord> ElectionData::getElectionRecords(const std::string&
 
 // Get all records for a specific party in an election
 std::vector<ElectionRecord> ElectionData::getPartyRecords(const std::string& country, int year, const std::string& party) {
+    TRACE_SPAN("ElectionData::getPartyRecords");
     std::vector<ElectionRecord> result;
     
-    // Simple loop through all records
-    for (int i = 0; i < records.size(); i++) {
+    // Simple loop through the records published so far
+    size_t count = records.size();
+    for (size_t i = 0; i < count; i++) {
         if (records[i].country == country && records[i].year == year && records[i].party == party) {
             result.push_back(records[i]);
         }
@@ -40,11 +99,138 @@ int ElectionData::getTotalRecords() {
 
 // Get all records
 std::vector<ElectionRecord> ElectionData::getAllRecords() {
-    return records;
+    TRACE_SPAN("ElectionData::getAllRecords");
+    size_t count = records.size();
+    std::vector<ElectionRecord> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        result.push_back(records[i]);
+    }
+    return result;
+}
+
+// Get the years with elections for a country (map keys are sorted)
+std::vector<int> ElectionData::getElectionYears(const std::string& country) {
+    TRACE_SPAN("ElectionData::getElectionYears");
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    std::vector<int> years;
+    for (auto it = distributions.lower_bound(std::make_pair(country, 0));
+         it != distributions.end() && it->first.first == country; ++it) {
+        years.push_back(it->first.second);
+    }
+    return years;
+}
+
+// Get one record by its position
+ElectionRecord ElectionData::getRecord(int index) {
+    return records[index];
+}
+
+// Visit matching records without copying them
+int ElectionData::scanRecords(const std::string& country, int year, int start, int maxScanned,
+                              const std::function<bool(const ElectionRecord&)>& visit) {
+    TRACE_SPAN("ElectionData::scanRecords");
+    int count = records.size();
+    int end = std::min(count, start + maxScanned);
+    int i = start;
+    while (i < end) {
+        const ElectionRecord& record = records[i];
+        i++;
+        if ((country.empty() || record.country == country) && (year == 0 || record.year == year)) {
+            if (!visit(record)) {
+                break;
+            }
+        }
+    }
+    return i < count ? i : -1;
+}
+
+// Fuzzy search of names using the trigram index
+std::vector<SearchMatch> ElectionData::searchNames(const std::string& query, int limit) {
+    TRACE_SPAN("ElectionData::searchNames");
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    return searchIndex.search(query, limit);
+}
+
+// Get all records of a candidate with one hash lookup
+std::vector<ElectionRecord> ElectionData::getCandidateRecords(const std::string& name, const std::string& party) {
+    TRACE_SPAN("ElectionData::getCandidateRecords");
+    std::vector<ElectionRecord> result;
+
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    auto it = candidatePostings.find(SearchIndex::normalize(name));
+    if (it == candidatePostings.end()) {
+        return result;
+    }
+
+    std::string normalizedParty = SearchIndex::normalize(party);
+    for (int i = 0; i < it->second.size(); i++) {
+        const ElectionRecord& record = records[it->second[i]];
+        if (normalizedParty.empty() || SearchIndex::normalize(record.party) == normalizedParty) {
+            result.push_back(record);
+        }
+    }
+
+    return result;
+}
+
+// Get aggregated cells from the cube
+std::vector<CubeCell> ElectionData::queryCube(int groupBy, const CubeSlice& slice) {
+    TRACE_SPAN("ElectionData::queryCube");
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    return cube.query(groupBy, slice);
+}
+
+// Get the fully rolled-up cell of a slice
+CubeCell ElectionData::getCubeTotal(const CubeSlice& slice) {
+    TRACE_SPAN("ElectionData::getCubeTotal");
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    return cube.total(slice);
+}
+
+// Get the sketch of per-candidate votes for an election
+QuantileSketch ElectionData::getCandidateVoteSketch(const std::string& country, int year) {
+    TRACE_SPAN("ElectionData::getCandidateVoteSketch");
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    auto it = distributions.find(std::make_pair(country, year));
+    if (it == distributions.end()) {
+        return QuantileSketch();
+    }
+    return it->second.candidateVotes;
+}
+
+// Get total votes of each constituency in an election
+std::map<std::string, long long> ElectionData::getConstituencyVotes(const std::string& country, int year) {
+    TRACE_SPAN("ElectionData::getConstituencyVotes");
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    auto it = distributions.find(std::make_pair(country, year));
+    if (it == distributions.end()) {
+        return std::map<std::string, long long>();
+    }
+    return it->second.constituencyVotes;
 }
 
 // Clear all data
 void ElectionData::clear() {
+    TRACE_SPAN("ElectionData::clear");
+    std::lock_guard<std::mutex> writer(writeMutex);
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
     records.clear();
+    distributions.clear();
+    searchIndex.clear();
+    candidatePostings.clear();
+    cube.clear();
+    version = ++versionCounter;
+}
+
+// Get a counter that changes whenever the data changes
+unsigned long long ElectionData::getVersion() const {
+    return version;
 }
 
+
+// Set the function told about every added record
+void ElectionData::setChangeListener(std::function<void(const ElectionRecord&)> callback) {
+    std::lock_guard<std::mutex> writer(writeMutex);
+    listener = std::move(callback);
+}
@@ -1,10 +1,22 @@
 #include "../include/HTTPServer.h"
 #include "../include/ElectionAnalyzer.h"
+#include "../include/JSONWriter.h"
+#include "../include/BinaryWriter.h"
+#include "../include/Compressor.h"
+#include "../include/CSVReader.h"
+#include "../include/Trace.h"
 #include <iostream>
 #include <sstream>
-#include <fstream>
 #include <algorithm>
 #include <set>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
 
 #ifdef _WIN32
     #include <winsock2.h>
@@ -14,6 +26,9 @@
 #else
     #include <sys/socket.h>
     #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/time.h>
+    #include <signal.h>
     #include <unistd.h>
     #define SOCKET int
     #define INVALID_SOCKET -1
@@ -21,8 +36,374 @@
     #define closesocket close
 #endif
 
-HTTPServer::HTTPServer(int port, ElectionData* data) 
-    : port(port), electionData(data), running(false) {
+namespace {
+
+// Status code of the response last queued on this thread, for metrics
+thread_local int responseStatus = 0;
+
+uint64_t elapsedNanos(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+}
+
+// Set by the SIGHUP handler, picked up by the reload thread
+volatile std::sig_atomic_t hangupReceived = 0;
+
+#ifndef _WIN32
+void onHangup(int) {
+    hangupReceived = 1;
+}
+#endif
+
+// How often the reload thread looks for SIGHUP
+const int RELOAD_POLL_MS = 250;
+
+const std::string KEEP_ALIVE_HEADER = "Connection: keep-alive\r\n\r\n";
+const std::string CLOSE_HEADER = "Connection: close\r\n\r\n";
+const std::string API_HEADERS = "Access-Control-Allow-Origin: *\r\n";
+// API bodies depend on Accept, and on Accept-Encoding once big enough to gzip
+const std::string VARY_HEADER = "Vary: Accept\r\n";
+const std::string VARY_ENCODING_HEADER = "Vary: Accept, Accept-Encoding\r\n";
+const std::string RETRY_HEADER = "Retry-After: 1\r\n";
+
+// Sent as-is to connections turned away before their request was read
+const std::string SHED_RESPONSE =
+    "HTTP/1.1 503 Service Unavailable\r\nContent-Type: application/json\r\n"
+    "Retry-After: 1\r\nContent-Length: 23\r\nConnection: close\r\n\r\n"
+    "{\"error\":\"server busy\"}";
+
+// /api/records page size when no limit is given, and the largest allowed
+const int DEFAULT_RECORD_LIMIT = 1000;
+const int MAX_RECORD_LIMIT = 1000000;
+
+// /api/distribution histogram bins when none are asked for, and the most allowed
+const int DEFAULT_HISTOGRAM_BINS = 10;
+const int MAX_HISTOGRAM_BINS = 100;
+
+// /api/search results when no limit is given, and the most allowed
+const int DEFAULT_SEARCH_LIMIT = 20;
+const int MAX_SEARCH_LIMIT = 100;
+
+// Streamed body pieces: records looked at per piece, and bytes per chunk
+const int RECORDS_PER_SCAN = 4096;
+const size_t STREAM_CHUNK_SIZE = 16 * 1024;
+const int SCANS_PER_CHUNK = 16;
+
+// Cursors are record positions in hex; clients should treat them as opaque
+std::string formatCursor(int position) {
+    char text[16];
+    std::snprintf(text, sizeof(text), "%x", static_cast<unsigned>(position));
+    return text;
+}
+
+// Integer query parameter within [low, high]; throws (answered with 400) otherwise
+int boundedParam(std::map<std::string, std::string>& params, const std::string& name,
+                 int fallback, int low, int high) {
+    if (!params.count(name)) {
+        return fallback;
+    }
+    int value = std::stoi(params[name]);
+    if (value < low || value > high) {
+        throw std::out_of_range(name);
+    }
+    return value;
+}
+
+const char* contentTypeOf(ResponseFormat format) {
+    switch (format) {
+        case ResponseFormat::MessagePack: return "application/msgpack";
+        case ResponseFormat::CBOR: return "application/cbor";
+        default: return "application/json";
+    }
+}
+
+BinaryFormat binaryFormatOf(ResponseFormat format) {
+    return format == ResponseFormat::CBOR ? BinaryFormat::CBOR : BinaryFormat::MessagePack;
+}
+
+std::string apiCacheKey(const std::string& endpoint, const std::map<std::string, std::string>& params,
+                        ResponseFormat format) {
+    std::string key = ResponseCache::makeKey(endpoint, params);
+    if (format != ResponseFormat::JSON) {
+        // Not a valid parameter continuation, so no JSON key collides
+        key += format == ResponseFormat::CBOR ? "\ncbor" : "\nmsgpack";
+    }
+    return key;
+}
+
+// Queries one POST /api/batch may hold, and threads computing them
+const size_t MAX_BATCH_QUERIES = 64;
+const size_t MAX_BATCH_THREADS = 4;
+
+/**
+ * @brief One query of a batch and, once run, its result
+ */
+struct BatchQuery {
+    std::string endpoint;
+    std::map<std::string, std::string> params;
+    bool cacheable;
+    std::string cacheKey;
+    int status;
+    std::string body;                                   // Set unless taken from or moved into the cache
+    std::shared_ptr<const CachedResponse> response;     // Cached copy of the body
+    std::string error;
+
+    BatchQuery() : cacheable(false), status(0) {}
+};
+
+// GET endpoints whose whole answer comes from handleAPIRequest
+bool isBatchable(const std::string& endpoint) {
+    static const char* const ENDPOINTS[] = {
+        "/api/countries", "/api/stats", "/api/compare", "/api/top-candidates", "/api/dashboard",
+        "/api/distribution", "/api/search", "/api/candidate-history", "/api/incumbency", "/api/cube",
+        "/api/server-stats"
+    };
+    for (const char* name : ENDPOINTS) {
+        if (endpoint == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// {"version":V,"results":[{"status":200,"body":...},{"status":400,"error":"..."}]}
+template <typename Writer>
+void writeBatchResults(Writer& writer, unsigned long long version, const std::vector<BatchQuery>& queries) {
+    writer.beginObject();
+    writer.field("version", version);
+    writer.key("results").beginArray();
+    for (const BatchQuery& query : queries) {
+        writer.beginObject();
+        writer.field("status", query.status);
+        if (query.status == 200) {
+            writer.key("body").raw(query.response ? query.response->body : query.body);
+        } else {
+            writer.field("error", query.error);
+        }
+        writer.endObject();
+    }
+    writer.endArray().endObject();
+}
+
+void appendUTF8(std::string& out, unsigned code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// Decode a JSON array of strings, the body of POST /api/batch. Escaped
+// surrogates are refused; paths needing them should be percent-encoded.
+bool parseStringArray(const std::string& text, std::vector<std::string>& items) {
+    size_t pos = 0;
+    auto skipSpace = [&]() {
+        while (pos < text.length() && (text[pos] == ' ' || text[pos] == '\t' ||
+                                       text[pos] == '\r' || text[pos] == '\n')) {
+            pos++;
+        }
+    };
+    
+    skipSpace();
+    if (pos == text.length() || text[pos] != '[') {
+        return false;
+    }
+    pos++;
+    skipSpace();
+    bool more = pos < text.length() && text[pos] != ']';
+    while (more) {
+        if (pos == text.length() || text[pos] != '"') {
+            return false;
+        }
+        pos++;
+        std::string item;
+        while (true) {
+            if (pos == text.length() || static_cast<unsigned char>(text[pos]) < 0x20) {
+                return false;
+            }
+            char c = text[pos++];
+            if (c == '"') {
+                break;
+            }
+            if (c != '\\') {
+                item += c;
+                continue;
+            }
+            if (pos == text.length()) {
+                return false;
+            }
+            char escaped = text[pos++];
+            switch (escaped) {
+                case '"': case '\\': case '/': item += escaped; break;
+                case 'b': item += '\b'; break;
+                case 'f': item += '\f'; break;
+                case 'n': item += '\n'; break;
+                case 'r': item += '\r'; break;
+                case 't': item += '\t'; break;
+                case 'u': {
+                    if (text.length() - pos < 4 ||
+                        text.find_first_not_of("0123456789abcdefABCDEF", pos) < pos + 4) {
+                        return false;
+                    }
+                    unsigned code = std::stoul(text.substr(pos, 4), nullptr, 16);
+                    pos += 4;
+                    if (code >= 0xD800 && code <= 0xDFFF) {
+                        return false;
+                    }
+                    appendUTF8(item, code);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        items.push_back(std::move(item));
+        
+        skipSpace();
+        if (pos == text.length()) {
+            return false;
+        }
+        more = text[pos] == ',';
+        if (!more && text[pos] != ']') {
+            return false;
+        }
+        pos++;
+        skipSpace();
+    }
+    if (items.empty()) {
+        // Only "[]" left to consume
+        if (pos == text.length()) {
+            return false;
+        }
+        pos++;
+        skipSpace();
+    }
+    return pos == text.length();
+}
+
+template <typename Writer>
+void writeStreamedRecord(Writer& writer, const ElectionRecord& record) {
+    writer.beginObject();
+    writer.field("country", record.country);
+    writer.field("year", record.year);
+    writer.field("constituency", record.constituency);
+    writer.field("candidate", record.candidate);
+    writer.field("party", record.party);
+    writer.field("votes", record.votes);
+    writer.field("elected", record.elected);
+    writer.endObject();
+}
+
+bool parseCursor(const std::string& text, int& position) {
+    if (text.empty() || text.length() > 8 ||
+        text.find_first_not_of("0123456789abcdef") != std::string::npos) {
+        return false;
+    }
+    unsigned long value = std::stoul(text, nullptr, 16);
+    if (value > static_cast<unsigned long>(std::numeric_limits<int>::max())) {
+        return false;
+    }
+    position = static_cast<int>(value);
+    return true;
+}
+
+/**
+ * @brief Produces one /api/records page as NDJSON, a chunk at a time
+ *
+ * Each line is one record; the last line is {"next":cursor}, with a
+ * null cursor once every record has been returned. In MessagePack or
+ * CBOR the same items follow each other as a sequence of maps, with no
+ * separator.
+ */
+struct RecordStream {
+    std::shared_ptr<ElectionData> data;     // Snapshot the page is read from
+    std::string country;
+    int year;
+    int position;       // Next record to look at, or -1 at the end
+    int remaining;      // Records still allowed on this page
+    bool chunked;       // HTTP/1.1 chunked framing; HTTP/1.0 ends by closing
+    ResponseFormat format;
+    
+    bool operator()(std::string& out) {
+        std::string body;
+        body.reserve(STREAM_CHUNK_SIZE + 512);
+        
+        // Sparse matches may take several scans; give up after a few so one
+        // call stays short and an empty piece just means "call again"
+        for (int scans = 0; scans < SCANS_PER_CHUNK && position >= 0 && remaining > 0 &&
+                            body.length() < STREAM_CHUNK_SIZE; scans++) {
+            position = data->scanRecords(country, year, position, RECORDS_PER_SCAN,
+                                         [this, &body](const ElectionRecord& record) {
+                if (format == ResponseFormat::JSON) {
+                    JSONWriter json(body);
+                    writeStreamedRecord(json, record);
+                    body += '\n';
+                } else {
+                    BinaryWriter writer(body, binaryFormatOf(format));
+                    writeStreamedRecord(writer, record);
+                }
+                return --remaining > 0 && body.length() < STREAM_CHUNK_SIZE;
+            });
+        }
+        
+        bool last = position < 0 || remaining == 0;
+        if (last && format == ResponseFormat::JSON) {
+            body += "{\"next\":";
+            body += position < 0 ? "null" : "\"" + formatCursor(position) + "\"";
+            body += "}\n";
+        } else if (last) {
+            BinaryWriter writer(body, binaryFormatOf(format));
+            writer.beginObject().key("next");
+            if (position < 0) {
+                writer.null();
+            } else {
+                writer.value(formatCursor(position));
+            }
+            writer.endObject();
+        }
+        
+        if (body.empty()) {
+            return true;
+        }
+        if (chunked) {
+            char size[20];
+            std::snprintf(size, sizeof(size), "%zx\r\n", body.length());
+            out = size;
+            out += body;
+            out += last ? "\r\n0\r\n\r\n" : "\r\n";
+        } else {
+            out = std::move(body);
+        }
+        return !last;
+    }
+};
+
+} // namespace
+
+HTTPServer::HTTPServer(int port, std::shared_ptr<ElectionData> data, const ServerOptions& options) 
+    : port(port), dataset(data), options(options), running(false),
+      assets("web", options.compressMinBytes > 0 && Compressor::available()), live(data),
+      reloadRequested(false), reloadCount(0) {
+    if (options.responseCacheBytes > 0) {
+        responseCache.reset(new ResponseCache(options.responseCacheBytes));
+    }
+    dataset->setChangeListener([this](const ElectionRecord& record) { live.publish(record); });
+    
+    // Leave room for cheap requests: one worker beyond standard work,
+    // half of them beyond heavy work
+    int computeThreads = options.threads;
+#ifdef __linux__
+    if (options.mode == ServerMode::EventLoop || options.mode == ServerMode::IoUring) {
+        computeThreads = options.eventThreads;
+    }
+#endif
+    int standardLimit = options.standardLimit > 0 ? options.standardLimit : std::max(1, computeThreads - 1);
+    int heavyLimit = options.heavyLimit > 0 ? options.heavyLimit : std::max(1, computeThreads / 2);
+    admission.reset(new AdmissionControl(standardLimit, heavyLimit));
 #ifdef _WIN32
     WSADATA wsaData;
     WSAStartup(MAKEWORD(2, 2), &wsaData);
@@ -31,6 +412,7 @@ HTTPServer::HTTPServer(int port, ElectionData* data)
 
 HTTPServer::~HTTPServer() {
     stop();
+    currentData()->setChangeListener(nullptr);
 #ifdef _WIN32
     WSACleanup();
 #endif
@@ -74,145 +456,943 @@ std::map<std::string, std::string> HTTPServer::parseQuery(const std::string& que
     return params;
 }
 
-std::string HTTPServer::getContentType(const std::string& path) {
-    // Helper function to check if string ends with suffix
-    auto endsWith = [](const std::string& str, const std::string& suffix) {
-        if (suffix.length() > str.length()) return false;
-        return str.compare(str.length() - suffix.length(), suffix.length(), suffix) == 0;
+template <typename Writer>
+void HTTPServer::writeAPIResponse(Writer& writer, ElectionData* electionData, const std::string& endpoint,
+                                  std::map<std::string, std::string>& params, AnalysisMemo* memo,
+                                  std::chrono::steady_clock::time_point& computedAt) {
+    auto writeRecord = [&writer](const ElectionRecord& c) {
+        writer.beginObject();
+        writer.field("country", c.country);
+        writer.field("year", c.year);
+        writer.field("constituency", c.constituency);
+        writer.field("party", c.party);
+        writer.field("votes", c.votes);
+        writer.field("elected", c.elected);
+        writer.endObject();
+    };
+    auto writeCandidates = [&writer](const char* name, const std::vector<ElectionRecord>& candidates) {
+        writer.key(name).beginArray();
+        for (const auto& c : candidates) {
+            writer.beginObject();
+            writer.field("candidate", c.candidate);
+            writer.field("party", c.party);
+            writer.field("constituency", c.constituency);
+            writer.field("votes", c.votes);
+            writer.field("elected", c.elected);
+            writer.endObject();
+        }
+        writer.endArray();
+    };
+    // Fields of an ElectionStats, inside an object left open for more
+    auto writeStats = [&writer](const ElectionStats& stats) {
+        writer.field("country", stats.country);
+        writer.field("year", stats.year);
+        writer.field("totalVotes", stats.totalVotes);
+        writer.field("totalSeats", stats.totalSeats);
+        writer.field("totalCandidates", stats.totalCandidates);
+        writer.field("constituencies", stats.constituencies);
+        writer.key("parties").beginArray();
+        for (const auto& ps : stats.partyStats) {
+            writer.beginObject();
+            writer.field("party", ps.party);
+            writer.field("totalVotes", ps.totalVotes);
+            writer.field("voteShare", ps.voteShare);
+            writer.field("seatsWon", ps.seatsWon);
+            writer.field("candidatesCount", ps.candidatesCount);
+            writer.endObject();
+        }
+        writer.endArray();
     };
-    
-    if (endsWith(path, ".html")) return "text/html";
-    if (endsWith(path, ".css")) return "text/css";
-    if (endsWith(path, ".js")) return "application/javascript";
-    if (endsWith(path, ".json")) return "application/json";
-    if (endsWith(path, ".png")) return "image/png";
-    if (endsWith(path, ".jpg") || endsWith(path, ".jpeg")) return "image/jpeg";
-    return "text/plain";
-}
-
-std::string HTTPServer::readFile(const std::string& path) {
-    std::ifstream file(path, std::ios::binary);
-    if (!file.is_open()) return "";
-    
-    std::ostringstream ss;
-    ss << file.rdbuf();
-    return ss.str();
-}
-
-std::string HTTPServer::handleAPIRequest(const std::string& endpoint, const std::string& query) {
-    auto params = parseQuery(query);
-    std::ostringstream json;
     
     if (endpoint == "/api/countries") {
         // Get available countries and years
         std::map<std::string, std::set<int>> countryYears;
-        for (const auto& record : electionData->getAllRecords()) {
-            countryYears[record.country].insert(record.year);
+        for (const auto& cell : electionData->queryCube(ElectionCube::Country | ElectionCube::Year, CubeSlice())) {
+            countryYears[cell.country].insert(cell.year);
         }
+        computedAt = std::chrono::steady_clock::now();
         
-        json << "{\"countries\":[";
-        bool first = true;
+        writer.beginObject().key("countries").beginArray();
         for (const auto& pair : countryYears) {
-            if (!first) json << ",";
-            json << "{\"name\":\"" << pair.first << "\",\"years\":[";
-            bool firstYear = true;
+            writer.beginObject().field("name", pair.first).key("years").beginArray();
             for (int year : pair.second) {
-                if (!firstYear) json << ",";
-                json << year;
-                firstYear = false;
+                writer.value(year);
             }
-            json << "]}";
-            first = false;
+            writer.endArray().endObject();
         }
-        json << "]}";
+        writer.endArray().endObject();
         
     } else if (endpoint == "/api/stats") {
         std::string country = params["country"];
         int year = std::stoi(params["year"]);
         
-        ElectionStats stats = ElectionAnalyzer::calculateElectionStats(*electionData, country, year);
+        ElectionStats stats = memo ? memo->electionStats(country, year)
+                                   : ElectionAnalyzer::calculateElectionStats(*electionData, country, year);
+        computedAt = std::chrono::steady_clock::now();
         
-        json << "{";
-        json << "\"country\":\"" << stats.country << "\",";
-        json << "\"year\":" << stats.year << ",";
-        json << "\"totalVotes\":" << stats.totalVotes << ",";
-        json << "\"totalSeats\":" << stats.totalSeats << ",";
-        json << "\"totalCandidates\":" << stats.totalCandidates << ",";
-        json << "\"constituencies\":" << stats.constituencies << ",";
-        json << "\"parties\":[";
-        
-        bool first = true;
-        for (const auto& ps : stats.partyStats) {
-            if (!first) json << ",";
-            json << "{";
-            json << "\"party\":\"" << ps.party << "\",";
-            json << "\"totalVotes\":" << ps.totalVotes << ",";
-            json << "\"voteShare\":" << ps.voteShare << ",";
-            json << "\"seatsWon\":" << ps.seatsWon << ",";
-            json << "\"candidatesCount\":" << ps.candidatesCount;
-            json << "}";
-            first = false;
-        }
-        json << "]}";
+        writer.beginObject();
+        writeStats(stats);
+        writer.endObject();
         
     } else if (endpoint == "/api/compare") {
         std::string country = params["country"];
         int year1 = std::stoi(params["year1"]);
         int year2 = std::stoi(params["year2"]);
         
-        ComparativeAnalysis analysis = ElectionAnalyzer::compareElections(*electionData, country, year1, year2);
+        ComparativeAnalysis analysis = memo ? memo->compareElections(country, year1, year2)
+                                            : ElectionAnalyzer::compareElections(*electionData, country, year1, year2);
+        computedAt = std::chrono::steady_clock::now();
         
-        json << "{";
-        json << "\"country\":\"" << analysis.country << "\",";
-        json << "\"year1\":" << analysis.year1 << ",";
-        json << "\"year2\":" << analysis.year2 << ",";
-        json << "\"voteChange\":" << analysis.voteChange << ",";
-        json << "\"voteChangePercent\":" << analysis.voteChangePercent << ",";
-        json << "\"partyChanges\":[";
-        
-        bool first = true;
+        writer.beginObject();
+        writer.field("country", analysis.country);
+        writer.field("year1", analysis.year1);
+        writer.field("year2", analysis.year2);
+        writer.field("voteChange", analysis.voteChange);
+        writer.field("voteChangePercent", analysis.voteChangePercent);
+        writer.key("partyChanges").beginArray();
         for (const auto& change : analysis.partyChanges) {
-            if (!first) json << ",";
-            
-            json << "{";
-            json << "\"party\":\"" << change.party << "\",";
-            json << "\"voteChange\":" << change.voteChange << ",";
-            json << "\"seatChange\":" << change.seatChange;
-            json << "}";
-            first = false;
+            writer.beginObject();
+            writer.field("party", change.party);
+            writer.field("voteChange", change.voteChange);
+            writer.field("seatChange", change.seatChange);
+            writer.endObject();
         }
-        json << "]}";
+        writer.endArray().endObject();
         
     } else if (endpoint == "/api/top-candidates") {
         std::string country = params["country"];
         int year = std::stoi(params["year"]);
         int n = params.count("n") ? std::stoi(params["n"]) : 10;
         
-        auto candidates = ElectionAnalyzer::getTopCandidates(*electionData, country, year, n);
+        auto candidates = memo ? memo->topCandidates(country, year, n)
+                               : ElectionAnalyzer::getTopCandidates(*electionData, country, year, n);
+        computedAt = std::chrono::steady_clock::now();
         
-        json << "{\"candidates\":[";
-        bool first = true;
-        for (const auto& c : candidates) {
-            if (!first) json << ",";
-            json << "{";
-            json << "\"candidate\":\"" << c.candidate << "\",";
-            json << "\"party\":\"" << c.party << "\",";
-            json << "\"constituency\":\"" << c.constituency << "\",";
-            json << "\"votes\":" << c.votes << ",";
-            json << "\"elected\":" << (c.elected ? "true" : "false");
-            json << "}";
-            first = false;
+        writer.beginObject();
+        writeCandidates("candidates", candidates);
+        writer.endObject();
+        
+    } else if (endpoint == "/api/dashboard") {
+        std::string country = params["country"];
+        int year = std::stoi(params["year"]);
+        int n = params.count("n") ? std::stoi(params["n"]) : 10;
+        
+        ElectionDashboard dashboard = ElectionAnalyzer::buildDashboard(*electionData, country, year, n);
+        computedAt = std::chrono::steady_clock::now();
+        
+        writer.beginObject();
+        writeStats(dashboard.stats);
+        writer.key("seats").beginArray();
+        for (const auto& seat : dashboard.seats) {
+            writer.beginObject().field("party", seat.party).field("seats", seat.seats).endObject();
+        }
+        writer.endArray();
+        writeCandidates("topCandidates", dashboard.topCandidates);
+        writeCandidates("winners", dashboard.winners);
+        writer.endObject();
+        
+    } else if (endpoint == "/api/distribution") {
+        std::string country = params["country"];
+        int year = std::stoi(params["year"]);
+        int bins = boundedParam(params, "bins", DEFAULT_HISTOGRAM_BINS, 1, MAX_HISTOGRAM_BINS);
+        
+        ElectionDistribution dist = ElectionAnalyzer::getVoteDistribution(*electionData, country, year, bins);
+        computedAt = std::chrono::steady_clock::now();
+        
+        auto writeDistribution = [&writer](const VoteDistribution& d) {
+            writer.beginObject();
+            writer.field("count", d.count);
+            writer.field("min", d.min);
+            writer.field("max", d.max);
+            writer.field("p50", d.p50);
+            writer.field("p90", d.p90);
+            writer.field("p99", d.p99);
+            writer.key("histogram").beginArray();
+            for (const auto& bin : d.histogram) {
+                writer.beginObject();
+                writer.field("lower", bin.lower);
+                writer.field("upper", bin.upper);
+                writer.field("count", bin.count);
+                writer.endObject();
+            }
+            writer.endArray().endObject();
+        };
+        
+        writer.beginObject();
+        writer.field("country", dist.country);
+        writer.field("year", dist.year);
+        writer.key("candidates");
+        writeDistribution(dist.candidates);
+        writer.key("constituencies");
+        writeDistribution(dist.constituencies);
+        writer.endObject();
+        
+    } else if (endpoint == "/api/search") {
+        std::string q = params["q"];
+        int limit = boundedParam(params, "limit", DEFAULT_SEARCH_LIMIT, 1, MAX_SEARCH_LIMIT);
+        
+        auto results = ElectionAnalyzer::searchNames(*electionData, q, limit);
+        computedAt = std::chrono::steady_clock::now();
+        
+        writer.beginObject().field("query", q).key("results").beginArray();
+        for (const auto& r : results) {
+            writer.beginObject();
+            writer.field("type", r.field);
+            writer.field("name", r.name);
+            writer.field("score", r.score);
+            writer.key("elections").beginArray();
+            for (const auto& e : r.elections) {
+                writer.beginObject();
+                writer.field("country", e.country);
+                writer.field("year", e.year);
+                writer.field("records", e.records);
+                writer.endObject();
+            }
+            writer.endArray();
+            if (!r.records.empty()) {
+                writer.key("records").beginArray();
+                for (const auto& c : r.records) {
+                    writeRecord(c);
+                }
+                writer.endArray();
+            }
+            writer.endObject();
+        }
+        writer.endArray().endObject();
+        
+    } else if (endpoint == "/api/candidate-history") {
+        std::string name = params["name"];
+        std::string party = params.count("party") ? params["party"] : "";
+        
+        CandidateHistory history = ElectionAnalyzer::getCandidateHistory(*electionData, name, party);
+        computedAt = std::chrono::steady_clock::now();
+        
+        writer.beginObject();
+        writer.field("name", history.name);
+        writer.field("electionsContested", history.electionsContested);
+        writer.field("seatsWon", history.seatsWon);
+        writer.key("records").beginArray();
+        for (const auto& c : history.records) {
+            writeRecord(c);
+        }
+        writer.endArray().endObject();
+        
+    } else if (endpoint == "/api/incumbency") {
+        std::string country = params["country"];
+        
+        auto trend = ElectionAnalyzer::calculateIncumbencyTrend(*electionData, country);
+        computedAt = std::chrono::steady_clock::now();
+        
+        writer.beginObject().field("country", country).key("elections").beginArray();
+        for (const auto& inc : trend) {
+            writer.beginObject();
+            writer.field("year", inc.year);
+            writer.field("previousYear", inc.previousYear);
+            writer.field("incumbents", inc.incumbents);
+            writer.field("incumbentsStanding", inc.incumbentsStanding);
+            writer.field("reelected", inc.reelected);
+            writer.field("reelectionRate", inc.reelectionRate);
+            writer.endObject();
+        }
+        writer.endArray().endObject();
+        
+    } else if (endpoint == "/api/cube") {
+        int groupBy = ElectionCube::parseDimensions(params["groupBy"]);
+        CubeSlice slice;
+        slice.country = params["country"];
+        slice.year = params.count("year") ? std::stoi(params["year"]) : 0;
+        slice.party = params["party"];
+        slice.constituency = params["constituency"];
+        
+        auto cells = electionData->queryCube(groupBy, slice);
+        computedAt = std::chrono::steady_clock::now();
+        
+        writer.beginObject().field("groupBy", params["groupBy"]).key("cells").beginArray();
+        for (const auto& cell : cells) {
+            writer.beginObject();
+            if (!cell.country.empty()) writer.field("country", cell.country);
+            if (cell.year != 0) writer.field("year", cell.year);
+            if (!cell.party.empty()) writer.field("party", cell.party);
+            if (!cell.constituency.empty()) writer.field("constituency", cell.constituency);
+            writer.field("votes", cell.votes);
+            writer.field("seats", cell.seats);
+            writer.field("candidates", cell.candidates);
+            writer.field("constituencies", cell.constituencies);
+            writer.endObject();
+        }
+        writer.endArray().endObject();
+        
+    } else if (endpoint == "/api/server-stats") {
+        // Never cached itself
+        writer.beginObject().key("responseCache").beginObject();
+        if (responseCache) {
+            ResponseCacheStats stats = responseCache->getStats();
+            writer.field("enabled", true);
+            writer.field("entries", stats.entries);
+            writer.field("bytes", stats.bytes);
+            writer.field("capacityBytes", stats.capacityBytes);
+            writer.field("hits", stats.hits);
+            writer.field("misses", stats.misses);
+            writer.field("evictions", stats.evictions);
+            writer.field("hitRatio", stats.hitRatio);
+        } else {
+            writer.field("enabled", false);
+        }
+        writer.endObject();
+        writer.key("dataset").beginObject();
+        writer.field("records", electionData->getTotalRecords());
+        writer.field("version", electionData->getVersion());
+        writer.field("reloads", reloadCount.load());
+        writer.endObject();
+        writer.key("wal").beginObject();
+        if (appendLog) {
+            WriteAheadLogStats walStats = appendLog->getStats();
+            writer.field("enabled", true);
+            writer.field("records", walStats.records);
+            writer.field("batches", walStats.batches);
+            writer.field("syncs", walStats.syncs);
+            writer.field("compactions", walStats.compactions);
+            writer.field("replayed", walStats.replayed);
+            writer.field("logBytes", walStats.logBytes);
+        } else {
+            writer.field("enabled", false);
+        }
+        writer.endObject();
+        writer.key("live").beginObject();
+        writer.field("subscribers", live.subscriberCount());
+        writer.field("eventsPublished", live.eventsPublished());
+        writer.endObject();
+        writer.key("admission").beginObject();
+        writer.field("queueDepth", workers ? workers->queueDepth() : 0);
+        writer.field("queueCapacity", options.queueSize);
+        writer.field("shedConnections", admission->shedConnections());
+        const CostClass classes[] = {CostClass::Cheap, CostClass::Standard, CostClass::Heavy};
+        for (CostClass cost : classes) {
+            CostClassStats stats = admission->getStats(cost);
+            writer.key(AdmissionControl::className(cost)).beginObject();
+            writer.field("inFlight", stats.inFlight);
+            writer.field("limit", stats.limit);
+            writer.field("admitted", stats.admitted);
+            writer.field("shed", stats.shed);
+            writer.endObject();
+        }
+        writer.endObject().endObject();
+    }
+}
+
+std::string HTTPServer::handleAPIRequest(ElectionData* electionData, const std::string& endpoint,
+                                         std::map<std::string, std::string> params, ResponseFormat format,
+                                         AnalysisMemo* memo) {
+    // Everything before computedAt is computing, everything after serializing
+    auto startedAt = std::chrono::steady_clock::now();
+    auto computedAt = startedAt;
+    
+    // Start at the size of the last response on this thread to avoid regrowing
+    static thread_local size_t sizeHint = 256;
+    std::string body;
+    body.reserve(sizeHint);
+    if (format == ResponseFormat::JSON) {
+        JSONWriter json(body);
+        writeAPIResponse(json, electionData, endpoint, params, memo, computedAt);
+    } else {
+        BinaryWriter writer(body, binaryFormatOf(format));
+        writeAPIResponse(writer, electionData, endpoint, params, memo, computedAt);
+    }
+    
+    sizeHint = std::max<size_t>(256, body.length());
+    auto finishedAt = std::chrono::steady_clock::now();
+    metrics.recordAPI(ServerMetrics::endpointIndex(endpoint), elapsedNanos(startedAt, computedAt),
+                      elapsedNanos(computedAt, finishedAt));
+    return body;
+}
+
+// HTTP/1.1 keeps the connection open unless told otherwise; HTTP/1.0 the opposite
+bool HTTPServer::wantsKeepAlive(const HTTPRequest& request) {
+    std::string connection;
+    auto it = request.headers.find("connection");
+    if (it != request.headers.end()) {
+        connection = it->second;
+        std::transform(connection.begin(), connection.end(), connection.begin(), ::tolower);
+    }
+    
+    if (request.version == "HTTP/1.0") {
+        return connection == "keep-alive";
+    }
+    return connection != "close";
+}
+
+// Status line and headers, up to but not including Connection
+std::string HTTPServer::buildHeaders(const std::string& status, const std::string& contentType,
+                                     const std::string& extraHeaders, size_t contentLength) {
+    responseStatus = std::atoi(status.c_str());
+    std::string headers;
+    headers.reserve(128 + extraHeaders.length());
+    headers += "HTTP/1.1 ";
+    headers += status;
+    headers += "\r\nContent-Type: ";
+    headers += contentType;
+    headers += "\r\n";
+    headers += extraHeaders;
+    headers += "Content-Length: ";
+    headers += std::to_string(contentLength);
+    headers += "\r\n";
+    return headers;
+}
+
+// Stream one page of raw records; returns false if the connection must close
+bool HTTPServer::queueRecordStream(const HTTPRequest& request, std::map<std::string, std::string> params,
+                                   bool keepAlive, OutputQueue& output) {
+    RecordStream stream;
+    stream.data = currentData();
+    stream.country = params["country"];
+    stream.position = 0;
+    stream.chunked = request.version != "HTTP/1.0";
+    stream.format = acceptedFormat(request);
+    
+    bool valid = true;
+    try {
+        stream.year = params["year"].empty() ? 0 : std::stoi(params["year"]);
+        stream.remaining = params["limit"].empty() ? DEFAULT_RECORD_LIMIT : std::stoi(params["limit"]);
+    } catch (const std::exception&) {
+        valid = false;
+    }
+    valid = valid && stream.remaining > 0 && stream.remaining <= MAX_RECORD_LIMIT;
+    if (valid && !params["cursor"].empty()) {
+        valid = parseCursor(params["cursor"], stream.position) &&
+                stream.position <= stream.data->getTotalRecords();
+    }
+    if (!valid) {
+        queueResponse(output, "400 Bad Request", "application/json",
+                      "{\"error\":\"invalid request parameters\"}", API_HEADERS, keepAlive);
+        return keepAlive;
+    }
+    if (stream.position == stream.data->getTotalRecords()) {
+        stream.position = -1;
+    }
+    
+    // Without chunked framing the end of the body is the end of the connection
+    keepAlive = keepAlive && stream.chunked;
+    std::string headers = "HTTP/1.1 200 OK\r\nContent-Type: ";
+    switch (stream.format) {
+        case ResponseFormat::MessagePack: headers += "application/msgpack\r\n"; break;
+        case ResponseFormat::CBOR: headers += "application/cbor-seq\r\n"; break;    // RFC 8742
+        default: headers += "application/x-ndjson\r\n"; break;
+    }
+    headers += API_HEADERS + VARY_HEADER;
+    if (stream.chunked) {
+        headers += "Transfer-Encoding: chunked\r\n";
+    }
+    headers += keepAlive ? KEEP_ALIVE_HEADER : CLOSE_HEADER;
+    output.append(std::move(headers));
+    output.appendStream(stream);
+    return keepAlive;
+}
+
+std::shared_ptr<ElectionData> HTTPServer::currentData() const {
+    return std::atomic_load(&dataset);
+}
+
+void HTTPServer::setDatasetLoader(std::function<std::shared_ptr<ElectionData>()> loader) {
+    datasetLoader = std::move(loader);
+}
+
+void HTTPServer::setAppendLog(std::shared_ptr<WriteAheadLog> log) {
+    appendLog = std::move(log);
+}
+
+void HTTPServer::requestReload() {
+    {
+        std::lock_guard<std::mutex> lock(reloadMutex);
+        reloadRequested = true;
+    }
+    reloadWake.notify_one();
+}
+
+// Reloads run one at a time here, never on a request thread
+void HTTPServer::reloadLoop() {
+    while (running) {
+        {
+            std::unique_lock<std::mutex> lock(reloadMutex);
+            reloadWake.wait_for(lock, std::chrono::milliseconds(RELOAD_POLL_MS),
+                                [this] { return reloadRequested || !running; });
+            if (!running) {
+                return;
+            }
+            if (hangupReceived) {
+                hangupReceived = 0;
+                reloadRequested = true;
+            }
+            if (!reloadRequested) {
+                continue;
+            }
+            reloadRequested = false;
+        }
+        reloadDataset();
+    }
+}
+
+// Build the new dataset off to the side, then publish it with one atomic store
+void HTTPServer::reloadDataset() {
+    if (!datasetLoader) {
+        return;
+    }
+    
+    TRACE_SPAN("HTTPServer::reloadDataset");
+    auto begin = std::chrono::steady_clock::now();
+    std::shared_ptr<ElectionData> fresh = datasetLoader();
+    if (!fresh) {
+        std::cerr << "Dataset reload failed; keeping the current data" << std::endl;
+        return;
+    }
+    
+    // Ingestion only waits for the log replay and the swap, so rows logged
+    // meanwhile are neither lost nor appended to the dataset being replaced
+    std::unique_lock<std::shared_mutex> ingestLock(ingestMutex);
+    if ((appendLog && !appendLog->load(*fresh)) || fresh->getTotalRecords() == 0) {
+        std::cerr << "Dataset reload failed; keeping the current data" << std::endl;
+        return;
+    }
+    
+    fresh->setChangeListener([this](const ElectionRecord& record) { live.publish(record); });
+    std::shared_ptr<ElectionData> previous = currentData();
+    std::atomic_store(&dataset, fresh);
+    previous->setChangeListener(nullptr);
+    live.setData(fresh);
+    reloadCount++;
+    
+    // Cached responses carry the old version and simply stop matching;
+    // previous is freed once the last request using it finishes
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+    std::cout << "Reloaded dataset: " << fresh->getTotalRecords() << " records in "
+              << elapsed.count() << " ms" << std::endl;
+}
+
+// Whether the request carries "Authorization: Bearer <adminToken>"
+bool HTTPServer::isAdmin(const HTTPRequest& request) const {
+    if (options.adminToken.empty()) {
+        return false;
+    }
+    
+    // Compare every byte so the time taken says nothing about the token
+    auto it = request.headers.find("authorization");
+    std::string expected = "Bearer " + options.adminToken;
+    if (it == request.headers.end() || it->second.length() != expected.length()) {
+        return false;
+    }
+    unsigned char difference = 0;
+    for (size_t i = 0; i < expected.length(); i++) {
+        difference |= static_cast<unsigned char>(it->second[i] ^ expected[i]);
+    }
+    return difference == 0;
+}
+
+// POST /api/admin/reload with "Authorization: Bearer <adminToken>"
+void HTTPServer::handleAdminReload(const HTTPRequest& request, bool keepAlive, OutputQueue& output) {
+    if (options.adminToken.empty()) {
+        queueResponse(output, "404 Not Found", "application/json",
+                      "{\"error\":\"not found\"}", API_HEADERS, keepAlive);
+        return;
+    }
+    if (request.method != "POST") {
+        queueResponse(output, "405 Method Not Allowed", "application/json",
+                      "{\"error\":\"use POST\"}", API_HEADERS + "Allow: POST\r\n", keepAlive);
+        return;
+    }
+    
+    if (!isAdmin(request)) {
+        queueResponse(output, "401 Unauthorized", "application/json",
+                      "{\"error\":\"unauthorized\"}", API_HEADERS + "WWW-Authenticate: Bearer\r\n", keepAlive);
+        return;
+    }
+    if (!datasetLoader) {
+        queueResponse(output, "501 Not Implemented", "application/json",
+                      "{\"error\":\"no dataset loader\"}", API_HEADERS, keepAlive);
+        return;
+    }
+    
+    requestReload();
+    queueResponse(output, "202 Accepted", "application/json",
+                  "{\"status\":\"reload scheduled\"}", API_HEADERS, keepAlive);
+}
+
+// GET /api/admin/trace: buffered spans as Chrome trace-event JSON
+// (?clear=1 empties the buffers afterwards, to trace one request at a time)
+void HTTPServer::handleAdminTrace(const HTTPRequest& request, std::map<std::string, std::string> params,
+                                  bool keepAlive, OutputQueue& output) {
+    if (options.adminToken.empty()) {
+        queueResponse(output, "404 Not Found", "application/json",
+                      "{\"error\":\"not found\"}", API_HEADERS, keepAlive);
+        return;
+    }
+    if (!isAdmin(request)) {
+        queueResponse(output, "401 Unauthorized", "application/json",
+                      "{\"error\":\"unauthorized\"}", API_HEADERS + "WWW-Authenticate: Bearer\r\n", keepAlive);
+        return;
+    }
+    if (!Trace::isEnabled()) {
+        queueResponse(output, "501 Not Implemented", "application/json",
+                      "{\"error\":\"built without ELECTION_TRACING\"}", API_HEADERS, keepAlive);
+        return;
+    }
+    
+    std::string body;
+    Trace::writeChromeJSON(body);
+    if (params["clear"] == "1") {
+        Trace::clear();
+    }
+    queueResponse(output, "200 OK", "application/json", std::move(body), API_HEADERS, keepAlive);
+}
+
+// POST /api/records: CSV rows in the data file format, added all or nothing
+void HTTPServer::handleRecordIngest(const HTTPRequest& request, bool keepAlive, OutputQueue& output) {
+    TRACE_SPAN("HTTPServer::handleRecordIngest");
+    if (options.adminToken.empty()) {
+        queueResponse(output, "403 Forbidden", "application/json",
+                      "{\"error\":\"ingestion disabled\"}", API_HEADERS, keepAlive);
+        return;
+    }
+    if (!isAdmin(request)) {
+        queueResponse(output, "401 Unauthorized", "application/json",
+                      "{\"error\":\"unauthorized\"}", API_HEADERS + "WWW-Authenticate: Bearer\r\n", keepAlive);
+        return;
+    }
+    
+    std::vector<ElectionRecord> batch;
+    size_t start = 0;
+    int lineNumber = 0;
+    while (start < request.body.length()) {
+        size_t end = request.body.find('\n', start);
+        if (end == std::string::npos) end = request.body.length();
+        std::string line = request.body.substr(start, end - start);
+        start = end + 1;
+        lineNumber++;
+        
+        // Blank lines and the header row of a data file are skipped
+        if (line.find_first_not_of(" \t\r") == std::string::npos || line.compare(0, 8, "Country,") == 0) {
+            continue;
+        }
+        ElectionRecord record;
+        if (!CSVReader::tryParseLine(line, record)) {
+            std::string body;
+            JSONWriter writer(body);
+            writer.beginObject();
+            writer.field("error", "malformed record");
+            writer.field("line", lineNumber);
+            writer.endObject();
+            queueResponse(output, "400 Bad Request", "application/json", std::move(body), API_HEADERS, keepAlive);
+            return;
+        }
+        batch.push_back(std::move(record));
+    }
+    
+    // Acknowledged rows are on disk first, so a restart replays them
+    std::shared_lock<std::shared_mutex> ingestLock(ingestMutex);
+    if (appendLog && !appendLog->append(batch)) {
+        queueResponse(output, "500 Internal Server Error", "application/json",
+                      "{\"error\":\"could not log records\"}", API_HEADERS, keepAlive);
+        return;
+    }
+    std::shared_ptr<ElectionData> data = currentData();
+    data->addRecords(batch);
+    
+    std::string body;
+    JSONWriter writer(body);
+    writer.beginObject();
+    writer.field("added", static_cast<int>(batch.size()));
+    writer.field("totalRecords", data->getTotalRecords());
+    writer.field("version", data->getVersion());
+    writer.endObject();
+    queueResponse(output, "200 OK", "application/json", std::move(body), API_HEADERS, keepAlive);
+}
+
+// Answer every query of the batch from one dataset, in one response. A
+// reload cannot swap it midway, but rows ingested meanwhile may show up
+// in some results and not in others. Cache hits are taken as they are;
+// the rest run on a few threads that share per-election results through
+// an AnalysisMemo.
+void HTTPServer::handleBatch(const HTTPRequest& request, bool keepAlive, OutputQueue& output) {
+    TRACE_SPAN("HTTPServer::handleBatch");
+    if (request.method != "POST") {
+        queueResponse(output, "405 Method Not Allowed", "application/json",
+                      "{\"error\":\"use POST\"}", API_HEADERS + "Allow: POST\r\n", keepAlive);
+        return;
+    }
+    std::vector<std::string> paths;
+    if (!parseStringArray(request.body, paths) || paths.empty() || paths.size() > MAX_BATCH_QUERIES) {
+        queueResponse(output, "400 Bad Request", "application/json",
+                      "{\"error\":\"expected a JSON array of 1 to 64 API paths\"}", API_HEADERS, keepAlive);
+        return;
+    }
+    
+    ResponseFormat format = acceptedFormat(request);
+    std::shared_ptr<ElectionData> data = currentData();
+    unsigned long long version = data->getVersion();
+    
+    std::vector<BatchQuery> queries(paths.size());
+    std::vector<BatchQuery*> pending;
+    for (size_t i = 0; i < paths.size(); i++) {
+        BatchQuery& query = queries[i];
+        size_t queryPos = paths[i].find('?');
+        query.endpoint = paths[i].substr(0, queryPos);
+        if (queryPos != std::string::npos) {
+            query.params = parseQuery(paths[i].substr(queryPos + 1));
+        }
+        if (!isBatchable(query.endpoint)) {
+            query.status = 404;
+            query.error = "not a batchable endpoint";
+            continue;
         }
-        json << "]}";
+        query.cacheable = responseCache && query.endpoint != "/api/server-stats";
+        if (query.cacheable) {
+            query.cacheKey = apiCacheKey(query.endpoint, query.params, format);
+            query.response = responseCache->find(query.cacheKey, version);
+            if (query.response) {
+                query.status = 200;
+                continue;
+            }
+        }
+        pending.push_back(&query);
+    }
+    
+    if (!pending.empty()) {
+        // Counted as one heavy request, however many threads it uses
+        bool saturated = !workers || workers->queueDepth() > 0;
+        if (!admission->tryAdmit(CostClass::Heavy, saturated)) {
+            queueResponse(output, "503 Service Unavailable", "application/json",
+                          "{\"error\":\"server busy\"}", API_HEADERS + RETRY_HEADER, keepAlive);
+            return;
+        }
+        AdmissionSlot slot(*admission, CostClass::Heavy);
+        
+        AnalysisMemo memo(*data);
+        std::atomic<size_t> next(0);
+        auto work = [&]() {
+            for (size_t i = next++; i < pending.size(); i = next++) {
+                BatchQuery& query = *pending[i];
+                try {
+                    query.body = handleAPIRequest(data.get(), query.endpoint, query.params, format, &memo);
+                    query.status = 200;
+                } catch (const std::exception&) {
+                    query.status = 400;
+                    query.error = "invalid request parameters";
+                    continue;
+                }
+                // Later single requests for the same query hit these entries
+                if (query.cacheable) {
+                    auto response = buildAPIResponse("200 OK", contentTypeOf(format), std::move(query.body), true);
+                    response->dataVersion = version;
+                    responseCache->insert(query.cacheKey, response);
+                    query.response = response;
+                }
+            }
+        };
+        std::vector<std::future<void>> helpers;
+        for (size_t i = 1; i < std::min(pending.size(), MAX_BATCH_THREADS); i++) {
+            helpers.push_back(std::async(std::launch::async, work));
+        }
+        work();
+        for (auto& helper : helpers) {
+            helper.get();
+        }
+    }
+    
+    std::string body;
+    if (format == ResponseFormat::JSON) {
+        JSONWriter json(body);
+        writeBatchResults(json, version, queries);
+    } else {
+        BinaryWriter writer(body, binaryFormatOf(format));
+        writeBatchResults(writer, version, queries);
+    }
+    bool gzip = acceptsGzip(request);
+    queueCachedResponse(output, buildAPIResponse("200 OK", contentTypeOf(format), std::move(body), gzip),
+                        keepAlive, gzip);
+}
+
+// Subscribe the connection to an election's deltas; it stays open from here on
+void HTTPServer::queueLiveStream(std::map<std::string, std::string> params, bool keepAlive,
+                                 OutputQueue& output, ConnectionContext& context) {
+    int year = 0;
+    try {
+        year = std::stoi(params["year"]);
+    } catch (const std::exception&) {
+        year = 0;
+    }
+    if (params["country"].empty() || year == 0) {
+        queueResponse(output, "400 Bad Request", "application/json",
+                      "{\"error\":\"invalid request parameters\"}", API_HEADERS, keepAlive);
+        return;
+    }
+    
+    // Each blocking stream holds a worker; keep half of them for everyone else
+    bool holdsWorker = true;
+#ifdef __linux__
+    holdsWorker = options.mode == ServerMode::Blocking;
+#endif
+    if (holdsWorker && live.subscriberCount() >= static_cast<size_t>(std::max(1, options.threads / 2))) {
+        queueResponse(output, "503 Service Unavailable", "application/json",
+                      "{\"error\":\"too many live streams\"}", API_HEADERS + RETRY_HEADER, keepAlive);
+        return;
+    }
+    
+    // No length and no chunking: the stream ends when the connection does
+    output.append("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n" +
+                  API_HEADERS + "Connection: keep-alive\r\n\r\nretry: 2000\n\n");
+    context.live = live.subscribe(params["country"], year);
+    queueLiveEvents(context, output);
+}
+
+// Queue the shared event strings without copying; false once the hub dropped us
+bool HTTPServer::queueLiveEvents(ConnectionContext& context, OutputQueue& output) {
+    std::deque<std::shared_ptr<const std::string>> events;
+    bool open = context.live->take(events);
+    for (size_t i = 0; i < events.size(); i++) {
+        output.appendShared(events[i]->data(), events[i]->length(), events[i]);
+    }
+    return open;
+}
+
+// A blocking worker stays with its /api/live client until it goes away
+void HTTPServer::serveLiveBlocking(SocketHandle clientSocket, ConnectionContext& context, OutputQueue& output) {
+    static const std::string HEARTBEAT = ": ping\n\n";
+    auto lastWrite = std::chrono::steady_clock::now();
+    
+    while (running) {
+        context.live->wait(LIVE_HEARTBEAT_MS);
+        if (!queueLiveEvents(context, output)) {
+            break;
+        }
+        
+        auto now = std::chrono::steady_clock::now();
+        if (output.empty()) {
+            // Writing is the only way to notice a client that went away
+            if (now - lastWrite < std::chrono::milliseconds(LIVE_HEARTBEAT_MS)) {
+                continue;
+            }
+            output.appendShared(HEARTBEAT.data(), HEARTBEAT.length(), nullptr);
+        }
+        if (output.flush(clientSocket) != OutputQueue::FlushResult::Done) {
+            break;
+        }
+        lastWrite = now;
+    }
+}
+
+// Queue headers and body as separate segments; the body is moved, not copied
+void HTTPServer::queueResponse(OutputQueue& output, const std::string& status, const std::string& contentType,
+                               std::string&& body, const std::string& extraHeaders, bool keepAlive) {
+    std::string headers = buildHeaders(status, contentType, extraHeaders, body.length());
+    headers += keepAlive ? KEEP_ALIVE_HEADER : CLOSE_HEADER;
+    
+    output.append(std::move(headers));
+    output.append(std::move(body));
+}
+
+// Serialized API response, with a gzipped variant when the body is big enough
+std::shared_ptr<CachedResponse> HTTPServer::buildAPIResponse(const std::string& status, const std::string& contentType,
+                                                             std::string&& body, bool withGzip) {
+    auto response = std::make_shared<CachedResponse>();
+    bool varies = options.compressMinBytes > 0 && Compressor::available() &&
+                  body.length() >= options.compressMinBytes;
+    
+    if (varies && withGzip) {
+        // One deflate stream per thread, reset between bodies
+        static thread_local Compressor compressor;
+        auto gzipped = std::make_shared<CachedResponse>();
+        if (compressor.gzip(body.data(), body.length(), gzipped->body) &&
+            gzipped->body.length() < body.length()) {
+            gzipped->headers = buildHeaders(status, contentType,
+                                            API_HEADERS + "Content-Encoding: gzip\r\n" + VARY_ENCODING_HEADER,
+                                            gzipped->body.length());
+            response->gzipped = gzipped;
+        }
+    }
+    
+    response->headers = buildHeaders(status, contentType,
+                                     API_HEADERS + (varies ? VARY_ENCODING_HEADER : VARY_HEADER), body.length());
+    response->body = std::move(body);
+    return response;
+}
+
+bool HTTPServer::acceptsGzip(const HTTPRequest& request) const {
+    if (options.compressMinBytes == 0) {
+        return false;
+    }
+    auto it = request.headers.find("accept-encoding");
+    return it != request.headers.end() && Compressor::acceptsGzip(it->second);
+}
+
+// Best supported media range in Accept: highest q first, then an exact type
+// over a wildcard, then the earliest listed. Anything unknown means JSON.
+ResponseFormat HTTPServer::acceptedFormat(const HTTPRequest& request) {
+    auto it = request.headers.find("accept");
+    if (it == request.headers.end()) {
+        return ResponseFormat::JSON;
     }
     
-    return json.str();
+    const std::string& accept = it->second;
+    ResponseFormat best = ResponseFormat::JSON;
+    double bestQuality = 0.0;
+    bool bestExact = false;
+    size_t pos = 0;
+    while (pos < accept.length()) {
+        size_t comma = accept.find(',', pos);
+        if (comma == std::string::npos) comma = accept.length();
+        std::string item = accept.substr(pos, comma - pos);
+        pos = comma + 1;
+        
+        std::transform(item.begin(), item.end(), item.begin(), ::tolower);
+        item.erase(std::remove_if(item.begin(), item.end(), ::isspace), item.end());
+        
+        size_t semicolon = item.find(';');
+        std::string type = item.substr(0, semicolon);
+        double quality = 1.0;
+        if (semicolon != std::string::npos) {
+            size_t q = item.find("q=", semicolon);
+            if (q != std::string::npos) quality = std::atof(item.c_str() + q + 2);
+        }
+        
+        ResponseFormat format;
+        bool exact = true;
+        if (type == "application/msgpack" || type == "application/x-msgpack" ||
+            type == "application/vnd.msgpack") {
+            format = ResponseFormat::MessagePack;
+        } else if (type == "application/cbor") {
+            format = ResponseFormat::CBOR;
+        } else if (type == "application/json") {
+            format = ResponseFormat::JSON;
+        } else if (type == "*/*" || type == "application/*") {
+            format = ResponseFormat::JSON;
+            exact = false;
+        } else {
+            continue;
+        }
+        
+        if (quality > bestQuality || (quality == bestQuality && quality > 0.0 && exact && !bestExact)) {
+            best = format;
+            bestQuality = quality;
+            bestExact = exact;
+        }
+    }
+    return best;
+}
+
+// Reference a cached response without copying it
+void HTTPServer::queueCachedResponse(OutputQueue& output, std::shared_ptr<const CachedResponse> response,
+                                     bool keepAlive, bool gzip) {
+    if (gzip && response->gzipped) {
+        response = response->gzipped;
+    }
+    const std::string& connection = keepAlive ? KEEP_ALIVE_HEADER : CLOSE_HEADER;
+    responseStatus = std::atoi(response->headers.c_str() + 9);   // After "HTTP/1.1 "
+    output.appendShared(response->headers.data(), response->headers.length(), response);
+    output.appendShared(connection.data(), connection.length(), nullptr);
+    output.appendShared(response->body.data(), response->body.length(), response);
 }
 
-std::string HTTPServer::handleRequest(const std::string& request) {
-    std::istringstream iss(request);
-    std::string method, path, version;
-    iss >> method >> path >> version;
+bool HTTPServer::handleRequest(const HTTPRequest& request, bool keepAlive, OutputQueue& output,
+                               ConnectionContext& context) {
+    std::string path = request.path;
     
     // Helper function to check if string starts with prefix
     auto startsWith = [](const std::string& str, const std::string& prefix) {
@@ -226,41 +1406,244 @@ std::string HTTPServer::handleRequest(const std::string& request) {
         std::string endpoint = (queryPos != std::string::npos) ? path.substr(0, queryPos) : path;
         std::string query = (queryPos != std::string::npos) ? path.substr(queryPos + 1) : "";
         
-        std::string jsonResponse = handleAPIRequest(endpoint, query);
+        auto params = parseQuery(query);
+        if (endpoint == "/api/records") {
+            if (request.method == "POST") {
+                handleRecordIngest(request, keepAlive, output);
+                return keepAlive;
+            }
+            return queueRecordStream(request, std::move(params), keepAlive, output);
+        }
+        if (endpoint == "/api/admin/reload") {
+            handleAdminReload(request, keepAlive, output);
+            return keepAlive;
+        }
+        if (endpoint == "/api/admin/trace") {
+            handleAdminTrace(request, std::move(params), keepAlive, output);
+            return keepAlive;
+        }
+        if (endpoint == "/api/live") {
+            queueLiveStream(std::move(params), keepAlive, output, context);
+            return keepAlive;
+        }
+        if (endpoint == "/api/batch") {
+            handleBatch(request, keepAlive, output);
+            return keepAlive;
+        }
+        bool gzip = acceptsGzip(request);
+        ResponseFormat format = acceptedFormat(request);
+        
+        // Dashboards ask about the same few elections over and over
+        bool cacheable = responseCache && endpoint != "/api/server-stats";
+        std::string cacheKey;
+        // One snapshot for the whole request, even if a reload swaps it meanwhile
+        std::shared_ptr<ElectionData> data = currentData();
+        unsigned long long version = data->getVersion();
+        if (cacheable) {
+            cacheKey = apiCacheKey(endpoint, params, format);
+            std::shared_ptr<const CachedResponse> cached = responseCache->find(cacheKey, version);
+            if (cached) {
+                queueCachedResponse(output, cached, keepAlive, gzip);
+                return keepAlive;
+            }
+        }
+        
+        // Only computing costs a slot; cache hits were answered above.
+        // Blocking workers are saturated once connections queue for them;
+        // an event loop thread is busy for everyone it serves, so always
+        CostClass cost = AdmissionControl::classify(endpoint);
+        bool saturated = !workers || workers->queueDepth() > 0;
+        if (!admission->tryAdmit(cost, saturated)) {
+            queueResponse(output, "503 Service Unavailable", "application/json",
+                          "{\"error\":\"server busy\"}", API_HEADERS + RETRY_HEADER, keepAlive);
+            return keepAlive;
+        }
+        
+        std::string responseBody;
+        std::string status = "200 OK";
+        const char* contentType = contentTypeOf(format);
+        {
+            AdmissionSlot slot(*admission, cost);
+            try {
+                responseBody = handleAPIRequest(data.get(), endpoint, params, format, nullptr);
+            } catch (const std::exception&) {
+                // Missing or malformed query parameters (std::stoi throws); errors are always JSON
+                status = "400 Bad Request";
+                contentType = "application/json";
+                responseBody = "{\"error\":\"invalid request parameters\"}";
+                cacheable = false;
+            }
+        }
         
-        std::ostringstream response;
-        response << "HTTP/1.1 200 OK\r\n";
-        response << "Content-Type: application/json\r\n";
-        response << "Access-Control-Allow-Origin: *\r\n";
-        response << "Content-Length: " << jsonResponse.length() << "\r\n";
-        response << "\r\n";
-        response << jsonResponse;
-        return response.str();
+        // Cached responses are compressed up front for every later client
+        cacheable = cacheable && !responseBody.empty();
+        auto response = buildAPIResponse(status, contentType, std::move(responseBody), gzip || cacheable);
+        if (cacheable) {
+            response->dataVersion = version;
+            responseCache->insert(cacheKey, response);
+        }
+        queueCachedResponse(output, response, keepAlive, gzip);
+        return keepAlive;
+    }
+    
+    if (path == "/metrics") {
+        std::string body;
+        metrics.render(body);
+        queueResponse(output, "200 OK", "text/plain; version=0.0.4", std::move(body), "", keepAlive);
+        return keepAlive;
     }
     
-    // Serve static files
-    if (path == "/") path = "/index.html";
-    std::string filePath = "web" + path;
-    std::string content = readFile(filePath);
+    // Serve static files from memory; only files preloaded from web/ exist
+    size_t queryPos = path.find('?');
+    if (queryPos != std::string::npos) path.erase(queryPos);
+    std::shared_ptr<const StaticAsset> asset = assets.find(path);
     
-    if (content.empty()) {
-        std::string notFound = "<html><body><h1>404 Not Found</h1></body></html>";
-        std::ostringstream response;
-        response << "HTTP/1.1 404 Not Found\r\n";
-        response << "Content-Type: text/html\r\n";
-        response << "Content-Length: " << notFound.length() << "\r\n";
-        response << "\r\n";
-        response << notFound;
-        return response.str();
+    if (!asset) {
+        queueResponse(output, "404 Not Found", "text/html",
+                      "<html><body><h1>404 Not Found</h1></body></html>", "", keepAlive);
+        return keepAlive;
     }
+    if (asset->gzipped && acceptsGzip(request)) {
+        asset = asset->gzipped;
+    }
+    
+    // Cached headers and body are referenced, not copied; the asset stays
+    // alive until they have been written
+    const std::string& connection = keepAlive ? KEEP_ALIVE_HEADER : CLOSE_HEADER;
     
-    std::ostringstream response;
-    response << "HTTP/1.1 200 OK\r\n";
-    response << "Content-Type: " << getContentType(path) << "\r\n";
-    response << "Content-Length: " << content.length() << "\r\n";
-    response << "\r\n";
-    response << content;
-    return response.str();
+    auto ifNoneMatch = request.headers.find("if-none-match");
+    if (ifNoneMatch != request.headers.end() && asset->matches(ifNoneMatch->second)) {
+        responseStatus = 304;
+        output.appendShared(asset->notModifiedHeaders.data(), asset->notModifiedHeaders.length(), asset);
+        output.appendShared(connection.data(), connection.length(), nullptr);
+        return keepAlive;
+    }
+    
+    responseStatus = 200;
+    output.appendShared(asset->okHeaders.data(), asset->okHeaders.length(), asset);
+    output.appendShared(connection.data(), connection.length(), nullptr);
+#ifdef __linux__
+    if (asset->file) {
+        output.appendFile(asset->file, 0, asset->size);
+        return keepAlive;
+    }
+#endif
+    output.appendShared(asset->body.data(), asset->body.length(), asset);
+    return keepAlive;
+}
+
+// Buffers for connections handled on the calling thread
+BufferPool& HTTPServer::threadBufferPool() {
+    static thread_local BufferPool pool(READ_CHUNK_SIZE, 64);
+    return pool;
+}
+
+// Answer every complete request the parser holds, in order
+int HTTPServer::processRequests(RequestParser& parser, OutputQueue& output, ConnectionContext& context) {
+    HTTPRequest request;
+    int answered = 0;
+    
+    // An /api/live stream answers nothing after it
+    while (!context.closeAfterWrite && !context.live) {
+        RequestParser::Status status = parser.next(request);
+        if (status == RequestParser::Status::Incomplete) break;
+        
+        if (status == RequestParser::Status::Error) {
+            const std::string& error = parser.errorStatus();
+            queueResponse(output, error, "text/plain", error.substr(error.find(' ') + 1), "", false);
+            context.closeAfterWrite = true;
+            answered++;
+            break;
+        }
+        
+        context.requestsServed++;
+        answered++;
+        bool keepAlive = wantsKeepAlive(request) &&
+                         context.requestsServed < options.maxRequestsPerConnection;
+        auto startedAt = std::chrono::steady_clock::now();
+        size_t queuedBefore = output.pending();
+        {
+            TRACE_SPAN("HTTPServer::handleRequest");
+            if (!handleRequest(request, keepAlive, output, context)) {
+                context.closeAfterWrite = true;
+            }
+        }
+        metrics.recordRequest(ServerMetrics::endpointIndex(request.path),
+                              elapsedNanos(startedAt, std::chrono::steady_clock::now()),
+                              responseStatus, output.pending() - queuedBefore);
+    }
+    
+    return answered;
+}
+
+// Make blocking recv and send give up after the given time without progress
+static void setSocketTimeouts(SOCKET sock, int timeoutMs) {
+#ifdef _WIN32
+    DWORD timeout = timeoutMs;
+#else
+    timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+#endif
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+}
+
+// Answer 503 without reading the request, then close
+void HTTPServer::rejectConnection(SocketHandle clientSocket) {
+#ifdef MSG_DONTWAIT
+    // Whatever already arrived is discarded so closing doesn't reset the
+    // connection before the client reads the 503
+    char discard[4096];
+    while (recv(clientSocket, discard, sizeof(discard), MSG_DONTWAIT) > 0) {
+    }
+    send(clientSocket, SHED_RESPONSE.data(), SHED_RESPONSE.length(), MSG_DONTWAIT);
+#else
+    send(clientSocket, SHED_RESPONSE.data(), static_cast<int>(SHED_RESPONSE.length()), 0);
+#endif
+    closesocket(clientSocket);
+}
+
+void HTTPServer::handleConnection(SocketHandle clientSocket, std::chrono::steady_clock::time_point acceptedAt) {
+    // Its client has likely given up or retried; serving it late only
+    // delays the connections queued behind it
+    if (std::chrono::steady_clock::now() - acceptedAt > std::chrono::milliseconds(options.maxQueueWaitMs)) {
+        admission->recordShedConnection();
+        rejectConnection(clientSocket);
+        return;
+    }
+    
+    // A client that sends nothing for this long (including between
+    // keep-alive requests), or stops reading its responses, gives up its
+    // worker; a timed-out send ends the flush below with WouldBlock
+    setSocketTimeouts(clientSocket, options.idleTimeoutMs);
+    
+    RequestParser parser(&threadBufferPool(), MAX_HEADER_SIZE, options.maxBodySize);
+    OutputQueue output;
+    ConnectionContext context;
+    
+    while (!context.closeAfterWrite) {
+        char* buffer = parser.prepare(READ_CHUNK_SIZE / 4);
+        int received = recv(clientSocket, buffer, static_cast<int>(parser.space()), 0);
+        if (received <= 0) break;
+        parser.commit(received);
+        
+        processRequests(parser, output, context);
+        
+        // Pipelined responses go out together, in request order
+        if (output.flush(clientSocket) != OutputQueue::FlushResult::Done) {
+            break;
+        }
+        if (context.live) {
+            serveLiveBlocking(clientSocket, context, output);
+            break;
+        }
+    }
+    
+    if (context.live) {
+        live.unsubscribe(context.live);
+    }
+    closesocket(clientSocket);
 }
 
 void HTTPServer::start() {
@@ -270,6 +1653,10 @@ void HTTPServer::start() {
         return;
     }
     
+    // Allow quick restarts while old connections are in TIME_WAIT
+    int reuse = 1;
+    setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+    
     sockaddr_in serverAddr;
     serverAddr.sin_family = AF_INET;
     serverAddr.sin_addr.s_addr = INADDR_ANY;
@@ -281,14 +1668,73 @@ void HTTPServer::start() {
         return;
     }
     
-    if (listen(serverSocket, 10) == SOCKET_ERROR) {
+    if (listen(serverSocket, options.backlog) == SOCKET_ERROR) {
         std::cerr << "Failed to listen" << std::endl;
         closesocket(serverSocket);
         return;
     }
     
     running = true;
-    std::cout << "Server started on http://localhost:" << port << std::endl;
+    
+#ifndef _WIN32
+    // A client hanging up mid-sendfile must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    
+    assets.load();
+    assets.startWatching(options.assetRefreshMs);
+    
+    if (datasetLoader) {
+#ifndef _WIN32
+        signal(SIGHUP, onHangup);
+#endif
+        reloadThread = std::thread(&HTTPServer::reloadLoop, this);
+    }
+    
+    if (options.mode == ServerMode::IoUring) {
+#ifdef ELECTION_HAVE_IO_URING
+        std::string reason;
+        if (probeIoUring(reason)) {
+            std::cout << "Server started on http://localhost:" << port
+                      << " (io_uring, " << options.eventThreads << " threads)" << std::endl;
+            std::cout << "Press Ctrl+C to stop the server" << std::endl;
+            runIoUring(serverSocket);
+            closesocket(serverSocket);
+            return;
+        }
+        std::cout << "io_uring unavailable (" << reason << "); using the epoll event loop" << std::endl;
+        options.mode = ServerMode::EventLoop;
+#elif defined(__linux__)
+        std::cout << "io_uring support not compiled in (kernel headers too old); "
+                  << "using the epoll event loop" << std::endl;
+        options.mode = ServerMode::EventLoop;
+#else
+        std::cout << "io_uring mode needs Linux; using blocking mode" << std::endl;
+#endif
+    }
+    
+    if (options.mode == ServerMode::EventLoop) {
+#ifdef __linux__
+        std::cout << "Server started on http://localhost:" << port 
+                  << " (epoll event loop, " << options.eventThreads << " threads)" << std::endl;
+        std::cout << "Press Ctrl+C to stop the server" << std::endl;
+        runEventLoop(serverSocket);
+        closesocket(serverSocket);
+        return;
+#else
+        std::cout << "Event loop mode needs Linux epoll; using blocking mode" << std::endl;
+#endif
+    }
+    
+    runBlocking(serverSocket);
+    closesocket(serverSocket);
+}
+
+void HTTPServer::runBlocking(SocketHandle serverSocket) {
+    workers.reset(new ThreadPool(options.threads, options.queueSize));
+    
+    std::cout << "Server started on http://localhost:" << port 
+              << " (" << workers->threadCount() << " worker threads)" << std::endl;
     std::cout << "Open your browser and navigate to the URL above" << std::endl;
     std::cout << "Press Ctrl+C to stop the server" << std::endl;
     
@@ -299,18 +1745,29 @@ void HTTPServer::start() {
         
         if (clientSocket == INVALID_SOCKET) continue;
         
-        char buffer[4096] = {0};
-        recv(clientSocket, buffer, sizeof(buffer), 0);
-        
-        std::string response = handleRequest(std::string(buffer));
-        send(clientSocket, response.c_str(), response.length(), 0);
+        // Responses are written in one go; don't wait for Nagle
+        int noDelay = 1;
+        setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
         
-        closesocket(clientSocket);
+        // A full queue means overload: refuse now rather than leave the
+        // client waiting in the kernel backlog
+        auto acceptedAt = std::chrono::steady_clock::now();
+        if (!workers->trySubmit([this, clientSocket, acceptedAt] { handleConnection(clientSocket, acceptedAt); })) {
+            admission->recordShedConnection();
+            rejectConnection(clientSocket);
+        }
     }
     
-    closesocket(serverSocket);
+    workers->shutdown();
 }
 
 void HTTPServer::stop() {
     running = false;
+    assets.stopWatching();
+    live.closeAll();
+    
+    reloadWake.notify_all();
+    if (reloadThread.joinable() && reloadThread.get_id() != std::this_thread::get_id()) {
+        reloadThread.join();
+    }
 }
@@ -0,0 +1,278 @@
+#ifdef __linux__
+
+#include "../include/HTTPServer.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+const int MAX_EVENTS = 256;
+
+// Stop answering pipelined requests until this much output has drained
+const size_t MAX_PENDING_OUTPUT = 1024 * 1024;
+
+// epoll data of the eventfd that LiveHub pokes when events are queued
+char WAKE_MARKER;
+
+const std::string HEARTBEAT = ": ping\n\n";
+
+/**
+ * @brief Per-connection state owned by one event loop thread
+ *
+ * Input is parsed as it arrives; responses are queued on output in
+ * request order and drained whenever the socket is writable.
+ */
+struct Connection {
+    int fd;
+    bool peerClosed;
+    bool closed;        // Socket closed; freed once the current event batch is done
+    ConnectionContext context;
+    RequestParser parser;
+    OutputQueue output;
+    std::chrono::steady_clock::time_point lastActive;
+
+    Connection(int fd, BufferPool* pool, size_t maxHeaderSize, size_t maxBodySize)
+        : fd(fd), peerClosed(false), closed(false), parser(pool, maxHeaderSize, maxBodySize) {
+    }
+};
+
+// Read until the socket would block; false on EOF or error
+bool readAvailable(Connection* conn, size_t chunkSize) {
+    while (true) {
+        char* buffer = conn->parser.prepare(chunkSize);
+        ssize_t n = recv(conn->fd, buffer, conn->parser.space(), 0);
+        if (n > 0) {
+            conn->parser.commit(n);
+        } else if (n == 0) {
+            return false;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return true;
+        } else if (errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+// Write until done or the socket would block; false on error
+bool writePending(Connection* conn) {
+    return conn->output.flush(conn->fd) != OutputQueue::FlushResult::Error;
+}
+
+} // namespace
+
+void HTTPServer::runEventLoop(SocketHandle serverSocket) {
+    // All loop threads share the listening socket; it must never block
+    fcntl(serverSocket, F_SETFL, fcntl(serverSocket, F_GETFL, 0) | O_NONBLOCK);
+
+    int threadCount = options.eventThreads > 0 ? options.eventThreads : 1;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++) {
+        threads.push_back(std::thread(&HTTPServer::eventLoopThread, this, serverSocket));
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+}
+
+void HTTPServer::eventLoopThread(SocketHandle serverSocket) {
+    int epollFd = epoll_create1(0);
+    if (epollFd < 0) {
+        std::cerr << "Failed to create epoll instance" << std::endl;
+        return;
+    }
+
+    // EPOLLEXCLUSIVE wakes only one of the loop threads per new connection
+    epoll_event listenEvent;
+    listenEvent.events = EPOLLIN | EPOLLEXCLUSIVE;
+    listenEvent.data.ptr = nullptr;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, serverSocket, &listenEvent);
+
+    // /api/live events queued by other threads wake the loop through this
+    int wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event wakeEvent;
+    wakeEvent.events = EPOLLIN | EPOLLET;
+    wakeEvent.data.ptr = &WAKE_MARKER;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &wakeEvent);
+
+    std::unordered_map<int, Connection*> connections;
+    std::unordered_set<Connection*> liveConnections;
+
+    // Later entries of the same epoll_wait batch may still point at a
+    // connection closed here, so it is only freed once the batch is done
+    std::vector<Connection*> closedConnections;
+    auto closeConnection = [&](Connection* conn) {
+        if (conn->closed) return;
+        conn->closed = true;
+        if (conn->context.live) {
+            // Late publishes must not write to wakeFd once it is closed
+            conn->context.live->setWake(nullptr);
+            live.unsubscribe(conn->context.live);
+            liveConnections.erase(conn);
+        }
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+        close(conn->fd);
+        connections.erase(conn->fd);
+        closedConnections.push_back(conn);
+    };
+    auto freeClosed = [&]() {
+        for (size_t i = 0; i < closedConnections.size(); i++) {
+            delete closedConnections[i];
+        }
+        closedConnections.clear();
+    };
+
+    epoll_event events[MAX_EVENTS];
+    auto lastSweep = std::chrono::steady_clock::now();
+
+    while (running) {
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, 1000);
+        auto now = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < count; i++) {
+            Connection* conn = static_cast<Connection*>(events[i].data.ptr);
+
+            // New connections: accept everything that is waiting
+            if (conn == nullptr) {
+                while (true) {
+                    int clientFd = accept4(serverSocket, nullptr, nullptr, SOCK_NONBLOCK);
+                    if (clientFd < 0) break;
+
+                    int noDelay = 1;
+                    setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+                    Connection* client = new Connection(clientFd, &threadBufferPool(),
+                                                        MAX_HEADER_SIZE, options.maxBodySize);
+                    client->lastActive = now;
+                    connections[clientFd] = client;
+
+                    // Edge-triggered for both directions: no re-arming needed
+                    epoll_event clientEvent;
+                    clientEvent.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+                    clientEvent.data.ptr = client;
+                    epoll_ctl(epollFd, EPOLL_CTL_ADD, clientFd, &clientEvent);
+                }
+                continue;
+            }
+
+            // Deltas were queued for some /api/live connections
+            if (events[i].data.ptr == &WAKE_MARKER) {
+                uint64_t wakes;
+                while (read(wakeFd, &wakes, sizeof(wakes)) > 0) {
+                }
+                std::vector<Connection*> finished;
+                for (Connection* client : liveConnections) {
+                    if (!queueLiveEvents(client->context, client->output) || !writePending(client)) {
+                        finished.push_back(client);
+                    }
+                }
+                for (size_t j = 0; j < finished.size(); j++) {
+                    closeConnection(finished[j]);
+                }
+                continue;
+            }
+
+            if (conn->closed) {
+                continue;
+            }
+            if (events[i].events & EPOLLERR) {
+                closeConnection(conn);
+                continue;
+            }
+            conn->lastActive = now;
+
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+                if (!readAvailable(conn, READ_CHUNK_SIZE / 4)) {
+                    conn->peerClosed = true;
+                }
+            }
+
+            // Answer buffered requests and write, until blocked or done
+            bool failed = false;
+            while (true) {
+                int answered = 0;
+                if (conn->output.pending() < MAX_PENDING_OUTPUT) {
+                    answered = processRequests(conn->parser, conn->output, conn->context);
+                }
+                if (!writePending(conn)) {
+                    failed = true;
+                    break;
+                }
+                // Keep going only if the write drained and more requests may be waiting
+                if (!conn->output.empty() || conn->context.closeAfterWrite || answered == 0) {
+                    break;
+                }
+            }
+
+            // Just became an /api/live stream: from now on its events wake this loop
+            if (!failed && conn->context.live && liveConnections.insert(conn).second) {
+                conn->context.live->setWake([wakeFd] {
+                    uint64_t one = 1;
+                    ssize_t written = write(wakeFd, &one, sizeof(one));
+                    (void)written;
+                });
+                // Anything queued before the wake was set
+                failed = !queueLiveEvents(conn->context, conn->output) || !writePending(conn);
+            }
+
+            // A client pipelining without reading responses can't grow input forever
+            bool drained = conn->output.empty();
+            if (failed || (drained && (conn->context.closeAfterWrite || conn->peerClosed)) ||
+                conn->parser.buffered() > MAX_HEADER_SIZE + options.maxBodySize) {
+                closeConnection(conn);
+            }
+        }
+
+        // Drop connections that have been idle too long
+        if (now - lastSweep >= std::chrono::seconds(1)) {
+            lastSweep = now;
+            auto idleLimit = std::chrono::milliseconds(options.idleTimeoutMs);
+            auto heartbeat = std::chrono::milliseconds(LIVE_HEARTBEAT_MS);
+            std::vector<Connection*> idle;
+            for (const auto& pair : connections) {
+                Connection* conn = pair.second;
+                if (conn->context.live) {
+                    // Quiet streams are kept, but written to now and then to
+                    // find clients that went away
+                    if (now - conn->lastActive > heartbeat && conn->output.empty()) {
+                        conn->lastActive = now;
+                        conn->output.appendShared(HEARTBEAT.data(), HEARTBEAT.length(), nullptr);
+                        if (!writePending(conn)) {
+                            idle.push_back(conn);
+                        }
+                    }
+                } else if (now - conn->lastActive > idleLimit) {
+                    idle.push_back(conn);
+                }
+            }
+            for (size_t i = 0; i < idle.size(); i++) {
+                closeConnection(idle[i]);
+            }
+        }
+        freeClosed();
+    }
+
+    std::vector<Connection*> remaining;
+    for (const auto& pair : connections) {
+        remaining.push_back(pair.second);
+    }
+    for (size_t i = 0; i < remaining.size(); i++) {
+        closeConnection(remaining[i]);
+    }
+    freeClosed();
+    close(epollFd);
+    close(wakeFd);
+}
+
+#endif // __linux__
@@ -0,0 +1,493 @@
+#ifdef ELECTION_HAVE_IO_URING
+
+#include "../include/HTTPServer.h"
+#include "../include/IoUring.h"
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+const unsigned RING_ENTRIES = 1024;
+
+// Receive buffers handed to the kernel; data is copied out and the buffer
+// returned right away, so a few hundred serve any number of connections
+const uint16_t BUFFER_GROUP = 1;
+const unsigned BUFFER_COUNT = 512;
+const unsigned BUFFER_SIZE = 4096;
+
+// Stop answering pipelined requests until this much output has drained
+const size_t MAX_PENDING_OUTPUT = 1024 * 1024;
+
+// Memory segments gathered into one sendmsg
+const size_t MAX_IOVECS = 64;
+
+const std::string HEARTBEAT = ": ping\n\n";
+
+// user_data is a Connection pointer with the operation in its low bits;
+// with a null pointer the low bits name a loop-wide operation instead
+enum Operation : uint64_t {
+    OP_RECV = 1,
+    OP_SEND = 2,
+    OP_POLL = 3,
+    OP_CLOSE = 4,
+    OP_CANCEL = 5,
+
+    OP_ACCEPT = 1,
+    OP_TIMER = 2,
+    OP_WAKE = 3
+};
+const uint64_t OP_MASK = 7;
+
+/**
+ * @brief Per-connection state owned by one io_uring loop thread
+ *
+ * At most one send (or POLLOUT wait) is in flight and nothing is queued
+ * on output meanwhile, so the iovecs handed to the kernel stay valid.
+ * The connection is freed once it is closing and every submission that
+ * refers to it has completed.
+ */
+struct alignas(8) Connection {
+    int fd;
+    bool recvArmed;
+    bool sending;
+    bool peerClosed;
+    bool closing;
+    bool closeSubmitted;
+    int inFlight;
+    uint64_t sendTag;           // user_data of the send or poll in flight
+    ConnectionContext context;
+    RequestParser parser;
+    OutputQueue output;
+    msghdr message;
+    iovec iov[MAX_IOVECS];
+    std::chrono::steady_clock::time_point lastActive;
+
+    Connection(int fd, BufferPool* pool, size_t maxHeaderSize, size_t maxBodySize)
+        : fd(fd), recvArmed(false), sending(false), peerClosed(false), closing(false),
+          closeSubmitted(false), inFlight(0), sendTag(0), parser(pool, maxHeaderSize, maxBodySize) {
+    }
+};
+
+uint64_t tag(Connection* conn, Operation op) {
+    return reinterpret_cast<uint64_t>(conn) | op;
+}
+
+bool setUpRing(IoUring& ring, std::string& reason) {
+    if (!ring.init(RING_ENTRIES, reason)) {
+        return false;
+    }
+    const int needed[] = {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SENDMSG, IORING_OP_CLOSE,
+                          IORING_OP_ASYNC_CANCEL, IORING_OP_TIMEOUT, IORING_OP_READ, IORING_OP_POLL_ADD};
+    for (int op : needed) {
+        if (!ring.supports(op)) {
+            reason = "kernel lacks io_uring opcode " + std::to_string(op);
+            return false;
+        }
+    }
+    // Provided buffer rings arrived with multishot accept (Linux 5.19)
+    return ring.initBuffers(BUFFER_GROUP, BUFFER_COUNT, BUFFER_SIZE, reason);
+}
+
+} // namespace
+
+bool HTTPServer::probeIoUring(std::string& reason) {
+    IoUring ring;
+    return setUpRing(ring, reason);
+}
+
+void HTTPServer::runIoUring(SocketHandle serverSocket) {
+    // Threads that fall back to epoll share the listening socket
+    fcntl(serverSocket, F_SETFL, fcntl(serverSocket, F_GETFL, 0) | O_NONBLOCK);
+
+    int threadCount = options.eventThreads > 0 ? options.eventThreads : 1;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++) {
+        threads.push_back(std::thread(&HTTPServer::ioUringThread, this, serverSocket));
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+}
+
+void HTTPServer::ioUringThread(SocketHandle serverSocket) {
+    std::unique_ptr<IoUring> ring(new IoUring());
+    std::string reason;
+    if (!setUpRing(*ring, reason)) {
+        std::cerr << "io_uring unavailable (" << reason << "); thread uses epoll" << std::endl;
+        eventLoopThread(serverSocket);
+        return;
+    }
+
+    // Multishot accept and recv need Linux 5.19 and 6.0; older kernels
+    // reject them with EINVAL and get one submission per accept or recv
+    bool multishotAccept = true;
+    bool multishotRecv = true;
+
+    // /api/live events queued by other threads complete a read of this
+    int wakeFd = eventfd(0, EFD_CLOEXEC);
+    uint64_t wakeCount = 0;
+    __kernel_timespec tick;
+    tick.tv_sec = 1;
+    tick.tv_nsec = 0;
+
+    std::unordered_set<Connection*> connections;
+    std::unordered_set<Connection*> liveConnections;
+    std::unordered_set<Connection*> closingConnections;   // Waiting for their last completions
+
+    // The ring holds RING_ENTRIES; when full, queued entries are submitted
+    // and the next one retried after completions were reaped
+    auto nextSqe = [&]() {
+        io_uring_sqe* sqe = ring->nextSqe();
+        while (!sqe) {
+            ring->submit(1);
+            sqe = ring->nextSqe();
+        }
+        return sqe;
+    };
+    auto submitFor = [&](Connection* conn, Operation op, uint8_t opcode) {
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = opcode;
+        sqe->fd = conn->fd;
+        sqe->user_data = tag(conn, op);
+        conn->inFlight++;
+        return sqe;
+    };
+
+    auto armAccept = [&]() {
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = serverSocket;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        sqe->ioprio = multishotAccept ? IORING_ACCEPT_MULTISHOT : 0;
+        sqe->user_data = OP_ACCEPT;
+    };
+    auto armTimer = [&]() {
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_TIMEOUT;
+        sqe->fd = -1;
+        sqe->addr = reinterpret_cast<uint64_t>(&tick);
+        sqe->len = 1;
+        sqe->user_data = OP_TIMER;
+    };
+    auto armWake = [&]() {
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = wakeFd;
+        sqe->addr = reinterpret_cast<uint64_t>(&wakeCount);
+        sqe->len = sizeof(wakeCount);
+        sqe->off = static_cast<uint64_t>(-1);
+        sqe->user_data = OP_WAKE;
+    };
+
+    // Received data lands in a buffer picked from the ring
+    auto armRecv = [&](Connection* conn) {
+        io_uring_sqe* sqe = submitFor(conn, OP_RECV, IORING_OP_RECV);
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = BUFFER_GROUP;
+        sqe->ioprio = multishotRecv ? IORING_RECV_MULTISHOT : 0;
+        conn->recvArmed = true;
+    };
+    auto submitClose = [&](Connection* conn) {
+        submitFor(conn, OP_CLOSE, IORING_OP_CLOSE);
+        conn->closeSubmitted = true;
+    };
+
+    // Stop receiving and close once no send is using the socket
+    auto startClose = [&](Connection* conn) {
+        if (conn->closing) return;
+        conn->closing = true;
+        if (conn->context.live) {
+            // Late publishes must not write to wakeFd once it is closed
+            conn->context.live->setWake(nullptr);
+            live.unsubscribe(conn->context.live);
+            liveConnections.erase(conn);
+        }
+        connections.erase(conn);
+        closingConnections.insert(conn);
+        if (conn->recvArmed) {
+            io_uring_sqe* sqe = submitFor(conn, OP_CANCEL, IORING_OP_ASYNC_CANCEL);
+            sqe->fd = -1;
+            sqe->addr = tag(conn, OP_RECV);
+        }
+        if (!conn->sending && !conn->closeSubmitted) {
+            submitClose(conn);
+        }
+    };
+    auto releaseIfDone = [&](Connection* conn) {
+        if (conn->closing && conn->inFlight == 0) {
+            closingConnections.erase(conn);
+            delete conn;
+        }
+    };
+
+    // A client that stopped reading never completes its send
+    auto abortSend = [&](Connection* conn) {
+        if (conn->sending) {
+            io_uring_sqe* sqe = submitFor(conn, OP_CANCEL, IORING_OP_ASYNC_CANCEL);
+            sqe->fd = -1;
+            sqe->addr = conn->sendTag;
+        }
+    };
+
+    // Answer buffered requests and start sending the responses. Runs only
+    // between sends; the completion of a send calls it again.
+    auto pump = [&](Connection* conn) {
+        while (!conn->sending && !conn->closing) {
+            if (conn->output.pending() < MAX_PENDING_OUTPUT) {
+                processRequests(conn->parser, conn->output, conn->context);
+            }
+
+            // Just became an /api/live stream: from now on its events wake this loop
+            if (conn->context.live) {
+                if (liveConnections.insert(conn).second) {
+                    conn->context.live->setWake([wakeFd] {
+                        uint64_t one = 1;
+                        ssize_t written = write(wakeFd, &one, sizeof(one));
+                        (void)written;
+                    });
+                }
+                if (!queueLiveEvents(conn->context, conn->output)) {
+                    startClose(conn);
+                    return;
+                }
+            }
+
+            // A client pipelining without reading responses can't grow input forever
+            if (conn->output.empty()) {
+                if (conn->context.closeAfterWrite || conn->peerClosed ||
+                    conn->parser.buffered() > MAX_HEADER_SIZE + options.maxBodySize) {
+                    startClose(conn);
+                }
+                return;
+            }
+
+            bool all = false;
+            size_t count = conn->output.gather(conn->iov, MAX_IOVECS, all);
+            if (count > 0) {
+                std::memset(&conn->message, 0, sizeof(conn->message));
+                conn->message.msg_iov = conn->iov;
+                conn->message.msg_iovlen = count;
+                io_uring_sqe* sqe = submitFor(conn, OP_SEND, IORING_OP_SENDMSG);
+                sqe->addr = reinterpret_cast<uint64_t>(&conn->message);
+                sqe->len = 1;
+                sqe->msg_flags = MSG_NOSIGNAL;
+                conn->sending = true;
+                conn->sendTag = sqe->user_data;
+
+                // Last response of the connection: the close is linked to the
+                // send, so both go to the kernel in one submission
+                if (all && (conn->context.closeAfterWrite || conn->peerClosed)) {
+                    sqe->flags |= IOSQE_IO_LINK;
+                    sqe->msg_flags |= MSG_WAITALL;
+                    submitClose(conn);
+                    startClose(conn);
+                }
+                return;
+            }
+
+            // A file range is next: sendfile it, waiting for POLLOUT when full
+            OutputQueue::FlushResult result = conn->output.flush(conn->fd);
+            if (result == OutputQueue::FlushResult::Error) {
+                startClose(conn);
+                return;
+            }
+            if (result == OutputQueue::FlushResult::WouldBlock) {
+                io_uring_sqe* sqe = submitFor(conn, OP_POLL, IORING_OP_POLL_ADD);
+                sqe->poll32_events = POLLOUT;
+                conn->sending = true;
+                conn->sendTag = sqe->user_data;
+                return;
+            }
+        }
+    };
+
+    auto onAccept = [&](const io_uring_cqe& cqe, std::chrono::steady_clock::time_point now) {
+        if (cqe.res >= 0) {
+            int noDelay = 1;
+            setsockopt(cqe.res, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+            Connection* client = new Connection(cqe.res, &threadBufferPool(),
+                                                MAX_HEADER_SIZE, options.maxBodySize);
+            client->lastActive = now;
+            connections.insert(client);
+            armRecv(client);
+        } else if (cqe.res == -EINVAL && multishotAccept) {
+            multishotAccept = false;
+        }
+        if (!(cqe.flags & IORING_CQE_F_MORE) && running) {
+            armAccept();
+        }
+    };
+
+    auto onRecv = [&](Connection* conn, const io_uring_cqe& cqe, std::chrono::steady_clock::time_point now) {
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            conn->recvArmed = false;
+            conn->inFlight--;
+        }
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+            uint16_t id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            if (cqe.res > 0 && !conn->closing) {
+                char* target = conn->parser.prepare(cqe.res);
+                std::memcpy(target, ring->bufferData(id), cqe.res);
+                conn->parser.commit(cqe.res);
+                conn->lastActive = now;
+            }
+            ring->recycleBuffer(id);
+        }
+
+        if (conn->closing) {
+            return;
+        }
+        if (cqe.res == 0) {
+            conn->peerClosed = true;
+        } else if (cqe.res == -EINVAL && multishotRecv) {
+            multishotRecv = false;
+        } else if (cqe.res < 0 && cqe.res != -ENOBUFS) {
+            // ENOBUFS: every buffer was in use; they are back, so just re-arm
+            startClose(conn);
+            return;
+        }
+        if (!conn->recvArmed && !conn->peerClosed) {
+            armRecv(conn);
+        }
+        pump(conn);
+    };
+
+    auto onSendDone = [&](Connection* conn, const io_uring_cqe& cqe, bool polled,
+                          std::chrono::steady_clock::time_point now) {
+        conn->inFlight--;
+        conn->sending = false;
+        if (cqe.res < 0) {
+            startClose(conn);
+        } else if (!polled) {
+            conn->output.written(static_cast<size_t>(cqe.res));
+            conn->lastActive = now;
+        }
+        if (conn->closing) {
+            if (!conn->closeSubmitted) submitClose(conn);
+            return;
+        }
+        pump(conn);
+    };
+
+    auto sweep = [&](std::chrono::steady_clock::time_point now) {
+        auto idleLimit = std::chrono::milliseconds(options.idleTimeoutMs);
+        auto heartbeat = std::chrono::milliseconds(LIVE_HEARTBEAT_MS);
+        std::vector<Connection*> quiet;
+        std::vector<Connection*> idle;
+        for (Connection* conn : connections) {
+            if (conn->context.live) {
+                // Quiet streams are kept, but written to now and then to
+                // find clients that went away
+                if (now - conn->lastActive > heartbeat && !conn->sending && conn->output.empty()) {
+                    conn->lastActive = now;
+                    conn->output.appendShared(HEARTBEAT.data(), HEARTBEAT.length(), nullptr);
+                    quiet.push_back(conn);
+                }
+            } else if (now - conn->lastActive > idleLimit) {
+                idle.push_back(conn);
+            }
+        }
+        for (Connection* conn : closingConnections) {
+            if (now - conn->lastActive > idleLimit) {
+                abortSend(conn);
+                conn->lastActive = now;
+            }
+        }
+        for (size_t i = 0; i < quiet.size(); i++) {
+            pump(quiet[i]);
+        }
+        for (size_t i = 0; i < idle.size(); i++) {
+            abortSend(idle[i]);
+            startClose(idle[i]);
+        }
+    };
+
+    armAccept();
+    armTimer();
+    armWake();
+
+    while (running) {
+        int submitted = ring->submit(1);
+        if (submitted < 0 && submitted != -EINTR && submitted != -EBUSY) {
+            std::cerr << "io_uring_enter failed: " << std::strerror(-submitted) << std::endl;
+            break;
+        }
+        auto now = std::chrono::steady_clock::now();
+
+        ring->drain([&](const io_uring_cqe& cqe) {
+            Connection* conn = reinterpret_cast<Connection*>(cqe.user_data & ~OP_MASK);
+            uint64_t op = cqe.user_data & OP_MASK;
+
+            if (conn == nullptr) {
+                if (op == OP_ACCEPT) {
+                    onAccept(cqe, now);
+                } else if (op == OP_TIMER) {
+                    sweep(now);
+                    if (running) armTimer();
+                } else if (op == OP_WAKE) {
+                    // Deltas were queued for some /api/live connections; those
+                    // mid-send pick them up when the send completes
+                    std::vector<Connection*> streams(liveConnections.begin(), liveConnections.end());
+                    for (size_t i = 0; i < streams.size(); i++) {
+                        pump(streams[i]);
+                    }
+                    armWake();
+                }
+                return;
+            }
+
+            switch (op) {
+            case OP_RECV:
+                onRecv(conn, cqe, now);
+                break;
+            case OP_SEND:
+            case OP_POLL:
+                onSendDone(conn, cqe, op == OP_POLL, now);
+                break;
+            case OP_CLOSE:
+                conn->inFlight--;
+                // Cancelled because the linked send came up short
+                if (cqe.res == -ECANCELED) submitClose(conn);
+                break;
+            case OP_CANCEL:
+                conn->inFlight--;
+                break;
+            }
+            releaseIfDone(conn);
+        });
+    }
+
+    // Closing the ring cancels everything in flight before memory is freed
+    for (Connection* conn : connections) {
+        if (conn->context.live) {
+            conn->context.live->setWake(nullptr);
+            live.unsubscribe(conn->context.live);
+        }
+        close(conn->fd);
+    }
+    ring.reset();
+    for (Connection* conn : connections) {
+        delete conn;
+    }
+    for (Connection* conn : closingConnections) {
+        delete conn;
+    }
+    close(wakeFd);
+}
+
+#endif // ELECTION_HAVE_IO_URING
@@ -0,0 +1,197 @@
+#ifdef ELECTION_HAVE_IO_URING
+
+#include "../include/IoUring.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const unsigned PROBE_OPS = 256;
+
+int ringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ringRegister(int fd, unsigned opcode, void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+void* mapRing(int fd, size_t size, off_t offset) {
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return memory == MAP_FAILED ? nullptr : memory;
+}
+
+std::string describe(const char* what, int error) {
+    return std::string(what) + ": " + std::strerror(error);
+}
+
+} // namespace
+
+IoUring::IoUring()
+    : ringFd(-1), sqEntries(0), sqRing(nullptr), sqRingSize(0), cqRing(nullptr), cqRingSize(0),
+      sqes(nullptr), sqesSize(0), sqHead(nullptr), sqTail(nullptr), sqMask(0), localTail(0),
+      submittedTail(0), cqHead(nullptr), cqTail(nullptr), cqMask(0), cqes(nullptr), probe(nullptr),
+      bufferRing(nullptr), bufferRingSize(0), buffers(nullptr), buffersSize(0), bufferCount(0),
+      bufferSize(0), bufferTail(0) {
+}
+
+IoUring::~IoUring() {
+    // Closing the ring cancels whatever is still in flight
+    if (ringFd >= 0) close(ringFd);
+    if (buffers) munmap(buffers, buffersSize);
+    if (bufferRing) munmap(bufferRing, bufferRingSize);
+    if (sqes) munmap(sqes, sqesSize);
+    if (cqRing && cqRing != sqRing) munmap(cqRing, cqRingSize);
+    if (sqRing) munmap(sqRing, sqRingSize);
+    std::free(probe);
+}
+
+bool IoUring::init(unsigned entries, std::string& error) {
+    // Completions come from many connections at once, so the CQ is sized
+    // well beyond the SQ. Flags from newer kernels are dropped if refused.
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SINGLE_ISSUER;
+    params.cq_entries = entries * 8;
+    ringFd = ringSetup(entries, &params);
+    if (ringFd < 0 && errno == EINVAL) {
+        std::memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = entries * 8;
+        ringFd = ringSetup(entries, &params);
+    }
+    if (ringFd < 0) {
+        error = describe("io_uring_setup", errno);
+        return false;
+    }
+    if (!(params.features & IORING_FEAT_NODROP)) {
+        error = "kernel may drop completions (no IORING_FEAT_NODROP)";
+        return false;
+    }
+
+    sqEntries = params.sq_entries;
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) {
+        sqRingSize = cqRingSize = sqRingSize > cqRingSize ? sqRingSize : cqRingSize;
+    }
+    sqRing = mapRing(ringFd, sqRingSize, IORING_OFF_SQ_RING);
+    cqRing = singleMap ? sqRing : mapRing(ringFd, cqRingSize, IORING_OFF_CQ_RING);
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(mapRing(ringFd, sqesSize, IORING_OFF_SQES));
+    if (!sqRing || !cqRing || !sqes) {
+        error = describe("mmap of io_uring queues", errno);
+        return false;
+    }
+
+    char* sq = static_cast<char*>(sqRing);
+    sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    localTail = submittedTail = *sqTail;
+
+    // Entry i always sits in slot i, so the index array never changes
+    unsigned* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < params.sq_entries; i++) {
+        array[i] = i;
+    }
+
+    char* cq = static_cast<char*>(cqRing);
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    size_t probeSize = sizeof(io_uring_probe) + PROBE_OPS * sizeof(io_uring_probe_op);
+    probe = static_cast<io_uring_probe*>(std::calloc(1, probeSize));
+    if (ringRegister(ringFd, IORING_REGISTER_PROBE, probe, PROBE_OPS) < 0) {
+        error = describe("io_uring probe", errno);
+        return false;
+    }
+    return true;
+}
+
+bool IoUring::supports(int opcode) const {
+    return probe && opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED);
+}
+
+io_uring_sqe* IoUring::nextSqe() {
+    if (localTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+        submit(0);
+        if (localTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+            return nullptr;
+        }
+    }
+    io_uring_sqe* sqe = &sqes[localTail & sqMask];
+    std::memset(sqe, 0, sizeof(*sqe));
+    localTail++;
+    return sqe;
+}
+
+int IoUring::submit(unsigned waitFor) {
+    unsigned toSubmit = localTail - submittedTail;
+    __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+    submittedTail = localTail;
+    if (toSubmit == 0 && waitFor == 0) {
+        return 0;
+    }
+
+    unsigned flags = waitFor > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int result = ringEnter(ringFd, toSubmit, waitFor, flags);
+    return result < 0 ? -errno : result;
+}
+
+bool IoUring::initBuffers(uint16_t group, unsigned count, unsigned size, std::string& error) {
+    bufferRingSize = count * sizeof(io_uring_buf);
+    void* ring = mmap(nullptr, bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    buffersSize = static_cast<size_t>(count) * size;
+    void* memory = mmap(nullptr, buffersSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED || memory == MAP_FAILED) {
+        if (ring != MAP_FAILED) munmap(ring, bufferRingSize);
+        if (memory != MAP_FAILED) munmap(memory, buffersSize);
+        error = describe("mmap of receive buffers", errno);
+        return false;
+    }
+    bufferRing = static_cast<io_uring_buf_ring*>(ring);
+    buffers = static_cast<char*>(memory);
+    bufferCount = count;
+    bufferSize = size;
+
+    io_uring_buf_reg registration;
+    std::memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = reinterpret_cast<uint64_t>(bufferRing);
+    registration.ring_entries = count;
+    registration.bgid = group;
+    if (ringRegister(ringFd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0) {
+        error = describe("provided buffer ring", errno);
+        return false;
+    }
+
+    for (unsigned i = 0; i < count; i++) {
+        recycleBuffer(static_cast<uint16_t>(i));
+    }
+    return true;
+}
+
+void IoUring::recycleBuffer(uint16_t id) {
+    // Not bufferRing->bufs: compiled as C++, the header's flexible array
+    // wrapper puts it 8 bytes in, over the tail; the kernel starts at 0
+    io_uring_buf* slots = reinterpret_cast<io_uring_buf*>(bufferRing);
+    io_uring_buf& slot = slots[bufferTail & (bufferCount - 1)];
+    slot.addr = reinterpret_cast<uint64_t>(bufferData(id));
+    slot.len = bufferSize;
+    slot.bid = id;
+    bufferTail++;
+    __atomic_store_n(&bufferRing->tail, bufferTail, __ATOMIC_RELEASE);
+}
+
+#endif // ELECTION_HAVE_IO_URING
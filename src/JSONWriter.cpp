@@ -0,0 +1,200 @@
+#include "../include/JSONWriter.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+namespace {
+
+/**
+ * @brief Escape code for each byte: 0 = copy as is, 'u' = \u00XX,
+ * anything else = backslash followed by that character
+ */
+struct EscapeTable {
+    char codes[256];
+
+    EscapeTable() {
+        std::memset(codes, 0, sizeof(codes));
+        for (int c = 0; c < 0x20; c++) {
+            codes[c] = 'u';
+        }
+        codes[static_cast<unsigned char>('"')] = '"';
+        codes[static_cast<unsigned char>('\\')] = '\\';
+        codes[static_cast<unsigned char>('\b')] = 'b';
+        codes[static_cast<unsigned char>('\f')] = 'f';
+        codes[static_cast<unsigned char>('\n')] = 'n';
+        codes[static_cast<unsigned char>('\r')] = 'r';
+        codes[static_cast<unsigned char>('\t')] = 't';
+    }
+};
+
+const EscapeTable ESCAPES;
+
+/**
+ * @brief Whether any of 8 bytes is '"', '\\' or below 0x20
+ *
+ * Word-at-a-time check; it may report a false positive after a matching
+ * byte but never misses one, so clean words can be skipped safely.
+ */
+inline bool mayNeedEscape(uint64_t word) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    uint64_t quote = word ^ (ones * '"');
+    uint64_t backslash = word ^ (ones * '\\');
+    uint64_t found = ((quote - ones) & ~quote) |
+                     ((backslash - ones) & ~backslash) |
+                     ((word - ones * 0x20) & ~word);
+    return (found & highs) != 0;
+}
+
+} // namespace
+
+JSONWriter::JSONWriter(std::string& out) : out(out), needComma(false) {
+}
+
+void JSONWriter::separator() {
+    if (needComma) {
+        out += ',';
+    }
+    needComma = true;
+}
+
+JSONWriter& JSONWriter::beginObject() {
+    separator();
+    out += '{';
+    needComma = false;
+    return *this;
+}
+
+JSONWriter& JSONWriter::endObject() {
+    out += '}';
+    needComma = true;
+    return *this;
+}
+
+JSONWriter& JSONWriter::beginArray() {
+    separator();
+    out += '[';
+    needComma = false;
+    return *this;
+}
+
+JSONWriter& JSONWriter::endArray() {
+    out += ']';
+    needComma = true;
+    return *this;
+}
+
+JSONWriter& JSONWriter::key(const char* name) {
+    separator();
+    escape(out, name, std::strlen(name));
+    out += ':';
+    needComma = false;
+    return *this;
+}
+
+JSONWriter& JSONWriter::key(const std::string& name) {
+    separator();
+    escape(out, name.data(), name.length());
+    out += ':';
+    needComma = false;
+    return *this;
+}
+
+JSONWriter& JSONWriter::value(const std::string& text) {
+    separator();
+    escape(out, text.data(), text.length());
+    return *this;
+}
+
+JSONWriter& JSONWriter::value(const char* text) {
+    separator();
+    escape(out, text, std::strlen(text));
+    return *this;
+}
+
+JSONWriter& JSONWriter::value(bool flag) {
+    separator();
+    out += flag ? "true" : "false";
+    return *this;
+}
+
+template <typename T>
+JSONWriter& JSONWriter::integer(T number) {
+    separator();
+    char buffer[24];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out.append(buffer, result.ptr);
+    return *this;
+}
+
+JSONWriter& JSONWriter::value(int number) { return integer(number); }
+JSONWriter& JSONWriter::value(long number) { return integer(number); }
+JSONWriter& JSONWriter::value(long long number) { return integer(number); }
+JSONWriter& JSONWriter::value(unsigned long number) { return integer(number); }
+JSONWriter& JSONWriter::value(unsigned long long number) { return integer(number); }
+
+// Shortest representation that reads back as the same double
+JSONWriter& JSONWriter::value(double number) {
+    if (!std::isfinite(number)) {
+        return null();
+    }
+
+    separator();
+    char buffer[32];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out.append(buffer, result.ptr);
+    return *this;
+}
+
+JSONWriter& JSONWriter::null() {
+    separator();
+    out += "null";
+    return *this;
+}
+
+JSONWriter& JSONWriter::raw(const std::string& encoded) {
+    separator();
+    out += encoded;
+    return *this;
+}
+
+// Copy runs of safe bytes in one append; only escaped bytes are handled singly
+void JSONWriter::escape(std::string& out, const char* text, size_t length) {
+    static const char HEX[] = "0123456789abcdef";
+
+    out += '"';
+    size_t runStart = 0;
+    size_t i = 0;
+    while (i < length) {
+        // Fast path: skip 8 clean bytes at a time
+        if (i + 8 <= length) {
+            uint64_t word;
+            std::memcpy(&word, text + i, 8);
+            if (!mayNeedEscape(word)) {
+                i += 8;
+                continue;
+            }
+        }
+
+        char code = ESCAPES.codes[static_cast<unsigned char>(text[i])];
+        if (code == 0) {
+            i++;
+            continue;
+        }
+
+        out.append(text + runStart, i - runStart);
+        if (code == 'u') {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            char sequence[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF]};
+            out.append(sequence, 6);
+        } else {
+            char sequence[2] = {'\\', code};
+            out.append(sequence, 2);
+        }
+        i++;
+        runStart = i;
+    }
+    out.append(text + runStart, length - runStart);
+    out += '"';
+}
@@ -0,0 +1,210 @@
+#include "../include/LiveHub.h"
+#include "../include/JSONWriter.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Events a subscriber may have waiting before it is dropped as too slow
+const size_t MAX_QUEUED_EVENTS = 1024;
+
+// Wrap a JSON payload as one SSE event
+std::shared_ptr<const std::string> makeEvent(const char* name, const std::string& json) {
+    auto event = std::make_shared<std::string>();
+    event->reserve(json.length() + 32);
+    *event += "event: ";
+    *event += name;
+    *event += "\ndata: ";
+    *event += json;
+    *event += "\n\n";
+    return event;
+}
+
+double voteShare(long long votes, long long totalVotes) {
+    return totalVotes > 0 ? (votes * 100.0) / totalVotes : 0.0;
+}
+
+} // namespace
+
+LiveSubscription::LiveSubscription(const std::string& country, int year)
+    : country(country), year(year), closed(false) {
+}
+
+bool LiveSubscription::take(std::deque<std::shared_ptr<const std::string>>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!events.empty()) {
+        out.push_back(std::move(events.front()));
+        events.pop_front();
+    }
+    return !closed;
+}
+
+void LiveSubscription::wait(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex);
+    ready.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return closed || !events.empty(); });
+}
+
+void LiveSubscription::setWake(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    wake = std::move(callback);
+}
+
+void LiveSubscription::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        if (wake) wake();
+    }
+    ready.notify_all();
+}
+
+void LiveSubscription::push(const std::shared_ptr<const std::string>& event) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed) return;
+        if (events.size() >= MAX_QUEUED_EVENTS) {
+            // Not reading; better to drop it than to buffer every delta
+            closed = true;
+            events.clear();
+        } else {
+            events.push_back(event);
+        }
+        // Under the lock, so setWake(nullptr) waits for a call in progress
+        if (wake) wake();
+    }
+    ready.notify_one();
+}
+
+LiveHub::LiveHub(std::shared_ptr<ElectionData> data) : data(std::move(data)), subscriberTotal(0), published(0) {
+}
+
+void LiveHub::setData(std::shared_ptr<ElectionData> fresh) {
+    std::lock_guard<std::mutex> lock(mutex);
+    data = std::move(fresh);
+    for (auto& pair : subscribers) {
+        std::shared_ptr<const std::string> event =
+            makeEvent("snapshot", buildSnapshot(pair.first.first, pair.first.second));
+        for (size_t i = 0; i < pair.second.size(); i++) {
+            pair.second[i]->push(event);
+        }
+    }
+}
+
+std::shared_ptr<LiveSubscription> LiveHub::subscribe(const std::string& country, int year) {
+    auto subscription = std::make_shared<LiveSubscription>(country, year);
+
+    // Deltas carry absolute totals, so one that races the snapshot is harmless
+    std::lock_guard<std::mutex> lock(mutex);
+    subscription->push(makeEvent("snapshot", buildSnapshot(country, year)));
+    subscribers[ElectionKey(country, year)].push_back(subscription);
+    subscriberTotal++;
+    return subscription;
+}
+
+void LiveHub::unsubscribe(const std::shared_ptr<LiveSubscription>& subscription) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = subscribers.find(ElectionKey(subscription->getCountry(), subscription->getYear()));
+    if (it == subscribers.end()) {
+        return;
+    }
+
+    std::vector<std::shared_ptr<LiveSubscription>>& list = it->second;
+    auto position = std::find(list.begin(), list.end(), subscription);
+    if (position != list.end()) {
+        list.erase(position);
+        subscriberTotal--;
+    }
+    if (list.empty()) {
+        subscribers.erase(it);
+    }
+}
+
+void LiveHub::publish(const ElectionRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = subscribers.find(ElectionKey(record.country, record.year));
+    if (it == subscribers.end()) {
+        return;
+    }
+
+    CubeSlice slice;
+    slice.country = record.country;
+    slice.year = record.year;
+    CubeCell election = data->getCubeTotal(slice);
+    slice.party = record.party;
+    CubeCell party = data->getCubeTotal(slice);
+
+    std::string json;
+    JSONWriter writer(json);
+    writer.beginObject();
+    writer.field("party", record.party);
+    writer.field("votes", party.votes);
+    writer.field("seats", party.seats);
+    // No vote share: a new total moves every party's share, not just this
+    // one's, so clients derive shares from the votes they hold
+    writer.field("totalVotes", election.votes);
+    writer.field("totalSeats", election.seats);
+    if (record.elected) {
+        writer.key("declared").beginObject();
+        writer.field("constituency", record.constituency);
+        writer.field("candidate", record.candidate);
+        writer.endObject();
+    }
+    writer.endObject();
+
+    // Serialized once, shared by every subscriber
+    std::shared_ptr<const std::string> event = makeEvent("delta", json);
+    for (size_t i = 0; i < it->second.size(); i++) {
+        it->second[i]->push(event);
+    }
+    published++;
+}
+
+void LiveHub::closeAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& pair : subscribers) {
+        for (size_t i = 0; i < pair.second.size(); i++) {
+            pair.second[i]->close();
+        }
+    }
+    subscribers.clear();
+    subscriberTotal = 0;
+}
+
+size_t LiveHub::subscriberCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return subscriberTotal;
+}
+
+long long LiveHub::eventsPublished() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return published;
+}
+
+// Current totals of every party, for clients to apply deltas to
+std::string LiveHub::buildSnapshot(const std::string& country, int year) {
+    CubeSlice slice;
+    slice.country = country;
+    slice.year = year;
+    CubeCell election = data->getCubeTotal(slice);
+    std::vector<CubeCell> parties = data->queryCube(ElectionCube::Party, slice);
+
+    std::string json;
+    JSONWriter writer(json);
+    writer.beginObject();
+    writer.field("country", country);
+    writer.field("year", year);
+    writer.field("totalVotes", election.votes);
+    writer.field("totalSeats", election.seats);
+    writer.key("parties").beginArray();
+    for (size_t i = 0; i < parties.size(); i++) {
+        writer.beginObject();
+        writer.field("party", parties[i].party);
+        writer.field("votes", parties[i].votes);
+        writer.field("seats", parties[i].seats);
+        writer.field("voteShare", voteShare(parties[i].votes, election.votes));
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+    return json;
+}
@@ -0,0 +1,237 @@
+#include "../include/OutputQueue.h"
+#include <cstring>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+#else
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+    #include <errno.h>
+#endif
+#ifdef __linux__
+    #include <sys/sendfile.h>
+#endif
+
+namespace {
+
+// Strings shorter than this are merged into the previous owned segment
+const size_t MERGE_LIMIT = 4096;
+
+// Memory segments gathered into one sendmsg call
+const size_t MAX_IOVECS = 64;
+
+} // namespace
+
+#ifdef __linux__
+SharedFile::~SharedFile() {
+    close(fd);
+}
+#endif
+
+OutputQueue::OutputQueue() : pendingBytes(0) {
+}
+
+void OutputQueue::append(std::string&& data) {
+    if (data.empty()) {
+        return;
+    }
+    pendingBytes += data.length();
+
+    // Pipelined small responses go out as one segment instead of many
+    if (data.length() < MERGE_LIMIT && !segments.empty()) {
+        Segment& last = segments.back();
+        bool isOwned = last.data == nullptr && !last.stream;
+#ifdef __linux__
+        isOwned = isOwned && !last.file;
+#endif
+        if (isOwned) {
+            last.owned += data;
+            last.length = last.owned.length();
+            return;
+        }
+    }
+
+    segments.emplace_back();
+    Segment& segment = segments.back();
+    segment.owned = std::move(data);
+    segment.length = segment.owned.length();
+}
+
+void OutputQueue::append(const char* data, size_t length) {
+    append(std::string(data, length));
+}
+
+void OutputQueue::appendShared(const char* data, size_t length, std::shared_ptr<const void> owner) {
+    if (length == 0) {
+        return;
+    }
+    pendingBytes += length;
+
+    segments.emplace_back();
+    Segment& segment = segments.back();
+    segment.data = data;
+    segment.length = length;
+    segment.owner = std::move(owner);
+}
+
+#ifdef __linux__
+void OutputQueue::appendFile(std::shared_ptr<SharedFile> file, size_t offset, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    pendingBytes += length;
+
+    segments.emplace_back();
+    Segment& segment = segments.back();
+    segment.length = length;
+    segment.file = std::move(file);
+    segment.fileStart = offset;
+}
+#endif
+
+void OutputQueue::appendStream(std::function<bool(std::string&)> produce) {
+    segments.emplace_back();
+    segments.back().stream = std::move(produce);
+}
+
+void OutputQueue::clear() {
+    segments.clear();
+    pendingBytes = 0;
+}
+
+// Drop written bytes from the front
+void OutputQueue::consume(size_t bytes) {
+    pendingBytes -= bytes;
+    while (bytes > 0) {
+        Segment& front = segments.front();
+        size_t remaining = front.length - front.offset;
+        if (bytes < remaining) {
+            front.offset += bytes;
+            return;
+        }
+        bytes -= remaining;
+        segments.pop_front();
+    }
+}
+
+// Replace the stream at the front with its next piece, keeping the stream
+// behind it until it reports the last one
+void OutputQueue::produce() {
+    std::string piece;
+    bool more = segments.front().stream(piece);
+    if (!more) {
+        segments.pop_front();
+    }
+    if (!piece.empty()) {
+        pendingBytes += piece.length();
+        segments.emplace_front();
+        Segment& segment = segments.front();
+        segment.owned = std::move(piece);
+        segment.length = segment.owned.length();
+    }
+}
+
+#ifdef __linux__
+size_t OutputQueue::gather(iovec* iov, size_t maxCount, bool& all) {
+    while (!segments.empty() && segments.front().stream) {
+        produce();
+    }
+
+    size_t count = 0;
+    size_t bytes = 0;
+    for (auto it = segments.begin(); it != segments.end() && count < maxCount; ++it) {
+        if (it->stream || it->file) break;
+        iov[count].iov_base = const_cast<char*>(it->bytes() + it->offset);
+        iov[count].iov_len = it->length - it->offset;
+        bytes += iov[count].iov_len;
+        count++;
+    }
+    all = count == segments.size() && bytes == pendingBytes;
+    return count;
+}
+#endif
+
+#ifdef _WIN32
+
+// No gathered writes for sockets here; send segment by segment
+OutputQueue::FlushResult OutputQueue::flush(SocketHandle sock) {
+    while (!segments.empty()) {
+        if (segments.front().stream) {
+            produce();
+            continue;
+        }
+        const Segment& front = segments.front();
+        int n = send(sock, front.bytes() + front.offset, static_cast<int>(front.length - front.offset), 0);
+        if (n > 0) {
+            consume(n);
+        } else if (WSAGetLastError() == WSAEWOULDBLOCK) {
+            return FlushResult::WouldBlock;
+        } else {
+            return FlushResult::Error;
+        }
+    }
+    return FlushResult::Done;
+}
+
+#else
+
+OutputQueue::FlushResult OutputQueue::flush(SocketHandle sock) {
+    while (!segments.empty()) {
+        if (segments.front().stream) {
+            produce();
+            continue;
+        }
+        ssize_t n;
+
+#ifdef __linux__
+        Segment& front = segments.front();
+        if (front.file) {
+            off_t position = static_cast<off_t>(front.fileStart + front.offset);
+            n = sendfile(sock, front.file->fd, &position, front.length - front.offset);
+            if (n == 0) {
+                // File shrank after it was queued; the response can't be completed
+                return FlushResult::Error;
+            }
+        } else
+#endif
+        {
+            // Gather consecutive memory segments into one call
+            iovec iov[MAX_IOVECS];
+            size_t count = 0;
+            for (auto it = segments.begin(); it != segments.end() && count < MAX_IOVECS; ++it) {
+                if (it->stream) break;
+#ifdef __linux__
+                if (it->file) break;
+#endif
+                iov[count].iov_base = const_cast<char*>(it->bytes() + it->offset);
+                iov[count].iov_len = it->length - it->offset;
+                count++;
+            }
+
+            // sendmsg rather than writev so a closed peer can't raise SIGPIPE
+            msghdr message;
+            std::memset(&message, 0, sizeof(message));
+            message.msg_iov = iov;
+            message.msg_iovlen = count;
+#ifdef MSG_NOSIGNAL
+            n = sendmsg(sock, &message, MSG_NOSIGNAL);
+#else
+            n = sendmsg(sock, &message, 0);
+#endif
+        }
+
+        if (n > 0) {
+            consume(static_cast<size_t>(n));
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return FlushResult::WouldBlock;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return FlushResult::Error;
+        }
+    }
+    return FlushResult::Done;
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include "../include/QuantileSketch.h"
+#include <cmath>
+
+QuantileSketch::QuantileSketch(double relativeAccuracy) {
+    gamma = (1.0 + relativeAccuracy) / (1.0 - relativeAccuracy);
+    logGamma = std::log(gamma);
+    zeroCount = 0;
+    totalCount = 0;
+    minValue = 0.0;
+    maxValue = 0.0;
+}
+
+// Bucket i holds values in (gamma^(i-1), gamma^i]
+int QuantileSketch::bucketIndex(double value) const {
+    return static_cast<int>(std::ceil(std::log(value) / logGamma));
+}
+
+// Representative value of a bucket (relative error is smallest here)
+double QuantileSketch::bucketValue(int index) const {
+    return 2.0 * std::pow(gamma, index) / (gamma + 1.0);
+}
+
+// Add one value to the sketch
+void QuantileSketch::add(double value) {
+    if (value < 0) {
+        value = 0;
+    }
+
+    if (totalCount == 0) {
+        minValue = value;
+        maxValue = value;
+    } else {
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+    }
+    totalCount++;
+
+    if (value == 0) {
+        zeroCount++;
+    } else {
+        buckets[bucketIndex(value)]++;
+    }
+}
+
+// Merge another sketch into this one
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.totalCount == 0) {
+        return;
+    }
+
+    if (totalCount == 0) {
+        minValue = other.minValue;
+        maxValue = other.maxValue;
+    } else {
+        if (other.minValue < minValue) minValue = other.minValue;
+        if (other.maxValue > maxValue) maxValue = other.maxValue;
+    }
+
+    totalCount += other.totalCount;
+    zeroCount += other.zeroCount;
+    for (const auto& bucket : other.buckets) {
+        buckets[bucket.first] += bucket.second;
+    }
+}
+
+// Walk the buckets until the requested rank is reached
+double QuantileSketch::quantile(double q) const {
+    if (totalCount == 0) {
+        return 0.0;
+    }
+    if (q <= 0) return minValue;
+    if (q >= 1) return maxValue;
+
+    double rank = std::ceil(q * (totalCount - 1));
+    long long seen = zeroCount;
+    if (seen > rank) {
+        return 0.0;
+    }
+
+    for (const auto& bucket : buckets) {
+        seen += bucket.second;
+        if (seen > rank) {
+            double estimate = bucketValue(bucket.first);
+            if (estimate < minValue) return minValue;
+            if (estimate > maxValue) return maxValue;
+            return estimate;
+        }
+    }
+
+    return maxValue;
+}
+
+// Spread the bucket counts over equal-width bins
+std::vector<HistogramBin> QuantileSketch::histogram(int bins) const {
+    std::vector<HistogramBin> result;
+    if (totalCount == 0 || bins <= 0) {
+        return result;
+    }
+
+    if (maxValue == minValue) {
+        bins = 1;
+    }
+
+    double width = (maxValue - minValue) / bins;
+    for (int i = 0; i < bins; i++) {
+        HistogramBin bin;
+        bin.lower = minValue + i * width;
+        bin.upper = (i == bins - 1) ? maxValue : minValue + (i + 1) * width;
+        bin.count = 0;
+        result.push_back(bin);
+    }
+
+    result[0].count += zeroCount;
+    for (const auto& bucket : buckets) {
+        int index = 0;
+        if (width > 0) {
+            index = static_cast<int>((bucketValue(bucket.first) - minValue) / width);
+        }
+        if (index < 0) index = 0;
+        if (index >= bins) index = bins - 1;
+        result[index].count += bucket.second;
+    }
+
+    return result;
+}
+
+// Clear all values
+void QuantileSketch::clear() {
+    zeroCount = 0;
+    totalCount = 0;
+    minValue = 0.0;
+    maxValue = 0.0;
+    buckets.clear();
+}
@@ -0,0 +1,56 @@
+#include "../include/RecordStore.h"
+
+RecordStore::RecordStore() : committed(0) {
+    for (int i = 0; i < MAX_CHUNKS; i++) {
+        chunks[i] = nullptr;
+    }
+}
+
+RecordStore::~RecordStore() {
+    clear();
+}
+
+// Chunk k starts at FIRST_CHUNK * (2^k - 1)
+void RecordStore::locate(size_t index, int& chunk, size_t& offset) {
+    size_t block = index / FIRST_CHUNK + 1;
+    chunk = 0;
+    while (block > 1) {
+        block >>= 1;
+        chunk++;
+    }
+    offset = index - FIRST_CHUNK * ((static_cast<size_t>(1) << chunk) - 1);
+}
+
+void RecordStore::append(const ElectionRecord& record) {
+    // Only the writer changes the count, so a relaxed load is enough here
+    size_t index = committed.load(std::memory_order_relaxed);
+    int chunk;
+    size_t offset;
+    locate(index, chunk, offset);
+    if (!chunks[chunk]) {
+        chunks[chunk] = new ElectionRecord[FIRST_CHUNK << chunk];
+    }
+    chunks[chunk][offset] = record;
+
+    // Readers that see the new count also see the record and its chunk
+    committed.store(index + 1, std::memory_order_release);
+}
+
+size_t RecordStore::size() const {
+    return committed.load(std::memory_order_acquire);
+}
+
+const ElectionRecord& RecordStore::operator[](size_t index) const {
+    int chunk;
+    size_t offset;
+    locate(index, chunk, offset);
+    return chunks[chunk][offset];
+}
+
+void RecordStore::clear() {
+    committed.store(0, std::memory_order_release);
+    for (int i = 0; i < MAX_CHUNKS; i++) {
+        delete[] chunks[i];
+        chunks[i] = nullptr;
+    }
+}
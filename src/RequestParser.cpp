@@ -0,0 +1,184 @@
+#include "../include/RequestParser.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+RequestParser::RequestParser(BufferPool* pool, size_t maxHeaderSize, size_t maxBodySize)
+    : pool(pool), buffer(nullptr), maxHeaderSize(maxHeaderSize), maxBodySize(maxBodySize),
+      start(0), length(0), scanned(0), headerDone(false), bodyStart(0), bodyLength(0) {
+}
+
+RequestParser::~RequestParser() {
+    releaseBuffer();
+}
+
+void RequestParser::releaseBuffer() {
+    if (buffer != nullptr) {
+        pool->release(buffer);
+        buffer = nullptr;
+    }
+    start = 0;
+    length = 0;
+    scanned = 0;
+}
+
+// Make room at the end, first by dropping consumed bytes, then by growing
+char* RequestParser::prepare(size_t minimum) {
+    if (buffer == nullptr) {
+        buffer = pool->acquire();
+    }
+
+    if (buffer->size() - length < minimum && start > 0) {
+        std::memmove(buffer->data(), buffer->data() + start, length - start);
+        length -= start;
+        scanned -= start;
+        if (headerDone) {
+            bodyStart -= start;
+        }
+        start = 0;
+    }
+
+    if (buffer->size() - length < minimum) {
+        buffer->resize(std::max(length + minimum, buffer->size() * 2));
+    }
+
+    return buffer->data() + length;
+}
+
+size_t RequestParser::space() const {
+    return buffer == nullptr ? 0 : buffer->size() - length;
+}
+
+void RequestParser::commit(size_t size) {
+    length += size;
+}
+
+RequestParser::Status RequestParser::fail(const std::string& status) {
+    error = status;
+    return Status::Error;
+}
+
+RequestParser::Status RequestParser::next(HTTPRequest& request) {
+    if (!error.empty()) {
+        return Status::Error;
+    }
+
+    if (!headerDone) {
+        if (buffer == nullptr || start == length) {
+            releaseBuffer();
+            return Status::Incomplete;
+        }
+
+        // Resume a little before where the last search stopped, in case
+        // the terminator was split across reads
+        static const char terminator[] = "\r\n\r\n";
+        const char* data = buffer->data();
+        size_t from = scanned > start + 3 ? scanned - 3 : start;
+        const char* found = std::search(data + from, data + length, terminator, terminator + 4);
+
+        if (found == data + length) {
+            scanned = length;
+            if (length - start > maxHeaderSize) {
+                return fail("431 Request Header Fields Too Large");
+            }
+            return Status::Incomplete;
+        }
+
+        size_t headerEnd = found - data;
+        if (headerEnd - start > maxHeaderSize) {
+            return fail("431 Request Header Fields Too Large");
+        }
+        if (!parseHeader(data + start, data + headerEnd)) {
+            return Status::Error;
+        }
+
+        headerDone = true;
+        bodyStart = headerEnd + 4;
+    }
+
+    if (length - bodyStart < bodyLength) {
+        return Status::Incomplete;
+    }
+
+    pending.body.assign(buffer->data() + bodyStart, bodyLength);
+    // Swapping hands the caller's old strings back for reuse next time
+    std::swap(request, pending);
+
+    headerDone = false;
+    start = bodyStart + bodyLength;
+    scanned = start;
+    if (start == length) {
+        releaseBuffer();
+    }
+    return Status::Complete;
+}
+
+// Parse the request line and headers (header names are lowercased)
+bool RequestParser::parseHeader(const char* begin, const char* end) {
+    pending.method.clear();
+    pending.path.clear();
+    pending.version.clear();
+    pending.headers.clear();
+    pending.body.clear();
+    bodyLength = 0;
+
+    const char* lineEnd = std::search(begin, end, "\r\n", "\r\n" + 2);
+
+    // Request line: METHOD SP PATH SP VERSION
+    const char* methodEnd = std::find(begin, lineEnd, ' ');
+    const char* pathBegin = methodEnd == lineEnd ? lineEnd : methodEnd + 1;
+    const char* pathEnd = std::find(pathBegin, lineEnd, ' ');
+    const char* versionBegin = pathEnd == lineEnd ? lineEnd : pathEnd + 1;
+
+    pending.method.assign(begin, methodEnd);
+    pending.path.assign(pathBegin, pathEnd);
+    pending.version.assign(versionBegin, lineEnd);
+    if (pending.method.empty() || pending.path.empty()) {
+        error = "400 Bad Request";
+        return false;
+    }
+
+    const char* line = lineEnd == end ? end : lineEnd + 2;
+    while (line < end) {
+        lineEnd = std::search(line, end, "\r\n", "\r\n" + 2);
+        const char* colon = std::find(line, lineEnd, ':');
+
+        if (colon != lineEnd) {
+            std::string name(line, colon);
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+            const char* valueBegin = colon + 1;
+            const char* valueEnd = lineEnd;
+            while (valueBegin < valueEnd && (*valueBegin == ' ' || *valueBegin == '\t')) valueBegin++;
+            while (valueEnd > valueBegin && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) valueEnd--;
+
+            pending.headers[name].assign(valueBegin, valueEnd);
+        }
+
+        line = lineEnd == end ? end : lineEnd + 2;
+    }
+
+    // Chunked request bodies are not supported; clients must send a length
+    if (pending.headers.count("transfer-encoding")) {
+        error = "411 Length Required";
+        return false;
+    }
+
+    auto contentLength = pending.headers.find("content-length");
+    if (contentLength != pending.headers.end()) {
+        const std::string& value = contentLength->second;
+        if (value.empty() || value.length() > 18 ||
+            !std::all_of(value.begin(), value.end(), ::isdigit)) {
+            error = "400 Bad Request";
+            return false;
+        }
+
+        bodyLength = std::stoull(value);
+        if (bodyLength > maxBodySize) {
+            error = "413 Payload Too Large";
+            return false;
+        }
+    }
+
+    return true;
+}
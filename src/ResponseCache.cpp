@@ -0,0 +1,106 @@
+#include "../include/ResponseCache.h"
+#include <iterator>
+
+namespace {
+
+// Rough per-entry bookkeeping cost (list node, hash node, shared_ptr block)
+const size_t ENTRY_OVERHEAD = 160;
+
+} // namespace
+
+ResponseCache::ResponseCache(size_t capacityBytes)
+    : capacityBytes(capacityBytes), bytes(0), hits(0), misses(0), evictions(0) {
+}
+
+// Length-prefixed so no parameter value can make two queries collide
+std::string ResponseCache::makeKey(const std::string& endpoint, const std::map<std::string, std::string>& params) {
+    std::string key = endpoint;
+    for (const auto& pair : params) {
+        key += '\n';
+        key += std::to_string(pair.first.length());
+        key += ':';
+        key += pair.first;
+        key += std::to_string(pair.second.length());
+        key += ':';
+        key += pair.second;
+    }
+    return key;
+}
+
+std::shared_ptr<const CachedResponse> ResponseCache::find(const std::string& key, unsigned long long dataVersion) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(key);
+    if (it == index.end()) {
+        misses++;
+        return nullptr;
+    }
+
+    // Built from older data: drop it
+    if (it->second->response->dataVersion != dataVersion) {
+        erase(it->second);
+        misses++;
+        return nullptr;
+    }
+
+    entries.splice(entries.begin(), entries, it->second);
+    hits++;
+    return entries.front().response;
+}
+
+void ResponseCache::insert(const std::string& key, std::shared_ptr<const CachedResponse> response) {
+    size_t size = key.length() + response->headers.length() + response->body.length() + ENTRY_OVERHEAD;
+    if (response->gzipped) {
+        size += response->gzipped->headers.length() + response->gzipped->body.length() + ENTRY_OVERHEAD;
+    }
+    if (size > capacityBytes) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto existing = index.find(key);
+    if (existing != index.end()) {
+        erase(existing->second);
+    }
+
+    while (bytes + size > capacityBytes && !entries.empty()) {
+        erase(std::prev(entries.end()));
+        evictions++;
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.response = std::move(response);
+    entry.bytes = size;
+    entries.push_front(std::move(entry));
+    index[key] = entries.begin();
+    bytes += size;
+}
+
+void ResponseCache::erase(std::list<Entry>::iterator it) {
+    bytes -= it->bytes;
+    index.erase(it->key);
+    entries.erase(it);
+}
+
+ResponseCacheStats ResponseCache::getStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    ResponseCacheStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.evictions = evictions;
+    stats.entries = entries.size();
+    stats.bytes = bytes;
+    stats.capacityBytes = capacityBytes;
+    stats.hitRatio = (hits + misses) > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0;
+    return stats;
+}
+
+void ResponseCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    bytes = 0;
+}
@@ -0,0 +1,141 @@
+#include "../include/SearchIndex.h"
+#include <algorithm>
+#include <set>
+
+// Lowercase letters and digits; everything else becomes a single space
+std::string SearchIndex::normalize(const std::string& str) {
+    std::string result;
+    bool lastSpace = true;
+
+    for (size_t i = 0; i < str.length(); i++) {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80) {
+            result += static_cast<char>(c);
+            lastSpace = false;
+        } else if (c >= 'A' && c <= 'Z') {
+            result += static_cast<char>(c - 'A' + 'a');
+            lastSpace = false;
+        } else if (!lastSpace) {
+            result += ' ';
+            lastSpace = true;
+        }
+    }
+
+    if (!result.empty() && result[result.length() - 1] == ' ') {
+        result.erase(result.length() - 1);
+    }
+    return result;
+}
+
+// Pad with spaces so short strings and word starts get trigrams too
+std::vector<std::string> SearchIndex::trigrams(const std::string& normalized) {
+    std::set<std::string> unique;
+    std::string padded = "  " + normalized + " ";
+
+    for (size_t i = 0; i + 3 <= padded.length(); i++) {
+        unique.insert(padded.substr(i, 3));
+    }
+
+    return std::vector<std::string>(unique.begin(), unique.end());
+}
+
+// Add one name, creating its term on first sight
+void SearchIndex::addName(SearchField field, const std::string& name, int recordId) {
+    if (name.empty()) {
+        return;
+    }
+
+    std::pair<int, std::string> key(static_cast<int>(field), name);
+    auto it = termIds.find(key);
+
+    int termId;
+    if (it == termIds.end()) {
+        termId = terms.size();
+        termIds[key] = termId;
+
+        std::vector<std::string> grams = trigrams(normalize(name));
+        for (size_t i = 0; i < grams.size(); i++) {
+            postings[grams[i]].push_back(termId);
+        }
+
+        Term term;
+        term.field = field;
+        term.name = name;
+        term.trigramCount = grams.size();
+        terms.push_back(term);
+    } else {
+        termId = it->second;
+    }
+
+    terms[termId].recordIds.push_back(recordId);
+}
+
+// Index candidate, party and constituency names of a record
+void SearchIndex::addRecord(const ElectionRecord& record, int recordId) {
+    addName(SearchField::Candidate, record.candidate, recordId);
+    addName(SearchField::Party, record.party, recordId);
+    addName(SearchField::Constituency, record.constituency, recordId);
+}
+
+// Rank terms by trigram similarity (Dice coefficient)
+std::vector<SearchMatch> SearchIndex::search(const std::string& query, int limit) const {
+    std::vector<SearchMatch> matches;
+
+    std::string normalized = normalize(query);
+    if (normalized.empty() || limit <= 0) {
+        return matches;
+    }
+    std::vector<std::string> grams = trigrams(normalized);
+
+    // Count shared trigrams per term
+    std::unordered_map<int, int> hits;
+    for (size_t i = 0; i < grams.size(); i++) {
+        auto it = postings.find(grams[i]);
+        if (it == postings.end()) {
+            continue;
+        }
+        for (int termId : it->second) {
+            hits[termId]++;
+        }
+    }
+
+    // Rank term ids first, so only the kept matches copy their record ids
+    std::vector<std::pair<double, int>> ranked;
+    for (const auto& pair : hits) {
+        const Term& term = terms[pair.first];
+
+        // Require at least half of the query to be present
+        if (pair.second * 2 < static_cast<int>(grams.size())) {
+            continue;
+        }
+        ranked.push_back(std::make_pair((2.0 * pair.second) / (grams.size() + term.trigramCount), pair.first));
+    }
+
+    size_t kept = std::min(ranked.size(), static_cast<size_t>(limit));
+    std::partial_sort(ranked.begin(), ranked.begin() + kept, ranked.end(),
+                      [this](const std::pair<double, int>& a, const std::pair<double, int>& b) {
+        const Term& termA = terms[a.second];
+        const Term& termB = terms[b.second];
+        if (a.first != b.first) return a.first > b.first;
+        if (termA.recordIds.size() != termB.recordIds.size()) return termA.recordIds.size() > termB.recordIds.size();
+        return termA.name < termB.name;
+    });
+
+    for (size_t i = 0; i < kept; i++) {
+        const Term& term = terms[ranked[i].second];
+        SearchMatch match;
+        match.field = term.field;
+        match.name = term.name;
+        match.score = ranked[i].first;
+        match.recordIds = term.recordIds;
+        matches.push_back(match);
+    }
+    return matches;
+}
+
+// Clear the index
+void SearchIndex::clear() {
+    terms.clear();
+    termIds.clear();
+    postings.clear();
+}
@@ -0,0 +1,285 @@
+#include "../include/ServerMetrics.h"
+#include <cstring>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+// Prometheus histogram bounds, in seconds
+const double BUCKET_BOUNDS[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+                                0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+int highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1) bit++;
+    return bit;
+#endif
+}
+
+void appendNumber(std::string& out, double value) {
+    char buffer[32];
+    int length = std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    out.append(buffer, length);
+}
+
+void appendNumber(std::string& out, uint64_t value) {
+    out += std::to_string(value);
+}
+
+void appendHeader(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+// name{endpoint="..."[,extra]} value
+template <typename T>
+void appendSample(std::string& out, const char* name, const char* suffix, const char* endpoint,
+                  const std::string& extraLabel, T value) {
+    out += name;
+    out += suffix;
+    out += "{endpoint=\"";
+    out += endpoint;
+    out += '"';
+    if (!extraLabel.empty()) {
+        out += ',';
+        out += extraLabel;
+    }
+    out += "} ";
+    appendNumber(out, value);
+    out += '\n';
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() : sum(0) {
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        buckets[i] = 0;
+    }
+}
+
+// Linear below SUB_BUCKETS units, then SUB_BUCKETS buckets per power of two
+int LatencyHistogram::bucketFor(uint64_t units) {
+    if (units < SUB_BUCKETS) {
+        return static_cast<int>(units);
+    }
+    if (units >= (static_cast<uint64_t>(1) << MAX_BITS)) {
+        return BUCKET_COUNT - 1;
+    }
+    int shift = highestBit(units) - SUB_BITS;
+    int sub = static_cast<int>((units >> shift) & (SUB_BUCKETS - 1));
+    return (shift + 1) * SUB_BUCKETS + sub;
+}
+
+// Largest value, in nanoseconds, that lands in a bucket
+uint64_t LatencyHistogram::upperBound(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return ((static_cast<uint64_t>(bucket) + 1) << UNIT_SHIFT) - 1;
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    uint64_t sub = bucket % SUB_BUCKETS;
+    uint64_t firstUnit = (SUB_BUCKETS + sub) << shift;
+    return ((firstUnit + (static_cast<uint64_t>(1) << shift)) << UNIT_SHIFT) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+    buckets[bucketFor(nanos >> UNIT_SHIFT)].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(nanos, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t result = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        result += buckets[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+uint64_t LatencyHistogram::countAtMost(uint64_t limitNanos) const {
+    uint64_t result = 0;
+    for (int i = 0; i < BUCKET_COUNT && upperBound(i) <= limitNanos; i++) {
+        result += buckets[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+uint64_t LatencyHistogram::quantile(double q) const {
+    // Buckets are read one by one, so the total is recounted to match them
+    uint64_t counts[BUCKET_COUNT];
+    uint64_t recorded = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        recorded += counts[i];
+    }
+    if (recorded == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(q * recorded);
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += counts[i];
+        if (seen > rank) {
+            return upperBound(i);
+        }
+    }
+    return upperBound(BUCKET_COUNT - 1);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        buckets[i].fetch_add(other.buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    sum.fetch_add(other.sumNanos(), std::memory_order_relaxed);
+}
+
+const char* const ServerMetrics::ENDPOINT_NAMES[ENDPOINT_COUNT] = {
+    "/api/countries", "/api/stats", "/api/compare", "/api/top-candidates",
+    "/api/dashboard", "/api/distribution", "/api/search", "/api/candidate-history",
+    "/api/incumbency", "/api/cube", "/api/server-stats", "/api/records",
+    "/api/live", "/api/batch", "/api/admin/reload", "/api/admin/trace",
+    "/metrics", "other", "static"
+};
+
+ServerMetrics::ServerMetrics() : shards(new Shard[SHARD_COUNT]) {
+}
+
+// Threads are dealt shards in turn the first time they record
+ServerMetrics::EndpointMetrics& ServerMetrics::localSlot(int endpoint) {
+    static std::atomic<int> nextShard(0);
+    static thread_local int shard = nextShard.fetch_add(1) % SHARD_COUNT;
+    return shards[shard].endpoints[endpoint];
+}
+
+int ServerMetrics::endpointIndex(const std::string& path) {
+    const int other = ENDPOINT_COUNT - 2;
+    const int staticFiles = ENDPOINT_COUNT - 1;
+
+    static const std::vector<size_t> nameLengths = [] {
+        std::vector<size_t> lengths;
+        for (int i = 0; i < ENDPOINT_COUNT; i++) {
+            lengths.push_back(std::strlen(ENDPOINT_NAMES[i]));
+        }
+        return lengths;
+    }();
+
+    // Runs for every request, so names are only compared when the length matches
+    size_t length = path.find('?');
+    if (length == std::string::npos) length = path.length();
+    for (int i = 0; i < other; i++) {
+        if (nameLengths[i] == length && std::memcmp(path.data(), ENDPOINT_NAMES[i], length) == 0) {
+            return i;
+        }
+    }
+    return path.compare(0, 5, "/api/") == 0 ? other : staticFiles;
+}
+
+void ServerMetrics::recordRequest(int endpoint, uint64_t nanos, int status, size_t bytes) {
+    EndpointMetrics& metrics = localSlot(endpoint);
+    if (status >= 400) {
+        metrics.errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    metrics.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    metrics.latency.record(nanos);
+}
+
+void ServerMetrics::recordAPI(int endpoint, uint64_t computeNanos, uint64_t serializeNanos) {
+    EndpointMetrics& metrics = localSlot(endpoint);
+    metrics.computeNanos.fetch_add(computeNanos, std::memory_order_relaxed);
+    metrics.serializeNanos.fetch_add(serializeNanos, std::memory_order_relaxed);
+}
+
+// Endpoints that were never requested (or never computed) are left out
+void ServerMetrics::render(std::string& out) const {
+    // Add up the shards; recording carries on meanwhile, so totals are approximate
+    std::unique_ptr<EndpointMetrics[]> endpoints(new EndpointMetrics[ENDPOINT_COUNT]);
+    for (int i = 0; i < ENDPOINT_COUNT; i++) {
+        for (int s = 0; s < SHARD_COUNT; s++) {
+            const EndpointMetrics& slot = shards[s].endpoints[i];
+            endpoints[i].errors += slot.errors.load(std::memory_order_relaxed);
+            endpoints[i].bytes += slot.bytes.load(std::memory_order_relaxed);
+            endpoints[i].computeNanos += slot.computeNanos.load(std::memory_order_relaxed);
+            endpoints[i].serializeNanos += slot.serializeNanos.load(std::memory_order_relaxed);
+            endpoints[i].latency.merge(slot.latency);
+        }
+    }
+
+    const char* requests = "election_http_requests_total";
+    appendHeader(out, requests, "counter", "Requests answered.");
+    for (int i = 0; i < ENDPOINT_COUNT; i++) {
+        if (endpoints[i].latency.count() == 0) continue;
+        appendSample(out, requests, "", ENDPOINT_NAMES[i], "", endpoints[i].latency.count());
+    }
+
+    const char* errors = "election_http_errors_total";
+    appendHeader(out, errors, "counter", "Requests answered with a 4xx or 5xx status.");
+    for (int i = 0; i < ENDPOINT_COUNT; i++) {
+        if (endpoints[i].latency.count() == 0) continue;
+        appendSample(out, errors, "", ENDPOINT_NAMES[i], "", endpoints[i].errors.load(std::memory_order_relaxed));
+    }
+
+    const char* bytes = "election_http_response_bytes_total";
+    appendHeader(out, bytes, "counter", "Response bytes queued, excluding streamed bodies.");
+    for (int i = 0; i < ENDPOINT_COUNT; i++) {
+        if (endpoints[i].latency.count() == 0) continue;
+        appendSample(out, bytes, "", ENDPOINT_NAMES[i], "", endpoints[i].bytes.load(std::memory_order_relaxed));
+    }
+
+    const char* duration = "election_http_request_duration_seconds";
+    appendHeader(out, duration, "histogram", "Time from a parsed request to its queued response.");
+    for (int i = 0; i < ENDPOINT_COUNT; i++) {
+        const LatencyHistogram& latency = endpoints[i].latency;
+        if (latency.count() == 0) continue;
+        for (double bound : BUCKET_BOUNDS) {
+            std::string label = "le=\"";
+            appendNumber(label, bound);
+            label += '"';
+            appendSample(out, duration, "_bucket", ENDPOINT_NAMES[i], label,
+                         latency.countAtMost(static_cast<uint64_t>(bound * 1e9)));
+        }
+        appendSample(out, duration, "_bucket", ENDPOINT_NAMES[i], "le=\"+Inf\"", latency.count());
+        appendSample(out, duration, "_sum", ENDPOINT_NAMES[i], "", latency.sumNanos() / 1e9);
+        appendSample(out, duration, "_count", ENDPOINT_NAMES[i], "", latency.count());
+    }
+
+    const char* latencySummary = "election_http_request_latency_seconds";
+    appendHeader(out, latencySummary, "summary", "Request duration quantiles from the same histogram.");
+    for (int i = 0; i < ENDPOINT_COUNT; i++) {
+        const LatencyHistogram& latency = endpoints[i].latency;
+        if (latency.count() == 0) continue;
+        for (double q : QUANTILES) {
+            std::string label = "quantile=\"";
+            appendNumber(label, q);
+            label += '"';
+            appendSample(out, latencySummary, "", ENDPOINT_NAMES[i], label, latency.quantile(q) / 1e9);
+        }
+        appendSample(out, latencySummary, "_sum", ENDPOINT_NAMES[i], "", latency.sumNanos() / 1e9);
+        appendSample(out, latencySummary, "_count", ENDPOINT_NAMES[i], "", latency.count());
+    }
+
+    const char* compute = "election_api_compute_seconds_total";
+    appendHeader(out, compute, "counter", "Time spent computing API results (analyzer and indexes).");
+    for (int i = 0; i < ENDPOINT_COUNT; i++) {
+        if (endpoints[i].computeNanos + endpoints[i].serializeNanos == 0) continue;
+        appendSample(out, compute, "", ENDPOINT_NAMES[i], "",
+                     endpoints[i].computeNanos.load(std::memory_order_relaxed) / 1e9);
+    }
+
+    const char* serialize = "election_api_serialize_seconds_total";
+    appendHeader(out, serialize, "counter", "Time spent writing API results as JSON.");
+    for (int i = 0; i < ENDPOINT_COUNT; i++) {
+        if (endpoints[i].computeNanos + endpoints[i].serializeNanos == 0) continue;
+        appendSample(out, serialize, "", ENDPOINT_NAMES[i], "",
+                     endpoints[i].serializeNanos.load(std::memory_order_relaxed) / 1e9);
+    }
+}
@@ -0,0 +1,215 @@
+#include "../include/StaticAssetCache.h"
+#include "../include/Compressor.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+
+#ifdef __linux__
+    #include <fcntl.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// Served with every asset; browsers revalidate with If-None-Match each time
+static const char* CACHE_CONTROL = "no-cache";
+
+// Files at least this big are sent with sendfile rather than kept in memory
+static const size_t LARGE_ASSET_SIZE = 256 * 1024;
+
+// Weak comparison as RFC 7232 requires for If-None-Match: W/ prefixes are ignored
+bool StaticAsset::matches(const std::string& ifNoneMatch) const {
+    size_t pos = 0;
+    while (pos < ifNoneMatch.length()) {
+        size_t comma = ifNoneMatch.find(',', pos);
+        if (comma == std::string::npos) comma = ifNoneMatch.length();
+
+        size_t begin = ifNoneMatch.find_first_not_of(" \t", pos);
+        size_t end = ifNoneMatch.find_last_not_of(" \t", comma - 1);
+        if (begin != std::string::npos && begin < comma && end >= begin) {
+            std::string tag = ifNoneMatch.substr(begin, end - begin + 1);
+            if (tag.compare(0, 2, "W/") == 0) tag.erase(0, 2);
+            if (tag == "*" || tag == etag) return true;
+        }
+        pos = comma + 1;
+    }
+    return false;
+}
+
+StaticAssetCache::StaticAssetCache(const std::string& root, bool precompress)
+    : root(root), precompress(precompress), assets(std::make_shared<AssetTable>()), watching(false) {
+}
+
+StaticAssetCache::~StaticAssetCache() {
+    stopWatching();
+}
+
+std::string StaticAssetCache::getContentType(const std::string& path) {
+    // Helper function to check if string ends with suffix
+    auto endsWith = [](const std::string& str, const std::string& suffix) {
+        if (suffix.length() > str.length()) return false;
+        return str.compare(str.length() - suffix.length(), suffix.length(), suffix) == 0;
+    };
+
+    if (endsWith(path, ".html")) return "text/html";
+    if (endsWith(path, ".css")) return "text/css";
+    if (endsWith(path, ".js")) return "application/javascript";
+    if (endsWith(path, ".json")) return "application/json";
+    if (endsWith(path, ".png")) return "image/png";
+    if (endsWith(path, ".jpg") || endsWith(path, ".jpeg")) return "image/jpeg";
+    return "text/plain";
+}
+
+// Strong validator: FNV-1a hash of the contents plus the length
+static std::string computeETag(const std::string& body) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : body) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+
+    std::ostringstream tag;
+    tag << "\"" << std::hex << std::setw(16) << std::setfill('0') << hash
+        << "-" << body.length() << "\"";
+    return tag.str();
+}
+
+// Status lines and headers of both responses for an asset
+static void buildHeaders(StaticAsset& asset, const std::string& extraHeaders) {
+    std::ostringstream ok;
+    ok << "HTTP/1.1 200 OK\r\n"
+       << "Content-Type: " << asset.contentType << "\r\n"
+       << extraHeaders
+       << "ETag: " << asset.etag << "\r\n"
+       << "Cache-Control: " << CACHE_CONTROL << "\r\n"
+       << "Content-Length: " << asset.size << "\r\n";
+    asset.okHeaders = ok.str();
+
+    std::ostringstream notModified;
+    notModified << "HTTP/1.1 304 Not Modified\r\n"
+                << extraHeaders
+                << "ETag: " << asset.etag << "\r\n"
+                << "Cache-Control: " << CACHE_CONTROL << "\r\n";
+    asset.notModifiedHeaders = notModified.str();
+}
+
+// Cheap fingerprint of the directory: every file's name, size and mtime
+std::string StaticAssetCache::scanSignature() const {
+    std::ostringstream signature;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+        signature << it->path().generic_string() << ':' << it->file_size(ec) << ':'
+                  << it->last_write_time(ec).time_since_epoch().count() << '\n';
+    }
+    return signature.str();
+}
+
+void StaticAssetCache::load() {
+    std::string current = scanSignature();
+    auto table = std::make_shared<AssetTable>();
+    Compressor compressor(9);
+
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+
+        std::ifstream file(it->path(), std::ios::binary);
+        if (!file.is_open()) continue;
+        std::ostringstream contents;
+        contents << file.rdbuf();
+
+        std::string path = "/" + it->path().lexically_relative(root).generic_string();
+
+        auto asset = std::make_shared<StaticAsset>();
+        asset->contentType = getContentType(path);
+        asset->body = contents.str();
+        asset->etag = computeETag(asset->body);
+        asset->size = asset->body.length();
+
+        // Compressed once here, never per request; kept only if it saves space
+        std::string vary;
+        if (precompress && Compressor::compressible(asset->contentType)) {
+            auto gzipped = std::make_shared<StaticAsset>();
+            if (compressor.gzip(asset->body.data(), asset->body.length(), gzipped->body) &&
+                gzipped->body.length() < asset->body.length()) {
+                // A different representation needs a different strong ETag
+                gzipped->contentType = asset->contentType;
+                gzipped->size = gzipped->body.length();
+                gzipped->etag = asset->etag.substr(0, asset->etag.length() - 1) + "-gzip\"";
+                buildHeaders(*gzipped, "Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n");
+                asset->gzipped = gzipped;
+                vary = "Vary: Accept-Encoding\r\n";
+            }
+        }
+
+#ifdef __linux__
+        if (asset->size >= LARGE_ASSET_SIZE) {
+            int fd = open(it->path().c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd >= 0) {
+                asset->file = std::make_shared<SharedFile>(fd);
+                asset->body.clear();
+                asset->body.shrink_to_fit();
+            }
+        }
+#endif
+
+        buildHeaders(*asset, vary);
+        (*table)[path] = asset;
+    }
+
+    signature = current;
+    std::shared_ptr<const AssetTable> snapshot = table;
+    std::atomic_store(&assets, snapshot);
+}
+
+std::shared_ptr<const StaticAsset> StaticAssetCache::find(const std::string& path) const {
+    std::shared_ptr<const AssetTable> table = std::atomic_load(&assets);
+
+    auto it = table->find(path == "/" ? "/index.html" : path);
+    if (it == table->end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+size_t StaticAssetCache::assetCount() const {
+    return std::atomic_load(&assets)->size();
+}
+
+void StaticAssetCache::startWatching(int intervalMs) {
+    std::lock_guard<std::mutex> lock(watchMutex);
+    if (watching || intervalMs <= 0) {
+        return;
+    }
+    watching = true;
+    watcher = std::thread(&StaticAssetCache::watchLoop, this, intervalMs);
+}
+
+void StaticAssetCache::stopWatching() {
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        watching = false;
+    }
+    watchWake.notify_all();
+    if (watcher.joinable()) {
+        watcher.join();
+    }
+}
+
+void StaticAssetCache::watchLoop(int intervalMs) {
+    std::unique_lock<std::mutex> lock(watchMutex);
+    while (watching) {
+        watchWake.wait_for(lock, std::chrono::milliseconds(intervalMs));
+        if (!watching) break;
+
+        // Only this thread reloads while watching, so signature is ours
+        lock.unlock();
+        if (scanSignature() != signature) {
+            load();
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,83 @@
+#include "../include/ThreadPool.h"
+
+ThreadPool::ThreadPool(int threads, int queueCapacity)
+    : capacity(queueCapacity > 0 ? queueCapacity : 1), stopping(false) {
+    if (threads < 1) {
+        threads = 1;
+    }
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    shutdown();
+}
+
+// Queue a task, waiting while the queue is full
+bool ThreadPool::submit(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [this] { return stopping || tasks.size() < capacity; });
+    if (stopping) {
+        return false;
+    }
+
+    tasks.push_back(std::move(task));
+    notEmpty.notify_one();
+    return true;
+}
+
+// Queue a task only if there is room right now
+bool ThreadPool::trySubmit(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping || tasks.size() >= capacity) {
+        return false;
+    }
+
+    tasks.push_back(std::move(task));
+    notEmpty.notify_one();
+    return true;
+}
+
+// Number of tasks waiting for a worker
+int ThreadPool::queueDepth() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(tasks.size());
+}
+
+// Finish queued tasks and join all workers
+void ThreadPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+    }
+    notEmpty.notify_all();
+    notFull.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        if (workers[i].joinable()) {
+            workers[i].join();
+        }
+    }
+}
+
+// Take tasks until shutdown and the queue is drained
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        notFull.notify_one();
+        task();
+    }
+}
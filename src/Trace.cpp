@@ -0,0 +1,177 @@
+#include "../include/Trace.h"
+#include "../include/JSONWriter.h"
+#include <chrono>
+#include <fstream>
+
+#ifdef ELECTION_TRACING
+#include <mutex>
+#include <vector>
+#include <memory>
+#endif
+
+namespace {
+
+#ifdef ELECTION_TRACING
+
+struct Span {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+};
+
+// Spans of one thread; the mutex is only contended while a trace is written
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<Span> spans;    // Ring of RING_SIZE, oldest overwritten first
+    uint64_t written;
+    int tid;
+    bool inUse;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+// Never destroyed, so threads still running at exit can keep recording
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+// Buffers outlive their threads so their spans still show up in a trace.
+// The analyzer starts a thread per election (std::async), so a finished
+// thread's buffer is handed to the next new thread instead of piling up.
+struct ThreadSlot {
+    ThreadBuffer* buffer;
+
+    ThreadSlot() : buffer(nullptr) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (auto& candidate : reg.buffers) {
+            if (!candidate->inUse) {
+                buffer = candidate.get();
+                break;
+            }
+        }
+        if (!buffer) {
+            reg.buffers.emplace_back(new ThreadBuffer());
+            buffer = reg.buffers.back().get();
+            buffer->spans.resize(Trace::RING_SIZE);
+            buffer->written = 0;
+            buffer->tid = static_cast<int>(reg.buffers.size());
+        }
+        buffer->inUse = true;
+    }
+
+    ~ThreadSlot() {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        buffer->inUse = false;
+    }
+};
+
+ThreadBuffer& localBuffer() {
+    static thread_local ThreadSlot slot;
+    return *slot.buffer;
+}
+
+#endif
+
+} // namespace
+
+bool Trace::isEnabled() {
+#ifdef ELECTION_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t Trace::now() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Trace::record(const char* name, uint64_t startNanos, uint64_t endNanos) {
+#ifdef ELECTION_TRACING
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    Span& span = buffer.spans[buffer.written % RING_SIZE];
+    span.name = name;
+    span.start = startNanos;
+    span.end = endNanos;
+    buffer.written++;
+#else
+    (void)name;
+    (void)startNanos;
+    (void)endNanos;
+#endif
+}
+
+// Complete ("X") events with microsecond times; the viewer nests spans of
+// a thread by time, so parents need no explicit link
+void Trace::writeChromeJSON(std::string& out) {
+    JSONWriter json(out);
+    json.beginObject();
+    json.key("traceEvents").beginArray();
+#ifdef ELECTION_TRACING
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> registryLock(reg.mutex);
+    for (auto& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        uint64_t first = buffer->written > RING_SIZE ? buffer->written - RING_SIZE : 0;
+        if (first == buffer->written) {
+            continue;
+        }
+
+        json.beginObject();
+        json.field("name", "thread_name").field("ph", "M").field("pid", 1).field("tid", buffer->tid);
+        json.key("args").beginObject().field("name", "thread " + std::to_string(buffer->tid)).endObject();
+        json.endObject();
+
+        for (uint64_t i = first; i < buffer->written; i++) {
+            const Span& span = buffer->spans[i % RING_SIZE];
+            json.beginObject();
+            json.field("name", span.name);
+            json.field("ph", "X");
+            json.field("ts", span.start / 1000.0);
+            json.field("dur", (span.end - span.start) / 1000.0);
+            json.field("pid", 1);
+            json.field("tid", buffer->tid);
+            json.endObject();
+        }
+    }
+#endif
+    json.endArray();
+    json.field("displayTimeUnit", "ms");
+    json.endObject();
+}
+
+bool Trace::writeChromeJSON(const std::string& path, std::string& error) {
+    std::string document;
+    writeChromeJSON(document);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        error = "cannot open " + path;
+        return false;
+    }
+    file.write(document.data(), document.length());
+    if (!file) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+void Trace::clear() {
+#ifdef ELECTION_TRACING
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> registryLock(reg.mutex);
+    for (auto& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->written = 0;
+    }
+#endif
+}
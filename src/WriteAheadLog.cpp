@@ -0,0 +1,561 @@
+#include "../include/WriteAheadLog.h"
+#include "../include/CSVReader.h"
+#include "../include/Trace.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+    #define NOMINMAX
+    #include <windows.h>
+    #include <io.h>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+// "EWAL", format version, rows and CRC-32 of the base the log sits on,
+// rows and CRC-32 of the base a compaction is installing (0 rows: none)
+const char LOG_MAGIC[4] = {'E', 'W', 'A', 'L'};
+const uint32_t LOG_FORMAT = 2;
+const size_t HEADER_SIZE = 32;
+// Format 1 headers held only the base row count
+const uint32_t LOG_FORMAT_ROWS_ONLY = 1;
+const size_t ROWS_ONLY_HEADER_SIZE = 16;
+// Payload length and CRC-32 before every frame
+const size_t FRAME_HEADER_SIZE = 8;
+// A frame claiming more than this is corruption, not data
+const uint32_t MAX_FRAME_SIZE = 256 * 1024 * 1024;
+
+const char* CSV_HEADER = "Country,Year,Constituency,Candidate,Party,Votes,Elected\n";
+
+#ifdef _WIN32
+int openFile(const std::string& path) { return _open(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE); }
+int createFile(const std::string& path) { return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE); }
+int writeSome(int fd, const char* data, size_t length) { return _write(fd, data, static_cast<unsigned int>(length)); }
+bool syncFile(int fd) { return _commit(fd) == 0; }
+bool truncateFile(int fd, size_t length) { return _chsize(fd, static_cast<long>(length)) == 0; }
+void seekStart(int fd) { _lseek(fd, 0, SEEK_SET); }
+void seekEnd(int fd) { _lseek(fd, 0, SEEK_END); }
+void closeFile(int fd) { _close(fd); }
+// Paths are in the ANSI code page, as for _open
+bool replaceFile(const std::string& from, const std::string& to) {
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+#else
+int openFile(const std::string& path) { return ::open(path.c_str(), O_RDWR | O_CREAT, 0644); }
+int createFile(const std::string& path) { return ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644); }
+int writeSome(int fd, const char* data, size_t length) { return static_cast<int>(::write(fd, data, length)); }
+#ifdef __linux__
+bool syncFile(int fd) { return ::fdatasync(fd) == 0; }
+#else
+bool syncFile(int fd) { return ::fsync(fd) == 0; }
+#endif
+bool truncateFile(int fd, size_t length) { return ::ftruncate(fd, static_cast<off_t>(length)) == 0; }
+void seekStart(int fd) { ::lseek(fd, 0, SEEK_SET); }
+void seekEnd(int fd) { ::lseek(fd, 0, SEEK_END); }
+void closeFile(int fd) { ::close(fd); }
+bool replaceFile(const std::string& from, const std::string& to) {
+    if (std::rename(from.c_str(), to.c_str()) != 0) {
+        return false;
+    }
+
+    // The rename itself is only durable once the directory is synced
+    size_t slash = to.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : to.substr(0, slash + 1);
+    int dirFd = ::open(directory.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+}
+#endif
+
+bool writeAll(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.length()) {
+        int n = writeSome(fd, data.data() + written, data.length() - written);
+        if (n <= 0) {
+            return false;
+        }
+        written += n;
+    }
+    return true;
+}
+
+bool readFile(const std::string& path, std::string& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    out = contents.str();
+    return true;
+}
+
+// Write to <path>.tmp, sync it and rename it over path
+bool writeFileAtomically(const std::string& path, const std::string& data) {
+    std::string temporary = path + ".tmp";
+    int out = createFile(temporary);
+    if (out < 0) {
+        std::cerr << "Cannot create " << temporary << std::endl;
+        return false;
+    }
+    bool ok = writeAll(out, data) && syncFile(out);
+    closeFile(out);
+    if (!ok || !replaceFile(temporary, path)) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::vector<uint32_t> buildCRCTable() {
+    std::vector<uint32_t> table(256);
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+// CRC-32 (IEEE), as used by zip and gzip
+uint32_t crc32(const char* data, size_t length) {
+    static const std::vector<uint32_t> table = buildCRCTable();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// Integers are stored little-endian regardless of the host
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void putU64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void putString(std::string& out, const std::string& value) {
+    putU32(out, static_cast<uint32_t>(value.length()));
+    out += value;
+}
+
+uint32_t getU32(const char* p) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    }
+    return value;
+}
+
+uint64_t getU64(const char* p) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief Reads fields back out of one frame payload, refusing to run past its end
+ */
+struct PayloadReader {
+    const char* p;
+    const char* end;
+
+    bool u32(uint32_t& value) {
+        if (end - p < 4) return false;
+        value = getU32(p);
+        p += 4;
+        return true;
+    }
+
+    bool str(std::string& value) {
+        uint32_t length;
+        if (!u32(length) || static_cast<size_t>(end - p) < length) return false;
+        value.assign(p, length);
+        p += length;
+        return true;
+    }
+};
+
+/**
+ * @brief Which base CSV a log applies to: its row count and CRC-32
+ */
+struct BaseIdentity {
+    uint64_t rows;
+    uint32_t crc;
+
+    bool operator==(const BaseIdentity& other) const { return rows == other.rows && crc == other.crc; }
+};
+
+// Rows CSVReader would load: every non-empty line after the header
+BaseIdentity identify(const std::string& csv) {
+    BaseIdentity identity = {0, crc32(csv.data(), csv.length())};
+    size_t start = csv.find('\n');
+    while (start != std::string::npos && start + 1 < csv.length()) {
+        size_t end = csv.find('\n', start + 1);
+        if (end == std::string::npos) end = csv.length();
+        if (end > start + 1) identity.rows++;
+        start = end < csv.length() ? end : std::string::npos;
+    }
+    return identity;
+}
+
+std::string encodeHeader(const BaseIdentity& base, const BaseIdentity& next) {
+    std::string header(LOG_MAGIC, sizeof(LOG_MAGIC));
+    putU32(header, LOG_FORMAT);
+    putU64(header, base.rows);
+    putU32(header, base.crc);
+    putU64(header, next.rows);
+    putU32(header, next.crc);
+    return header;
+}
+
+std::string encodeFrame(const std::vector<ElectionRecord>& batch) {
+    std::string payload;
+    putU32(payload, static_cast<uint32_t>(batch.size()));
+    for (size_t i = 0; i < batch.size(); i++) {
+        const ElectionRecord& record = batch[i];
+        putString(payload, record.country);
+        putU32(payload, static_cast<uint32_t>(record.year));
+        putString(payload, record.constituency);
+        putString(payload, record.candidate);
+        putString(payload, record.party);
+        putU32(payload, static_cast<uint32_t>(record.votes));
+        payload += record.elected ? '\1' : '\0';
+    }
+
+    std::string frame;
+    frame.reserve(FRAME_HEADER_SIZE + payload.length());
+    putU32(frame, static_cast<uint32_t>(payload.length()));
+    putU32(frame, crc32(payload.data(), payload.length()));
+    frame += payload;
+    return frame;
+}
+
+/**
+ * @brief Walk the frames after the header; returns where the last intact one ends
+ *
+ * Records of intact frames are appended to out when it is given.
+ */
+size_t decodeFrames(const std::string& log, std::vector<ElectionRecord>* out, size_t offset = HEADER_SIZE) {
+    while (log.length() - offset >= FRAME_HEADER_SIZE) {
+        uint32_t length = getU32(log.data() + offset);
+        uint32_t checksum = getU32(log.data() + offset + 4);
+        if (length > MAX_FRAME_SIZE || log.length() - offset - FRAME_HEADER_SIZE < length) {
+            break;
+        }
+        const char* payload = log.data() + offset + FRAME_HEADER_SIZE;
+        if (crc32(payload, length) != checksum) {
+            break;
+        }
+
+        if (out) {
+            PayloadReader reader = {payload, payload + length};
+            uint32_t count = 0;
+            reader.u32(count);
+            for (uint32_t i = 0; i < count; i++) {
+                ElectionRecord record;
+                uint32_t year = 0, votes = 0;
+                if (!reader.str(record.country) || !reader.u32(year) || !reader.str(record.constituency) ||
+                    !reader.str(record.candidate) || !reader.str(record.party) || !reader.u32(votes) ||
+                    reader.p == reader.end) {
+                    break;
+                }
+                record.year = static_cast<int>(year);
+                record.votes = static_cast<int>(votes);
+                record.elected = *reader.p++ != 0;
+                out->push_back(record);
+            }
+        }
+        offset += FRAME_HEADER_SIZE + length;
+    }
+    return offset;
+}
+
+std::string toCSVRow(const ElectionRecord& record) {
+    std::string row;
+    row += record.country;
+    row += ',';
+    row += std::to_string(record.year);
+    row += ',';
+    row += record.constituency;
+    row += ',';
+    row += record.candidate;
+    row += ',';
+    row += record.party;
+    row += ',';
+    row += std::to_string(record.votes);
+    row += record.elected ? ",Yes\n" : ",No\n";
+    return row;
+}
+
+} // namespace
+
+WriteAheadLog::WriteAheadLog(const std::string& logPath, const std::string& basePath, size_t compactBytes)
+    : logPath(logPath), basePath(basePath), compactBytes(compactBytes), fd(-1),
+      queuedSeq(0), durableSeq(0), failed(false), stopping(false), baseRows(0), baseCRC(0), logSize(0) {
+    std::memset(&stats, 0, sizeof(stats));
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+bool WriteAheadLog::open() {
+    std::string log;
+    readFile(logPath, log);
+    std::string base;
+    readFile(basePath, base);
+    BaseIdentity actual = identify(base);
+    BaseIdentity none = {0, 0};
+
+    // Set when the log has to be rewritten before use
+    std::string contents;
+    if (log.empty()) {
+        contents = encodeHeader(actual, none);
+    } else {
+        uint32_t format = log.length() >= 8 ? getU32(log.data() + 4) : 0;
+        size_t headerSize = format == LOG_FORMAT_ROWS_ONLY ? ROWS_ONLY_HEADER_SIZE : HEADER_SIZE;
+        if (log.length() < headerSize || std::memcmp(log.data(), LOG_MAGIC, sizeof(LOG_MAGIC)) != 0 ||
+            (format != LOG_FORMAT && format != LOG_FORMAT_ROWS_ONLY)) {
+            // Never overwrite something we do not recognise
+            std::cerr << logPath << " is not an election write-ahead log" << std::endl;
+            return false;
+        }
+        BaseIdentity expected = {getU64(log.data() + 8), actual.crc};
+        BaseIdentity next = none;
+        if (format == LOG_FORMAT) {
+            expected.crc = getU32(log.data() + 16);
+            next.rows = getU64(log.data() + 20);
+            next.crc = getU32(log.data() + 28);
+        }
+
+        if (next.rows > 0 && actual == next) {
+            // A compaction renamed the new base into place but crashed
+            // before emptying the log; the base already holds its records
+            contents = encodeHeader(actual, none);
+        } else if (!(actual == expected)) {
+            // Replaying onto any other base would lose or repeat records
+            std::cerr << basePath << " (" << actual.rows << " rows) is not the base " << logPath
+                      << " was written on (" << expected.rows << " rows); refusing to start" << std::endl;
+            return false;
+        } else {
+            // Frames cut short by a crash were never acknowledged; drop them
+            size_t end = decodeFrames(log, nullptr, headerSize);
+            if (end < log.length()) {
+                std::cerr << "Discarding " << (log.length() - end) << " torn bytes at the end of "
+                          << logPath << std::endl;
+            }
+            if (end < log.length() || format != LOG_FORMAT || next.rows > 0) {
+                contents = encodeHeader(actual, none) + log.substr(headerSize, end - headerSize);
+            }
+        }
+    }
+
+    if (!contents.empty() && !writeFileAtomically(logPath, contents)) {
+        std::cerr << "Cannot write " << logPath << std::endl;
+        return false;
+    }
+    fd = openFile(logPath);
+    if (fd < 0) {
+        std::cerr << "Cannot open " << logPath << std::endl;
+        return false;
+    }
+    baseRows = actual.rows;
+    baseCRC = actual.crc;
+    logSize = contents.empty() ? log.length() : contents.length();
+    seekEnd(fd);
+
+    flusher = std::thread(&WriteAheadLog::flushLoop, this);
+    return true;
+}
+
+bool WriteAheadLog::load(ElectionData& data) {
+    TRACE_SPAN("WriteAheadLog::load");
+    std::lock_guard<std::mutex> fileLock(fileMutex);
+    CSVReader::readFromFile(basePath, data);
+
+    std::vector<ElectionRecord> records;
+    if (!readRecords(records)) {
+        return false;
+    }
+    data.addRecords(records);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.replayed = records.size();
+    return true;
+}
+
+bool WriteAheadLog::append(const std::vector<ElectionRecord>& batch) {
+    TRACE_SPAN("WriteAheadLog::append");
+    std::string frame = encodeFrame(batch);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (failed || stopping || fd < 0) {
+        return false;
+    }
+    pending += frame;
+    uint64_t seq = ++queuedSeq;
+    stats.batches++;
+    work.notify_one();
+
+    synced.wait(lock, [&] { return durableSeq >= seq || failed; });
+    if (durableSeq < seq) {
+        return false;
+    }
+    stats.records += batch.size();
+    return true;
+}
+
+void WriteAheadLog::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work.notify_all();
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+    if (fd >= 0) {
+        closeFile(fd);
+        fd = -1;
+    }
+}
+
+WriteAheadLogStats WriteAheadLog::getStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    WriteAheadLogStats result = stats;
+    result.logBytes = logSize;
+    return result;
+}
+
+// Write whatever queued up during the previous sync with a single fsync
+void WriteAheadLog::flushLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        work.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (pending.empty()) {
+            break;
+        }
+
+        std::string frames;
+        frames.swap(pending);
+        uint64_t seq = queuedSeq;
+        lock.unlock();
+
+        bool ok;
+        {
+            std::lock_guard<std::mutex> fileLock(fileMutex);
+            ok = writeAll(fd, frames) && syncFile(fd);
+            if (ok) logSize += frames.length();
+        }
+
+        lock.lock();
+        if (ok) {
+            durableSeq = seq;
+            stats.syncs++;
+        } else {
+            // The tail may now be half written; later appends must not follow it
+            std::cerr << "Write-ahead log write failed; rejecting further appends" << std::endl;
+            failed = true;
+        }
+        synced.notify_all();
+
+        if (ok && compactBytes > 0 && logSize >= compactBytes) {
+            lock.unlock();
+            bool compacted;
+            {
+                std::lock_guard<std::mutex> fileLock(fileMutex);
+                compacted = compact();
+            }
+            lock.lock();
+            if (compacted) {
+                stats.compactions++;
+            }
+        }
+    }
+}
+
+// Fold the log into a new base CSV; fileMutex is held
+bool WriteAheadLog::compact() {
+    TRACE_SPAN("WriteAheadLog::compact");
+    std::vector<ElectionRecord> records;
+    if (!readRecords(records) || records.empty()) {
+        return false;
+    }
+
+    std::string base;
+    if (!readFile(basePath, base) || base.empty()) {
+        base = CSV_HEADER;
+    } else if (base.back() != '\n') {
+        base += '\n';
+    }
+    for (size_t i = 0; i < records.size(); i++) {
+        base += toCSVRow(records[i]);
+    }
+
+    // The header names the new base before it replaces the old one, so
+    // open() can tell a crash after the rename from a foreign base
+    BaseIdentity current = {baseRows, baseCRC};
+    BaseIdentity next = identify(base);
+    seekStart(fd);
+    bool noted = writeAll(fd, encodeHeader(current, next)) && syncFile(fd);
+    seekEnd(fd);
+    if (!noted || !writeFileAtomically(basePath, base)) {
+        std::cerr << "Compaction of " << logPath << " failed" << std::endl;
+        return false;
+    }
+
+    // The base now holds these records; only then is the log emptied
+    std::cout << "Compacted " << records.size() << " logged records into " << basePath << std::endl;
+    return resetLog(next.rows, next.crc);
+}
+
+// Empty the log on top of the base with the given identity; fileMutex is held
+bool WriteAheadLog::resetLog(uint64_t rows, uint32_t crc) {
+    if (!truncateFile(fd, 0)) {
+        return false;
+    }
+    seekStart(fd);
+    BaseIdentity base = {rows, crc};
+    BaseIdentity none = {0, 0};
+    if (!writeAll(fd, encodeHeader(base, none)) || !syncFile(fd)) {
+        return false;
+    }
+    baseRows = rows;
+    baseCRC = crc;
+    logSize = HEADER_SIZE;
+    return true;
+}
+
+// Decode every intact frame; fileMutex is held
+bool WriteAheadLog::readRecords(std::vector<ElectionRecord>& records) {
+    std::string log;
+    if (!readFile(logPath, log) || log.length() < HEADER_SIZE) {
+        return false;
+    }
+    log.resize(std::min<size_t>(log.length(), logSize));
+    decodeFrames(log, &records);
+    return true;
+}
@@ -338,7 +338,7 @@ void showElectionAnalysisMenu(ElectionData& data, const std::string& country, in
             }
             case 3: {
                 clearScreen();
-                std::map<std::string, int> seats = ElectionAnalyzer::getSeatDistribution(data, country, year);
+                std::vector<SeatInfo> seats = ElectionAnalyzer::getSeatDistribution(data, country, year);
                 displaySeatDistribution(seats);
                 std::cout << "Press Enter to continue...";
                 std::cin.get();
@@ -362,18 +362,14 @@ void showElectionAnalysisMenu(ElectionData& data, const std::string& country, in
                 break;
             }
             case 6: {
+                // One pass over the election instead of one per section
                 clearScreen();
-                ElectionStats stats = ElectionAnalyzer::calculateElectionStats(data, country, year);
-                displayElectionStats(stats);
-                
-                std::vector<PartyStats> parties = ElectionAnalyzer::rankPartiesByVotes(data, country, year);
-                displayPartyStats(parties);
-                
-                std::map<std::string, int> seats = ElectionAnalyzer::getSeatDistribution(data, country, year);
-                displaySeatDistribution(seats);
-                
-                std::vector<ElectionRecord> top = ElectionAnalyzer::getTopCandidates(data, country, year, 10);
-                displayTopCandidates(top, 10);
+                ElectionDashboard dashboard = ElectionAnalyzer::buildDashboard(data, country, year, 10);
+                displayElectionStats(dashboard.stats);
+                displayPartyStats(dashboard.stats.partyStats);
+                displaySeatDistribution(dashboard.seats);
+                displayTopCandidates(dashboard.topCandidates, 10);
+                displayWinningCandidates(dashboard.winners);
                 
                 std::cout << "Press Enter to continue...";
                 std::cin.get();
@@ -392,7 +388,7 @@ void showElectionAnalysisMenu(ElectionData& data, const std::string& country, in
 /**
  * @brief Show comparative analysis menu
  */
-void showComparativeAnalysisMenu(const ElectionData& data, 
+void showComparativeAnalysisMenu(ElectionData& data, 
                                  const std::map<std::string, std::vector<int>>& availableElections) {
     clearScreen();
     printSeparator();
@@ -432,7 +428,7 @@ void showComparativeAnalysisMenu(const ElectionData& data,
 /**
  * @brief Show party trend analysis menu
  */
-void showPartyTrendMenu(const ElectionData& data,
+void showPartyTrendMenu(ElectionData& data,
                        const std::map<std::string, std::vector<int>>& availableElections) {
     clearScreen();
     printSeparator();
@@ -471,7 +467,7 @@ void showPartyTrendMenu(const ElectionData& data,
     std::cout << "PARTY TREND ANALYSIS: " << party << " (" << country << ")" << std::endl;
     printSeparator();
     
-    std::map<int, PartyStats> trend = ElectionAnalyzer::getPartyTrend(data, country, party, years);
+    std::vector<PartyTrend> trend = ElectionAnalyzer::getPartyTrend(data, country, party, years);
     
     std::cout << std::left << std::setw(10) << "Year"
               << std::right << std::setw(15) << "Total Votes"
@@ -479,15 +475,13 @@ void showPartyTrendMenu(const ElectionData& data,
               << std::setw(15) << "Seats Won" << std::endl;
     std::cout << std::string(55, '-') << std::endl;
     
-    for (int year : years) {
-        if (trend.find(year) != trend.end()) {
-            const PartyStats& ps = trend[year];
-            std::cout << std::left << std::setw(10) << year
-                      << std::right << std::setw(15) << ps.totalVotes
-                      << std::setw(14) << std::fixed << std::setprecision(2) 
-                      << ps.voteShare << "%"
-                      << std::setw(15) << ps.seatsWon << std::endl;
-        }
+    for (const PartyTrend& entry : trend) {
+        const PartyStats& ps = entry.stats;
+        std::cout << std::left << std::setw(10) << entry.year
+                  << std::right << std::setw(15) << ps.totalVotes
+                  << std::setw(14) << std::fixed << std::setprecision(2) 
+                  << ps.voteShare << "%"
+                  << std::setw(15) << ps.seatsWon << std::endl;
     }
     std::cout << std::endl;
     
@@ -498,7 +492,7 @@ void showPartyTrendMenu(const ElectionData& data,
 /**
  * @brief Main menu
  */
-void showMainMenu(const ElectionData& data, 
+void showMainMenu(ElectionData& data, 
                   const std::map<std::string, std::vector<int>>& availableElections) {
     while (true) {
         clearScreen();
@@ -1,22 +1,98 @@
 #include "../include/ElectionData.h"
 #include "../include/CSVReader.h"
 #include "../include/HTTPServer.h"
+#include "../include/Trace.h"
 #include <iostream>
 #include <vector>
 #include <string>
+#include <cstdlib>
+#include <thread>
+#include <memory>
+
+/**
+ * @brief Read the data files into a new dataset
+ *
+ * Missing files are skipped, as long as at least one loads; returns null
+ * when none does. Used both at startup and for reloads.
+ */
+static std::shared_ptr<ElectionData> loadDataset(const std::vector<std::string>& files, bool report) {
+    auto data = std::make_shared<ElectionData>();
+    int loadedCount = 0;
+    for (const auto& file : files) {
+        if (CSVReader::readFromFile(file, *data)) {
+            if (report) std::cout << "  ✓ Loaded: " << file << std::endl;
+            loadedCount++;
+        } else {
+            std::cout << "  ✗ Failed to load: " << file << std::endl;
+        }
+    }
+
+    if (report) {
+        std::cout << "\nLoaded " << loadedCount << " file(s) with "
+                  << data->getTotalRecords() << " total records.\n" << std::endl;
+    }
+    return loadedCount > 0 ? data : nullptr;
+}
 
 /**
  * @brief Main function for web-based GUI
+ *
+ * Options: --port N, --threads N, --queue N, --backlog N,
+ *          --mode blocking|epoll|uring, --event-threads N,
+ *          --idle-timeout MS, --max-requests N, --max-body BYTES,
+ *          --asset-refresh MS, --response-cache MB, --compress-min BYTES,
+ *          --max-queue-wait MS, --standard-limit N, --heavy-limit N,
+ *          --admin-token TOKEN, --wal FILE, --wal-compact MB, --trace FILE
+ *
+ * Send SIGHUP (or POST /api/admin/reload) to reload the CSV files
+ * without restarting.
  */
-int main() {
+int main(int argc, char* argv[]) {
+    int port = 8080;
+    ServerOptions options;
+    std::string walPath;
+    int walCompactMB = 64;
+    std::string tracePath;
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores > 0) {
+        options.threads = cores * 2;
+    }
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        int value = std::atoi(argv[i + 1]);
+        if (arg == "--mode") {
+            std::string mode = argv[i + 1];
+            options.mode = mode == "epoll" ? ServerMode::EventLoop
+                         : mode == "uring" ? ServerMode::IoUring : ServerMode::Blocking;
+        }
+        else if (arg == "--event-threads") options.eventThreads = value;
+        else if (arg == "--port") port = value;
+        else if (arg == "--threads") options.threads = value;
+        else if (arg == "--queue") options.queueSize = value;
+        else if (arg == "--backlog") options.backlog = value;
+        else if (arg == "--idle-timeout") options.idleTimeoutMs = value;
+        else if (arg == "--max-requests") options.maxRequestsPerConnection = value;
+        else if (arg == "--max-body") options.maxBodySize = value > 0 ? value : 0;
+        else if (arg == "--asset-refresh") options.assetRefreshMs = value;
+        else if (arg == "--compress-min") options.compressMinBytes = value > 0 ? value : 0;
+        else if (arg == "--max-queue-wait") options.maxQueueWaitMs = value;
+        else if (arg == "--standard-limit") options.standardLimit = value;
+        else if (arg == "--heavy-limit") options.heavyLimit = value;
+        else if (arg == "--admin-token") options.adminToken = argv[i + 1];
+        else if (arg == "--wal") walPath = argv[i + 1];
+        else if (arg == "--trace") tracePath = argv[i + 1];
+        else if (arg == "--wal-compact") walCompactMB = value > 0 ? value : 0;
+        else if (arg == "--response-cache") options.responseCacheBytes = value > 0 ? static_cast<size_t>(value) * 1024 * 1024 : 0;
+        else std::cerr << "Unknown option: " << arg << std::endl;
+    }
+
     std::cout << "\n";
     std::cout << "╔══════════════════════════════════════════════════════════════════════════════╗\n";
     std::cout << "║           ELECTION DATA ANALYSIS SYSTEM - WEB GUI                           ║\n";
     std::cout << "╚══════════════════════════════════════════════════════════════════════════════╝\n";
     std::cout << "\n";
 
-    ElectionData data;
-
     // Load data files
     std::vector<std::string> files = {
         "jordan_2016.csv",
@@ -27,27 +103,47 @@ int main() {
     };
 
     std::cout << "Loading election data files..." << std::endl;
-    int loadedCount = 0;
-    for (const auto& file : files) {
-        if (CSVReader::readFromFile(file, data)) {
-            std::cout << "  ✓ Loaded: " << file << std::endl;
-            loadedCount++;
-        } else {
-            std::cout << "  ✗ Failed to load: " << file << std::endl;
+    auto data = loadDataset(files, true);
+    if (!data) {
+        std::cerr << "Error: No data files loaded. Please ensure CSV files are in the current directory." << std::endl;
+        return 1;
+    }
+
+    // Records ingested at runtime: base CSV next to the log, then the log
+    std::shared_ptr<WriteAheadLog> wal;
+    if (!walPath.empty()) {
+        size_t dot = walPath.find_last_of('.');
+        std::string basePath = (dot == std::string::npos || walPath.find_first_of("/\\", dot) != std::string::npos)
+                               ? walPath + ".csv" : walPath.substr(0, dot) + ".csv";
+        wal = std::make_shared<WriteAheadLog>(walPath, basePath, static_cast<size_t>(walCompactMB) * 1024 * 1024);
+        if (!wal->open() || !wal->load(*data)) {
+            std::cerr << "Error: cannot use write-ahead log " << walPath << std::endl;
+            return 1;
         }
+        std::cout << "Replayed " << wal->getStats().replayed << " logged record(s) from " << walPath
+                  << " on top of " << basePath << ".\n" << std::endl;
     }
-    
-    std::cout << "\nLoaded " << loadedCount << " file(s) with " 
-              << data.getTotalRecords() << " total records.\n" << std::endl;
 
-    if (loadedCount == 0) {
-        std::cerr << "Error: No data files loaded. Please ensure CSV files are in the current directory." << std::endl;
-        return 1;
+    // Startup timeline; later spans are served at /api/admin/trace
+    if (!tracePath.empty()) {
+        std::string error;
+        if (!Trace::isEnabled()) {
+            std::cerr << "Warning: --trace ignored, built without ELECTION_TRACING" << std::endl;
+        } else if (Trace::writeChromeJSON(tracePath, error)) {
+            std::cout << "Wrote startup trace to " << tracePath << ".\n" << std::endl;
+            Trace::clear();
+        } else {
+            std::cerr << "Warning: " << error << std::endl;
+        }
     }
 
     // Start HTTP server
-    int port = 8080;
-    HTTPServer server(port, &data);
+    HTTPServer server(port, data, options);
+    server.setAppendLog(wal);
+
+    // Reloads re-read the same files under the same rule as startup; the
+    // server replays the write-ahead log on top before swapping them in
+    server.setDatasetLoader([files]() { return loadDataset(files, false); });
     
     std::cout << "Starting web server..." << std::endl;
     std::cout << "\n";
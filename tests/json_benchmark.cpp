@@ -0,0 +1,189 @@
+#include "../include/ElectionData.h"
+#include "../include/ElectionAnalyzer.h"
+#include "../include/CSVReader.h"
+#include "../include/JSONWriter.h"
+#include "../include/BinaryWriter.h"
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Serialization throughput of the /api/stats and /api/top-candidates payloads
+ *
+ * Usage: election_json_bench [iterations] [country] [year]
+ *
+ * Each payload is serialized the way the server used to (std::ostringstream,
+ * no escaping), with JSONWriter into a reused buffer, and as MessagePack
+ * and CBOR with BinaryWriter, the encodings clients can ask for with
+ * Accept. Run from the directory holding the CSV files.
+ */
+
+// Previous ostringstream serialization of /api/stats
+std::string statsWithStream(const ElectionStats& stats) {
+    std::ostringstream json;
+    json << "{";
+    json << "\"country\":\"" << stats.country << "\",";
+    json << "\"year\":" << stats.year << ",";
+    json << "\"totalVotes\":" << stats.totalVotes << ",";
+    json << "\"totalSeats\":" << stats.totalSeats << ",";
+    json << "\"totalCandidates\":" << stats.totalCandidates << ",";
+    json << "\"constituencies\":" << stats.constituencies << ",";
+    json << "\"parties\":[";
+    bool first = true;
+    for (const auto& ps : stats.partyStats) {
+        if (!first) json << ",";
+        json << "{";
+        json << "\"party\":\"" << ps.party << "\",";
+        json << "\"totalVotes\":" << ps.totalVotes << ",";
+        json << "\"voteShare\":" << ps.voteShare << ",";
+        json << "\"seatsWon\":" << ps.seatsWon << ",";
+        json << "\"candidatesCount\":" << ps.candidatesCount;
+        json << "}";
+        first = false;
+    }
+    json << "]}";
+    return json.str();
+}
+
+template <typename Writer>
+void statsWithWriter(Writer& json, const ElectionStats& stats) {
+    json.beginObject();
+    json.field("country", stats.country);
+    json.field("year", stats.year);
+    json.field("totalVotes", stats.totalVotes);
+    json.field("totalSeats", stats.totalSeats);
+    json.field("totalCandidates", stats.totalCandidates);
+    json.field("constituencies", stats.constituencies);
+    json.key("parties").beginArray();
+    for (const auto& ps : stats.partyStats) {
+        json.beginObject();
+        json.field("party", ps.party);
+        json.field("totalVotes", ps.totalVotes);
+        json.field("voteShare", ps.voteShare);
+        json.field("seatsWon", ps.seatsWon);
+        json.field("candidatesCount", ps.candidatesCount);
+        json.endObject();
+    }
+    json.endArray().endObject();
+}
+
+// Previous ostringstream serialization of /api/top-candidates
+std::string candidatesWithStream(const std::vector<ElectionRecord>& candidates) {
+    std::ostringstream json;
+    json << "{\"candidates\":[";
+    bool first = true;
+    for (const auto& c : candidates) {
+        if (!first) json << ",";
+        json << "{";
+        json << "\"candidate\":\"" << c.candidate << "\",";
+        json << "\"party\":\"" << c.party << "\",";
+        json << "\"constituency\":\"" << c.constituency << "\",";
+        json << "\"votes\":" << c.votes << ",";
+        json << "\"elected\":" << (c.elected ? "true" : "false");
+        json << "}";
+        first = false;
+    }
+    json << "]}";
+    return json.str();
+}
+
+template <typename Writer>
+void candidatesWithWriter(Writer& json, const std::vector<ElectionRecord>& candidates) {
+    json.beginObject().key("candidates").beginArray();
+    for (const auto& c : candidates) {
+        json.beginObject();
+        json.field("candidate", c.candidate);
+        json.field("party", c.party);
+        json.field("constituency", c.constituency);
+        json.field("votes", c.votes);
+        json.field("elected", c.elected);
+        json.endObject();
+    }
+    json.endArray().endObject();
+}
+
+/**
+ * @brief Run fn the given number of times and print ns/op and MB/s
+ */
+double measure(const std::string& label, int iterations, const std::function<size_t()>& fn) {
+    size_t bytes = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        bytes += fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - begin).count();
+    double nsPerOp = seconds * 1e9 / iterations;
+    std::cout << "  " << label << ": " << nsPerOp << " ns/op, "
+              << (bytes / seconds / (1024 * 1024)) << " MB/s" << std::endl;
+    return nsPerOp;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20000;
+    std::string country = argc > 2 ? argv[2] : "Jordan";
+    int year = argc > 3 ? std::atoi(argv[3]) : 2016;
+
+    ElectionData data;
+    std::vector<std::string> files = {
+        "jordan_2016.csv", "jordan_2020.csv",
+        "vanuatu_2016.csv", "vanuatu_2020.csv", "vanuatu_2022.csv"
+    };
+    for (const auto& file : files) {
+        CSVReader::readFromFile(file, data);
+    }
+    if (data.getTotalRecords() == 0) {
+        std::cerr << "No data loaded; run from the directory with the CSV files" << std::endl;
+        return 1;
+    }
+
+    ElectionStats stats = ElectionAnalyzer::calculateElectionStats(data, country, year);
+    std::vector<ElectionRecord> candidates = ElectionAnalyzer::getTopCandidates(data, country, year, 100);
+    std::string buffer;
+
+    // Each label reports the bytes it produced per operation
+    auto binary = [&](const std::string& label, BinaryFormat format, const std::function<void(BinaryWriter&)>& write) {
+        buffer.clear();
+        BinaryWriter sized(buffer, format);
+        write(sized);
+        measure(label + " (" + std::to_string(buffer.length()) + " bytes)", iterations, [&] {
+            buffer.clear();
+            BinaryWriter writer(buffer, format);
+            write(writer);
+            return buffer.length();
+        });
+    };
+
+    std::cout << "/api/stats (" << statsWithStream(stats).length() << " bytes)" << std::endl;
+    double streamNs = measure("ostringstream", iterations, [&] { return statsWithStream(stats).length(); });
+    double writerNs = measure("JSONWriter   ", iterations, [&] {
+        buffer.clear();
+        JSONWriter json(buffer);
+        statsWithWriter(json, stats);
+        return buffer.length();
+    });
+    std::cout << "  speedup: " << (streamNs / writerNs) << "x" << std::endl;
+    binary("MessagePack  ", BinaryFormat::MessagePack, [&](BinaryWriter& writer) { statsWithWriter(writer, stats); });
+    binary("CBOR         ", BinaryFormat::CBOR, [&](BinaryWriter& writer) { statsWithWriter(writer, stats); });
+
+    std::cout << "/api/top-candidates n=" << candidates.size()
+              << " (" << candidatesWithStream(candidates).length() << " bytes)" << std::endl;
+    streamNs = measure("ostringstream", iterations, [&] { return candidatesWithStream(candidates).length(); });
+    writerNs = measure("JSONWriter   ", iterations, [&] {
+        buffer.clear();
+        JSONWriter json(buffer);
+        candidatesWithWriter(json, candidates);
+        return buffer.length();
+    });
+    std::cout << "  speedup: " << (streamNs / writerNs) << "x" << std::endl;
+    binary("MessagePack  ", BinaryFormat::MessagePack,
+           [&](BinaryWriter& writer) { candidatesWithWriter(writer, candidates); });
+    binary("CBOR         ", BinaryFormat::CBOR, [&](BinaryWriter& writer) { candidatesWithWriter(writer, candidates); });
+
+    return 0;
+}
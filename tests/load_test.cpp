@@ -0,0 +1,294 @@
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Simple closed-loop HTTP load generator for the web server
+ *
+ * Usage: election_load_test [port] [path] [clients] [seconds] [close|keepalive] [rate]
+ *
+ * Each client thread sends requests back to back and reports
+ * requests/second and latency. In "close" mode (default) every request
+ * uses a new connection; in "keepalive" mode each client reuses one
+ * connection and reads responses by Content-Length.
+ *
+ * With a rate (requests/second over all clients) the load is open-loop:
+ * requests are sent on a fixed schedule whether or not earlier ones have
+ * been answered, and latency counts from the scheduled time, so a server
+ * that falls behind shows it. 503 responses are counted as shed, with
+ * their own latency, and left out of the served latency percentiles.
+ */
+
+struct ClientResult {
+    long long requests;
+    long long errors;
+    long long shed;
+    std::vector<double> latenciesMs;
+    std::vector<double> shedLatenciesMs;
+
+    ClientResult() {
+        requests = 0;
+        errors = 0;
+        shed = 0;
+    }
+
+    void record(int status, double latencyMs) {
+        if (status == 503) {
+            shed++;
+            shedLatenciesMs.push_back(latencyMs);
+        } else if (status > 0) {
+            requests++;
+            latenciesMs.push_back(latencyMs);
+        } else {
+            errors++;
+        }
+    }
+};
+
+/**
+ * @brief Status code of a response starting at text, or 0
+ */
+int parseStatus(const std::string& text) {
+    if (text.compare(0, 5, "HTTP/") != 0) return 0;
+    size_t space = text.find(' ');
+    return space == std::string::npos ? 0 : std::atoi(text.c_str() + space + 1);
+}
+
+/**
+ * @brief Open a TCP connection to the local server
+ */
+int connectToServer(int port) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+        return -1;
+    }
+
+    sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    if (connect(sock, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(sock);
+        return -1;
+    }
+
+    int noDelay = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return sock;
+}
+
+/**
+ * @brief Read exactly one response (headers + Content-Length body)
+ *
+ * Bytes past the end of the response are kept in pending. Returns the
+ * status code, or 0 if the connection failed.
+ */
+int readResponse(int sock, std::string& pending) {
+    char buffer[16384];
+    size_t headerEnd;
+    while ((headerEnd = pending.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+        if (n <= 0) return 0;
+        pending.append(buffer, n);
+    }
+
+    int status = parseStatus(pending);
+    size_t length = 0;
+    size_t pos = pending.find("Content-Length: ");
+    if (pos != std::string::npos && pos < headerEnd) {
+        length = std::strtoul(pending.c_str() + pos + 16, nullptr, 10);
+    }
+
+    size_t total = headerEnd + 4 + length;
+    while (pending.length() < total) {
+        ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+        if (n <= 0) return 0;
+        pending.append(buffer, n);
+    }
+
+    pending.erase(0, total);
+    return status;
+}
+
+/**
+ * @brief Send one request on a new connection and read the full response
+ *
+ * Returns the status code, or 0 if nothing came back.
+ */
+int sendRequest(int port, const std::string& request) {
+    int sock = connectToServer(port);
+    if (sock < 0) {
+        return 0;
+    }
+
+    if (send(sock, request.c_str(), request.length(), MSG_NOSIGNAL) < 0) {
+        close(sock);
+        return 0;
+    }
+
+    char buffer[16384];
+    std::string head;
+    while (true) {
+        ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+        if (n <= 0) break;
+        if (head.length() < 16) {
+            head.append(buffer, n);
+        }
+    }
+
+    close(sock);
+    return parseStatus(head);
+}
+
+/**
+ * @brief Wait for the next scheduled send time; returns the time latency counts from
+ */
+std::chrono::steady_clock::time_point waitForSlot(std::chrono::steady_clock::time_point& next,
+                                                  std::chrono::steady_clock::duration interval) {
+    if (interval.count() == 0) {
+        return std::chrono::steady_clock::now();
+    }
+    std::chrono::steady_clock::time_point slot = next;
+    std::this_thread::sleep_until(slot);
+    next += interval;
+    return slot;
+}
+
+/**
+ * @brief Run one client on a single persistent connection until the deadline
+ */
+void runKeepAliveClient(int port, const std::string& path, std::chrono::steady_clock::time_point deadline,
+                        std::chrono::steady_clock::time_point next, std::chrono::steady_clock::duration interval,
+                        ClientResult* result) {
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    std::string pending;
+    int sock = -1;
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (sock < 0) {
+            sock = connectToServer(port);
+            pending.clear();
+            if (sock < 0) {
+                result->errors++;
+                continue;
+            }
+        }
+
+        auto begin = waitForSlot(next, interval);
+        int status = send(sock, request.c_str(), request.length(), MSG_NOSIGNAL) > 0 ? readResponse(sock, pending) : 0;
+        auto end = std::chrono::steady_clock::now();
+
+        if (status > 0) {
+            result->record(status, std::chrono::duration<double, std::milli>(end - begin).count());
+        }
+        if (status == 0 || status == 503) {
+            // Server closed the connection (e.g. request limit); reconnect
+            close(sock);
+            sock = -1;
+        }
+    }
+
+    if (sock >= 0) {
+        close(sock);
+    }
+}
+
+/**
+ * @brief Run one client until the deadline
+ */
+void runClient(int port, const std::string& path, std::chrono::steady_clock::time_point deadline,
+               std::chrono::steady_clock::time_point next, std::chrono::steady_clock::duration interval,
+               ClientResult* result) {
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto begin = waitForSlot(next, interval);
+        int status = sendRequest(port, request);
+        auto end = std::chrono::steady_clock::now();
+        result->record(status, std::chrono::duration<double, std::milli>(end - begin).count());
+    }
+}
+
+/**
+ * @brief Get a percentile from sorted latencies
+ */
+double percentile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(q * (sorted.size() - 1));
+    return sorted[index];
+}
+
+int main(int argc, char* argv[]) {
+    int port = argc > 1 ? std::atoi(argv[1]) : 8080;
+    std::string path = argc > 2 ? argv[2] : "/api/stats?country=Jordan&year=2016";
+    int clients = argc > 3 ? std::atoi(argv[3]) : 16;
+    int seconds = argc > 4 ? std::atoi(argv[4]) : 5;
+    bool keepAlive = argc > 5 && std::string(argv[5]) == "keepalive";
+    double rate = argc > 6 ? std::atof(argv[6]) : 0.0;
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::seconds(seconds);
+
+    // Open-loop: each client sends every clients/rate seconds, staggered
+    std::chrono::steady_clock::duration interval(0);
+    if (rate > 0) {
+        interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(clients / rate));
+    }
+
+    std::vector<ClientResult> results(clients);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < clients; i++) {
+        auto first = start + interval * i / clients;
+        threads.push_back(std::thread(keepAlive ? runKeepAliveClient : runClient, port, path, deadline,
+                                      first, interval, &results[i]));
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+
+    long long requests = 0;
+    long long errors = 0;
+    long long shed = 0;
+    std::vector<double> latencies;
+    std::vector<double> shedLatencies;
+    for (size_t i = 0; i < results.size(); i++) {
+        requests += results[i].requests;
+        errors += results[i].errors;
+        shed += results[i].shed;
+        latencies.insert(latencies.end(), results[i].latenciesMs.begin(), results[i].latenciesMs.end());
+        shedLatencies.insert(shedLatencies.end(), results[i].shedLatenciesMs.begin(), results[i].shedLatenciesMs.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::sort(shedLatencies.begin(), shedLatencies.end());
+
+    std::cout << "path=" << path << " clients=" << clients << " seconds=" << seconds
+              << (keepAlive ? " keep-alive" : " connection-per-request");
+    if (rate > 0) {
+        std::cout << " open-loop rate=" << rate << "/s";
+    }
+    std::cout << std::endl;
+    std::cout << "requests=" << requests << " shed=" << shed << " errors=" << errors
+              << " req/s=" << (requests / static_cast<double>(seconds)) << std::endl;
+    std::cout << "latency ms: p50=" << percentile(latencies, 0.50)
+              << " p90=" << percentile(latencies, 0.90)
+              << " p99=" << percentile(latencies, 0.99)
+              << " max=" << (latencies.empty() ? 0.0 : latencies.back()) << std::endl;
+    if (shed > 0) {
+        std::cout << "shed latency ms: p50=" << percentile(shedLatencies, 0.50)
+                  << " p99=" << percentile(shedLatencies, 0.99) << std::endl;
+    }
+
+    return 0;
+}
@@ -1,8 +1,36 @@
+// The checks are asserts, so keep them in Release builds too
+#undef NDEBUG
+
 #include "../include/ElectionData.h"
 #include "../include/CSVReader.h"
 #include "../include/ElectionAnalyzer.h"
+#include "../include/JSONWriter.h"
+#include "../include/BinaryWriter.h"
+#include "../include/WriteAheadLog.h"
+#include "../include/RequestParser.h"
+#include "../include/StaticAssetCache.h"
+#include "../include/OutputQueue.h"
+#include "../include/ResponseCache.h"
+#include "../include/LiveHub.h"
+#include "../include/AdmissionControl.h"
+#include "../include/ServerMetrics.h"
+#include "../include/Trace.h"
 #include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
 
 /**
  * @brief Test basic insertion and retrieval
@@ -15,48 +43,50 @@ void testInsertAndRetrieve() {
                          "TestCandidate", "TestParty", 1000, true);
     
     // Test insert
-    assert(data.insertRecord(record) == true);
+    data.addRecord(record);
     assert(data.getTotalRecords() == 1);
     
-    // Test retrieve
-    const ElectionRecord* retrieved = data.getRecord("TestCountry", 2020, 
-                                                     "TestConstituency", "TestCandidate");
-    assert(retrieved != nullptr);
-    assert(retrieved->votes == 1000);
-    assert(retrieved->elected == true);
+    // Test retrieve by position
+    ElectionRecord retrieved = data.getRecord(0);
+    assert(retrieved.candidate == "TestCandidate");
+    assert(retrieved.votes == 1000);
+    assert(retrieved.elected == true);
     
-    // Test duplicate insert
-    assert(data.insertRecord(record) == false);
+    // Test batch insert
+    data.addRecords({ElectionRecord("TestCountry", 2020, "Const2", "Cand2", "TestParty", 500, false),
+                     ElectionRecord("TestCountry", 2020, "Const3", "Cand3", "TestParty", 700, false)});
+    assert(data.getTotalRecords() == 3);
+    assert(data.getRecord(2).candidate == "Cand3");
     
     std::cout << "  ✓ Passed" << std::endl;
 }
 
 /**
- * @brief Test update operation
+ * @brief Test that records are append-only
+ *
+ * There is no in-place update: a corrected row is added as a new record
+ * and earlier ones stay as they were.
  */
-void testUpdate() {
-    std::cout << "Testing update operation..." << std::endl;
+void testAppendOnly() {
+    std::cout << "Testing append-only records..." << std::endl;
     
     ElectionData data;
     ElectionRecord record("TestCountry", 2020, "TestConstituency", 
                          "TestCandidate", "TestParty", 1000, false);
     
-    data.insertRecord(record);
+    data.addRecord(record);
+    unsigned long long version = data.getVersion();
     
-    // Update record
     record.votes = 2000;
     record.elected = true;
-    assert(data.updateRecord(record) == true);
-    
-    const ElectionRecord* updated = data.getRecord("TestCountry", 2020, 
-                                                   "TestConstituency", "TestCandidate");
-    assert(updated != nullptr);
-    assert(updated->votes == 2000);
-    assert(updated->elected == true);
+    data.addRecord(record);
+    assert(data.getVersion() > version);
     
-    // Test update non-existent record
-    ElectionRecord fake("Fake", 2020, "Fake", "Fake", "Fake", 0, false);
-    assert(data.updateRecord(fake) == false);
+    assert(data.getTotalRecords() == 2);
+    assert(data.getRecord(0).votes == 1000);
+    assert(data.getRecord(0).elected == false);
+    assert(data.getRecord(1).votes == 2000);
+    assert(data.getRecord(1).elected == true);
     
     std::cout << "  ✓ Passed" << std::endl;
 }
@@ -70,9 +100,9 @@ void testGetElectionRecords() {
     ElectionData data;
     
     // Insert multiple records for same election
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand1", "Party1", 1000, true));
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand2", "Party2", 2000, true));
-    data.insertRecord(ElectionRecord("TestCountry", 2021, "Const1", "Cand3", "Party1", 1500, false));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand1", "Party1", 1000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand2", "Party2", 2000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2021, "Const1", "Cand3", "Party1", 1500, false));
     
     std::vector<ElectionRecord> records2020 = data.getElectionRecords("TestCountry", 2020);
     assert(records2020.size() == 2);
@@ -91,9 +121,9 @@ void testGetPartyRecords() {
     
     ElectionData data;
     
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand1", "Party1", 1000, true));
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand2", "Party1", 2000, true));
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const3", "Cand3", "Party2", 1500, false));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand1", "Party1", 1000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand2", "Party1", 2000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const3", "Cand3", "Party2", 1500, false));
     
     std::vector<ElectionRecord> party1Records = data.getPartyRecords("TestCountry", 2020, "Party1");
     assert(party1Records.size() == 2);
@@ -112,11 +142,11 @@ void testStatistics() {
     
     ElectionData data;
     
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand1", "Party1", 1000, true));
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand2", "Party1", 2000, true));
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const3", "Cand3", "Party2", 1500, false));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand1", "Party1", 1000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand2", "Party1", 2000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const3", "Cand3", "Party2", 1500, false));
     
-    int totalVotes = ElectionAnalyzer::calculateTotalVotes(data, "TestCountry", 2020);
+    long long totalVotes = ElectionAnalyzer::calculateTotalVotes(data, "TestCountry", 2020);
     assert(totalVotes == 4500);
     
     int totalSeats = ElectionAnalyzer::calculateTotalSeats(data, "TestCountry", 2020);
@@ -139,9 +169,9 @@ void testPartyVoteShares() {
     
     ElectionData data;
     
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand1", "Party1", 1000, true));
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand2", "Party1", 2000, true));
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const3", "Cand3", "Party2", 1500, false));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand1", "Party1", 1000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand2", "Party1", 2000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const3", "Cand3", "Party2", 1500, false));
     
     std::vector<PartyStats> partyStats = ElectionAnalyzer::calculatePartyVoteShares(data, "TestCountry", 2020);
     
@@ -172,24 +202,324 @@ void testComparativeAnalysis() {
     ElectionData data;
     
     // 2020 election
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand1", "Party1", 1000, true));
-    data.insertRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand2", "Party2", 2000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand1", "Party1", 1000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand2", "Party2", 2000, true));
     
     // 2021 election
-    data.insertRecord(ElectionRecord("TestCountry", 2021, "Const1", "Cand3", "Party1", 1500, true));
-    data.insertRecord(ElectionRecord("TestCountry", 2021, "Const2", "Cand4", "Party2", 2500, true));
-    data.insertRecord(ElectionRecord("TestCountry", 2021, "Const3", "Cand5", "Party3", 1000, false));
+    data.addRecord(ElectionRecord("TestCountry", 2021, "Const1", "Cand3", "Party1", 1500, true));
+    data.addRecord(ElectionRecord("TestCountry", 2021, "Const2", "Cand4", "Party2", 2500, true));
+    data.addRecord(ElectionRecord("TestCountry", 2021, "Const3", "Cand5", "Party3", 1000, false));
     
     ComparativeAnalysis analysis = ElectionAnalyzer::compareElections(data, "TestCountry", 2020, 2021);
     
     assert(analysis.voteChange == 2000); // 5000 - 3000
-    assert(analysis.partyVoteChanges["Party1"] == 500); // 1500 - 1000
-    assert(analysis.partyVoteChanges["Party2"] == 500); // 2500 - 2000
+    
+    int party1Change = 0;
+    int party2Change = 0;
+    for (const auto& change : analysis.partyChanges) {
+        if (change.party == "Party1") party1Change = change.voteChange;
+        if (change.party == "Party2") party2Change = change.voteChange;
+    }
+    assert(party1Change == 500); // 1500 - 1000
+    assert(party2Change == 500); // 2500 - 2000
     assert(analysis.newParties.size() == 1); // Party3 is new
     
     std::cout << "  ✓ Passed" << std::endl;
 }
 
+/**
+ * @brief Test streaming vote distribution
+ */
+void testVoteDistribution() {
+    std::cout << "Testing vote distribution..." << std::endl;
+    
+    ElectionData data;
+    
+    for (int i = 1; i <= 100; i++) {
+        std::string constituency = "Const" + std::to_string(i % 4);
+        data.addRecord(ElectionRecord("TestCountry", 2020, constituency, "Cand" + std::to_string(i), "Party1", i * 100, false));
+    }
+    
+    ElectionDistribution dist = ElectionAnalyzer::getVoteDistribution(data, "TestCountry", 2020, 5);
+    assert(dist.candidates.count == 100);
+    assert(dist.candidates.min == 100);
+    assert(dist.candidates.max == 10000);
+    assert(dist.candidates.p50 > 4900 && dist.candidates.p50 < 5200); // within 1% of 5000
+    assert(dist.candidates.p90 > 8900 && dist.candidates.p90 < 9200);
+    assert(dist.candidates.histogram.size() == 5);
+    
+    long long binTotal = 0;
+    for (const auto& bin : dist.candidates.histogram) {
+        binTotal += bin.count;
+    }
+    assert(binTotal == 100);
+    
+    assert(dist.constituencies.count == 4);
+    
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+/**
+ * @brief Test fuzzy name search
+ */
+void testNameSearch() {
+    std::cout << "Testing fuzzy name search..." << std::endl;
+    
+    ElectionData data;
+    
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Amman 1", "Musa Hattar", "Islamic Action Front", 1000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Amman 2", "Ahmad Al-Safadi", "National Charter Party", 2000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2021, "Amman 1", "Musa Hattar", "Islamic Action Front", 1500, false));
+    
+    // Typo still finds the candidate in both elections
+    std::vector<SearchResult> results = ElectionAnalyzer::searchNames(data, "musa hatar", 5);
+    assert(!results.empty());
+    assert(results[0].field == "candidate");
+    assert(results[0].name == "Musa Hattar");
+    assert(results[0].elections.size() == 2);
+    assert(results[0].records.size() == 2);
+    
+    // Partial party name
+    results = ElectionAnalyzer::searchNames(data, "islamic", 5);
+    assert(!results.empty());
+    assert(results[0].field == "party");
+    assert(results[0].name == "Islamic Action Front");
+    
+    // Nothing similar
+    results = ElectionAnalyzer::searchNames(data, "zzzz", 5);
+    assert(results.empty());
+    
+    // The limit caps the matches; a non-positive one means none, not all
+    assert(ElectionAnalyzer::searchNames(data, "amman", 1).size() == 1);
+    assert(ElectionAnalyzer::searchNames(data, "amman", 0).empty());
+    assert(ElectionAnalyzer::searchNames(data, "amman", -1).empty());
+    
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+/**
+ * @brief Test candidate history and incumbency
+ */
+void testCandidateHistory() {
+    std::cout << "Testing candidate history and incumbency..." << std::endl;
+    
+    ElectionData data;
+    
+    data.addRecord(ElectionRecord("TestCountry", 2016, "Const1", "Cand One", "Party1", 1000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2016, "Const2", "Cand Two", "Party2", 2000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const1", "cand one", "Party1", 1500, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand Two", "Party2", 900, false));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand Three", "Party3", 1900, true));
+    data.addRecord(ElectionRecord("TestCountry", 2024, "Const1", "Cand Three", "Party3", 1900, true));
+    
+    // Names are matched after normalization
+    CandidateHistory history = ElectionAnalyzer::getCandidateHistory(data, "CAND ONE", "");
+    assert(history.records.size() == 2);
+    assert(history.electionsContested == 2);
+    assert(history.seatsWon == 2);
+    assert(history.records[0].year == 2016);
+    
+    // Party filter
+    history = ElectionAnalyzer::getCandidateHistory(data, "Cand One", "Party2");
+    assert(history.records.empty());
+    
+    std::vector<IncumbencyStats> trend = ElectionAnalyzer::calculateIncumbencyTrend(data, "TestCountry");
+    assert(trend.size() == 2);
+    assert(trend[0].year == 2020 && trend[0].previousYear == 2016);
+    assert(trend[0].incumbents == 2);
+    assert(trend[0].incumbentsStanding == 2);
+    assert(trend[0].reelected == 1);
+    assert(trend[1].incumbents == 2);
+    assert(trend[1].reelected == 1);
+    
+    // Case and spacing variants of one winner are one incumbent
+    data.addRecord(ElectionRecord("TestCountry", 2016, "Const3", "CAND  two", "Party2", 800, true));
+    trend = ElectionAnalyzer::calculateIncumbencyTrend(data, "TestCountry");
+    assert(trend[0].incumbents == 2);
+    assert(trend[0].incumbentsStanding == 2);
+    
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+/**
+ * @brief Test cube roll-up, drill-down and slicing
+ */
+void testElectionCube() {
+    std::cout << "Testing aggregation cube..." << std::endl;
+    
+    ElectionData data;
+    
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand1", "Party1", 1000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand2", "Party1", 2000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand3", "Party2", 1500, false));
+    data.addRecord(ElectionRecord("TestCountry", 2021, "Const1", "Cand4", "Party2", 500, true));
+    data.addRecord(ElectionRecord("OtherCountry", 2020, "Const1", "Cand5", "Party1", 700, true));
+    
+    // Roll-up of one election
+    CubeSlice slice;
+    slice.country = "TestCountry";
+    slice.year = 2020;
+    CubeCell total = data.getCubeTotal(slice);
+    assert(total.votes == 4500);
+    assert(total.seats == 2);
+    assert(total.candidates == 3);
+    assert(total.constituencies == 2);
+    
+    // Drill down to parties
+    std::vector<CubeCell> parties = data.queryCube(ElectionCube::Party, slice);
+    assert(parties.size() == 2);
+    assert(parties[0].party == "Party1" && parties[0].votes == 3000 && parties[0].constituencies == 2);
+    
+    // Slice on party only, grouped by country
+    CubeSlice partySlice;
+    partySlice.party = "Party1";
+    std::vector<CubeCell> byCountry = data.queryCube(ElectionCube::parseDimensions("country"), partySlice);
+    assert(byCountry.size() == 2);
+    assert(byCountry[0].country == "OtherCountry" && byCountry[0].votes == 700);
+    
+    // Same-named constituencies in different countries are distinct
+    assert(data.getCubeTotal(CubeSlice()).constituencies == 3);
+    std::vector<CubeCell> byName = data.queryCube(ElectionCube::Constituency, CubeSlice());
+    assert(byName.size() == 2);
+    assert(byName[0].constituency == "Const1" && byName[0].constituencies == 2 && byName[0].candidates == 3);
+    
+    // Unknown names match nothing
+    CubeSlice unknown;
+    unknown.party = "NoSuchParty";
+    assert(data.queryCube(ElectionCube::Country, unknown).empty());
+    
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+/**
+ * @brief Test that the one-pass dashboard matches the separate queries
+ */
+void testDashboard() {
+    std::cout << "Testing election dashboard..." << std::endl;
+    
+    ElectionData data;
+    
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand1", "Party1", 1000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const1", "Cand2", "Party2", 800, false));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand3", "Party2", 2000, true));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const2", "Cand4", "Party1", 1500, false));
+    data.addRecord(ElectionRecord("TestCountry", 2020, "Const3", "Cand5", "Party2", 1200, true));
+    data.addRecord(ElectionRecord("TestCountry", 2021, "Const1", "Cand6", "Party1", 9000, true));
+    
+    ElectionDashboard dashboard = ElectionAnalyzer::buildDashboard(data, "TestCountry", 2020, 3);
+    ElectionStats stats = ElectionAnalyzer::calculateElectionStats(data, "TestCountry", 2020);
+    assert(dashboard.stats.totalVotes == stats.totalVotes);
+    assert(dashboard.stats.totalSeats == 3);
+    assert(dashboard.stats.constituencies == 3);
+    assert(dashboard.stats.partyStats.size() == stats.partyStats.size());
+    assert(dashboard.stats.partyStats[0].party == "Party2");
+    
+    std::vector<SeatInfo> seats = ElectionAnalyzer::getSeatDistribution(data, "TestCountry", 2020);
+    assert(dashboard.seats.size() == seats.size());
+    for (size_t i = 0; i < seats.size(); i++) {
+        assert(dashboard.seats[i].party == seats[i].party && dashboard.seats[i].seats == seats[i].seats);
+    }
+    
+    std::vector<ElectionRecord> top = ElectionAnalyzer::getTopCandidates(data, "TestCountry", 2020, 3);
+    assert(dashboard.topCandidates.size() == 3);
+    for (size_t i = 0; i < top.size(); i++) {
+        assert(dashboard.topCandidates[i].candidate == top[i].candidate);
+    }
+    
+    assert(dashboard.winners.size() == 3);
+    assert(dashboard.winners[0].candidate == "Cand3");
+    
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+/**
+ * @brief Test JSON writer separators, escaping and number formatting
+ */
+void testJSONWriter() {
+    std::cout << "Testing JSON writer..." << std::endl;
+    
+    std::string out;
+    JSONWriter json(out);
+    json.beginObject();
+    json.field("party", "Al \"Wasat\" \\ Party");
+    json.field("votes", 1200);
+    json.field("share", 12.5);
+    json.field("elected", true);
+    json.key("years").beginArray().value(2016).value(2020).endArray();
+    json.key("empty").beginObject().endObject();
+    json.endObject();
+    assert(out == "{\"party\":\"Al \\\"Wasat\\\" \\\\ Party\",\"votes\":1200,\"share\":12.5,"
+                  "\"elected\":true,\"years\":[2016,2020],\"empty\":{}}");
+    
+    // Control characters; long clean runs take the word-at-a-time path
+    out.clear();
+    std::string raw = "line1\nline2\ttab\x01 and a long clean tail";
+    JSONWriter::escape(out, raw.data(), raw.length());
+    assert(out == "\"line1\\nline2\\ttab\\u0001 and a long clean tail\"");
+    
+    // Non-finite numbers are not valid JSON
+    out.clear();
+    JSONWriter(out).value(std::nan(""));
+    assert(out == "null");
+    
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+/**
+ * @brief Test MessagePack and CBOR encoding
+ */
+void testBinaryWriter() {
+    std::cout << "Testing binary writer..." << std::endl;
+    
+    auto bytes = [](std::initializer_list<unsigned char> list) { return std::string(list.begin(), list.end()); };
+    auto write = [](std::string& out, BinaryFormat format) {
+        BinaryWriter writer(out, format);
+        writer.beginObject();
+        writer.field("party", "Wasat");
+        writer.field("votes", 1200);
+        writer.field("share", 12.5);
+        writer.field("elected", true);
+        writer.key("years").beginArray().value(2016).value(-40).endArray();
+        writer.key("empty").beginObject().endObject();
+        writer.endObject();
+    };
+    
+    std::string out;
+    write(out, BinaryFormat::MessagePack);
+    assert(out == bytes({0x86, 0xa5}) + "party" + bytes({0xa5}) + "Wasat" +
+                  bytes({0xa5}) + "votes" + bytes({0xcd, 0x04, 0xb0}) +
+                  bytes({0xa5}) + "share" + bytes({0xcb, 0x40, 0x29, 0, 0, 0, 0, 0, 0}) +
+                  bytes({0xa7}) + "elected" + bytes({0xc3}) +
+                  bytes({0xa5}) + "years" + bytes({0x92, 0xcd, 0x07, 0xe0, 0xd0, 0xd8}) +
+                  bytes({0xa5}) + "empty" + bytes({0x80}));
+    
+    out.clear();
+    write(out, BinaryFormat::CBOR);
+    assert(out == bytes({0xa6, 0x65}) + "party" + bytes({0x65}) + "Wasat" +
+                  bytes({0x65}) + "votes" + bytes({0x19, 0x04, 0xb0}) +
+                  bytes({0x65}) + "share" + bytes({0xfb, 0x40, 0x29, 0, 0, 0, 0, 0, 0}) +
+                  bytes({0x67}) + "elected" + bytes({0xf5}) +
+                  bytes({0x65}) + "years" + bytes({0x82, 0x19, 0x07, 0xe0, 0x38, 0x27}) +
+                  bytes({0x65}) + "empty" + bytes({0xa0}));
+    
+    // Containers past the one-byte header get a longer one inserted on close
+    out.clear();
+    BinaryWriter writer(out, BinaryFormat::MessagePack);
+    writer.beginArray();
+    for (int i = 0; i < 20; i++) {
+        writer.null();
+    }
+    writer.endArray();
+    assert(out.length() == 23 && out.compare(0, 3, bytes({0xdc, 0x00, 0x14})) == 0);
+    
+    // Non-finite numbers become null, as in JSON
+    out.clear();
+    BinaryWriter(out, BinaryFormat::CBOR).value(std::nan(""));
+    assert(out == bytes({0xf6}));
+    
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
 /**
  * @brief Test CSV reading
  */
@@ -214,6 +544,715 @@ void testCSVReading() {
     }
 }
 
+/**
+ * @brief Test validation of ingested CSV rows
+ */
+void testCSVRowValidation() {
+    std::cout << "Testing CSV row validation..." << std::endl;
+    
+    ElectionRecord record;
+    assert(CSVReader::tryParseLine("Jordan, 2016, Amman 1, Musa Hattar, IAF, 42000, Yes", record));
+    assert(record.year == 2016 && record.votes == 42000 && record.elected);
+    assert(CSVReader::tryParseLine("Jordan,2016,Amman 1,Musa Hattar,IAF,2147483647,No", record));
+    assert(record.votes == 2147483647);
+    
+    // Wrong column count
+    assert(!CSVReader::tryParseLine("Jordan,2016,Amman 1,Musa Hattar,IAF,42000", record));
+    assert(!CSVReader::tryParseLine("Jordan,2016,Amman 1,Musa Hattar,IAF,42000,Yes,extra", record));
+    
+    // Counts that are not plain digits or do not fit
+    assert(!CSVReader::tryParseLine("Jordan,2016,Amman 1,Musa Hattar,IAF,2147483648,No", record));
+    assert(!CSVReader::tryParseLine("Jordan,2016,Amman 1,Musa Hattar,IAF,-5,No", record));
+    assert(!CSVReader::tryParseLine("Jordan,2016,Amman 1,Musa Hattar,IAF,12x,No", record));
+    assert(!CSVReader::tryParseLine("Jordan,2016,Amman 1,Musa Hattar,IAF,,No", record));
+    assert(!CSVReader::tryParseLine("Jordan,20x6,Amman 1,Musa Hattar,IAF,1,No", record));
+    assert(!CSVReader::tryParseLine("Jordan,0,Amman 1,Musa Hattar,IAF,1,No", record));
+    
+    // Required names
+    assert(!CSVReader::tryParseLine(",2016,Amman 1,Musa Hattar,IAF,1,No", record));
+    assert(!CSVReader::tryParseLine("Jordan,2016,Amman 1, ,IAF,1,No", record));
+    
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+/**
+ * @brief Test that totals of ingested counts near INT_MAX do not overflow
+ */
+void testLargeVoteCounts() {
+    std::cout << "Testing large vote counts..." << std::endl;
+    
+    ElectionData data;
+    std::vector<ElectionRecord> batch(3);
+    assert(CSVReader::tryParseLine("Jordan,2016,Amman 1,Cand1,Party1,2147483647,Yes", batch[0]));
+    assert(CSVReader::tryParseLine("Jordan,2016,Amman 1,Cand2,Party1,2147483647,No", batch[1]));
+    assert(CSVReader::tryParseLine("Jordan,2016,Amman 2,Cand3,Party2,2147483647,Yes", batch[2]));
+    data.addRecords(batch);
+    data.addRecord(ElectionRecord("Jordan", 2020, "Amman 1", "Cand1", "Party1", 1, true));
+    
+    const long long max = 2147483647LL;
+    assert(ElectionAnalyzer::calculateTotalVotes(data, "Jordan", 2016) == 3 * max);
+    
+    ElectionStats stats = ElectionAnalyzer::calculateElectionStats(data, "Jordan", 2016);
+    assert(stats.totalVotes == 3 * max);
+    assert(stats.partyStats.size() == 2);
+    assert(stats.partyStats[0].party == "Party1" && stats.partyStats[0].totalVotes == 2 * max);
+    assert(std::fabs(stats.partyStats[0].voteShare - 200.0 / 3) < 0.01);
+    
+    ElectionDashboard dashboard = ElectionAnalyzer::buildDashboard(data, "Jordan", 2016, 10);
+    assert(dashboard.stats.totalVotes == 3 * max);
+    assert(dashboard.stats.partyStats[0].totalVotes == 2 * max);
+    
+    ComparativeAnalysis analysis = ElectionAnalyzer::compareElections(data, "Jordan", 2016, 2020);
+    assert(analysis.voteChange == 1 - 3 * max);
+    
+    ElectionDistribution dist = ElectionAnalyzer::getVoteDistribution(data, "Jordan", 2016, 5);
+    assert(dist.constituencies.count == 2);
+    assert(dist.constituencies.max > 1.99 * max); // Amman 1, within the sketch's 1%
+    
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+static std::string readBytes(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+static void writeBytes(const std::string& path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << bytes;
+}
+
+static std::vector<ElectionRecord> walBatch(const std::string& candidate, int votes) {
+    return std::vector<ElectionRecord>(1, ElectionRecord("Jordan", 2016, "Amman 1", candidate, "IAF", votes, false));
+}
+
+static int replayedRecords(const std::string& logPath, const std::string& basePath) {
+    WriteAheadLog wal(logPath, basePath, 0);
+    ElectionData data;
+    if (!wal.open() || !wal.load(data)) {
+        return -1;
+    }
+    return data.getTotalRecords();
+}
+
+/**
+ * @brief Test write-ahead log replay, tail repair and compaction
+ */
+void testWriteAheadLog() {
+    std::cout << "Testing write-ahead log..." << std::endl;
+    
+    std::string dir = std::filesystem::temp_directory_path().string() + "/";
+    std::string logPath = dir + "election_tests.wal";
+    std::string basePath = dir + "election_tests.csv";
+    std::remove(logPath.c_str());
+    std::remove(basePath.c_str());
+    
+    // Round trip: acknowledged batches come back in order
+    {
+        WriteAheadLog wal(logPath, basePath, 0);
+        assert(wal.open());
+        assert(wal.append(walBatch("Cand1", 100)));
+        std::vector<ElectionRecord> two = walBatch("Cand2", 200);
+        two.push_back(ElectionRecord("Jordan", 2020, "Irbid 2", "Cand3", "Independent", 2147483647, true));
+        assert(wal.append(two));
+        assert(wal.getStats().records == 3);
+    }
+    {
+        WriteAheadLog wal(logPath, basePath, 0);
+        ElectionData data;
+        assert(wal.open() && wal.load(data));
+        assert(wal.getStats().replayed == 3);
+        std::vector<ElectionRecord> records = data.getElectionRecords("Jordan", 2020);
+        assert(records.size() == 1);
+        assert(records[0].candidate == "Cand3" && records[0].votes == 2147483647 && records[0].elected);
+    }
+    std::string intact = readBytes(logPath);
+    
+    // A torn frame and a frame failing its CRC are cut off on open
+    writeBytes(logPath, intact + std::string("\x30\0\0\0\1\2", 6));
+    assert(replayedRecords(logPath, basePath) == 3);
+    assert(readBytes(logPath) == intact);
+    {
+        WriteAheadLog wal(logPath, basePath, 0);
+        assert(wal.open());
+        assert(wal.append(walBatch("Cand4", 400)));
+    }
+    std::string corrupt = readBytes(logPath);
+    corrupt[corrupt.length() - 2] ^= 0x55;
+    writeBytes(logPath, corrupt);
+    assert(replayedRecords(logPath, basePath) == 3);
+    assert(readBytes(logPath) == intact);
+    
+    // Compaction folds the log into the base and empties the log; the
+    // copy kept here is the log as it was before
+    {
+        WriteAheadLog wal(logPath, basePath, 1);
+        assert(wal.open());
+        assert(wal.append(walBatch("Cand5", 500)));
+        wal.close();
+        assert(wal.getStats().compactions == 1);
+    }
+    std::string compacted = readBytes(logPath);
+    assert(compacted.length() < intact.length());
+    assert(readBytes(basePath).find("Jordan,2016,Amman 1,Cand5,IAF,500,No") != std::string::npos);
+    assert(replayedRecords(logPath, basePath) == 4);
+    {
+        WriteAheadLog wal(logPath, basePath, 0);
+        ElectionData data;
+        assert(wal.open() && wal.load(data));
+        assert(wal.getStats().replayed == 0);
+    }
+    
+    // Crash after the new base was renamed into place but before the log
+    // was emptied: the old log, with the new base named in its header
+    // (bytes 20-31; bytes 8-19 identify the base the log sits on)
+    std::string crashed = intact;
+    crashed.replace(20, 12, compacted, 8, 12);
+    writeBytes(logPath, crashed);
+    assert(replayedRecords(logPath, basePath) == 4);
+    assert(readBytes(logPath) == compacted);
+    
+    // A log is never replayed onto a base it was not written on
+    writeBytes(basePath, readBytes(basePath) + "Jordan,2016,Amman 1,Cand6,IAF,600,No\n");
+    {
+        WriteAheadLog wal(logPath, basePath, 0);
+        assert(!wal.open());
+    }
+    writeBytes(basePath, "");
+    {
+        WriteAheadLog wal(logPath, basePath, 0);
+        assert(!wal.open());
+    }
+    
+    std::remove(logPath.c_str());
+    std::remove(basePath.c_str());
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+static void feed(RequestParser& parser, const std::string& bytes) {
+    std::memcpy(parser.prepare(bytes.length()), bytes.data(), bytes.length());
+    parser.commit(bytes.length());
+}
+
+static std::string parseError(size_t maxHeaderSize, size_t maxBodySize, const std::string& bytes) {
+    BufferPool pool(256, 1);
+    RequestParser parser(&pool, maxHeaderSize, maxBodySize);
+    HTTPRequest request;
+    feed(parser, bytes);
+    return parser.next(request) == RequestParser::Status::Error ? parser.errorStatus() : "";
+}
+
+/**
+ * @brief Test incremental request parsing and its limits
+ */
+void testRequestParser() {
+    std::cout << "Testing request parser..." << std::endl;
+    
+    // Small buffers, so prepare() has to move and grow them
+    BufferPool pool(64, 4);
+    HTTPRequest request;
+    {
+        // Header terminator split across two reads
+        RequestParser parser(&pool, 1024, 1024);
+        feed(parser, "GET /api/countries HTTP/1.1\r\nHost: localhost\r\nX-Test:  padded \r\n\r");
+        assert(parser.next(request) == RequestParser::Status::Incomplete);
+        feed(parser, "\n");
+        assert(parser.next(request) == RequestParser::Status::Complete);
+        assert(request.method == "GET" && request.path == "/api/countries" && request.version == "HTTP/1.1");
+        assert(request.headers["host"] == "localhost" && request.headers["x-test"] == "padded");
+        assert(parser.next(request) == RequestParser::Status::Incomplete);
+        assert(parser.buffered() == 0);
+    }
+    // Everything was consumed, so the buffer went back to the pool
+    assert(pool.pooled() == 1);
+    
+    {
+        // Pipelined requests, one with a body, the last one cut short
+        RequestParser parser(&pool, 1024, 1024);
+        feed(parser, "POST /api/batch HTTP/1.1\r\nContent-Length: 5\r\n\r\nhelloGET /a HTTP/1.1\r\n\r\nGET /b HT");
+        assert(parser.next(request) == RequestParser::Status::Complete);
+        assert(request.method == "POST" && request.body == "hello");
+        assert(parser.next(request) == RequestParser::Status::Complete);
+        assert(request.path == "/a" && request.body.empty());
+        assert(parser.next(request) == RequestParser::Status::Incomplete);
+        feed(parser, "TP/1.1\r\n\r\n");
+        assert(parser.next(request) == RequestParser::Status::Complete);
+        assert(request.path == "/b");
+        
+        // A body arriving after its headers
+        feed(parser, "POST /c HTTP/1.1\r\nContent-Length: 3\r\n\r\n");
+        assert(parser.next(request) == RequestParser::Status::Incomplete);
+        feed(parser, "abc");
+        assert(parser.next(request) == RequestParser::Status::Complete);
+        assert(request.path == "/c" && request.body == "abc");
+    }
+    
+    // Headers too large, with and without a terminator yet
+    assert(parseError(32, 1024, "GET /" + std::string(64, 'a')) == "431 Request Header Fields Too Large");
+    assert(parseError(32, 1024, "GET /" + std::string(64, 'a') + " HTTP/1.1\r\n\r\n") ==
+           "431 Request Header Fields Too Large");
+    // Bodies too large, without a length, or with a bad one
+    assert(parseError(1024, 16, "POST / HTTP/1.1\r\nContent-Length: 17\r\n\r\n") == "413 Payload Too Large");
+    assert(parseError(1024, 16, "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n") == "411 Length Required");
+    assert(parseError(1024, 16, "POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n") == "400 Bad Request");
+    assert(parseError(1024, 16, "\r\n\r\n") == "400 Bad Request");
+    
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+/**
+ * @brief Test the static asset cache: lookups, ETags, gzip variants and reloads
+ */
+void testStaticAssetCache() {
+    std::cout << "Testing static asset cache..." << std::endl;
+    
+    std::string root = std::filesystem::temp_directory_path().string() + "/election_tests_web";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root + "/img");
+    writeBytes(root + "/index.html", "<html>results</html>");
+    std::string script;
+    for (int i = 0; i < 200; i++) {
+        script += "console.log('refresh');\n";
+    }
+    writeBytes(root + "/app.js", script);
+    writeBytes(root + "/img/logo.png", std::string("\x89PNG\r\n", 6));
+    
+    StaticAssetCache cache(root, true);
+    cache.load();
+    assert(cache.assetCount() == 3);
+    assert(cache.find("/missing.css") == nullptr);
+    
+    // "/" is the index page; headers are built up front
+    std::shared_ptr<const StaticAsset> index = cache.find("/");
+    assert(index && index->contentType == "text/html" && index->body == "<html>results</html>");
+    assert(index->okHeaders.compare(0, 17, "HTTP/1.1 200 OK\r\n") == 0);
+    assert(index->okHeaders.find("Content-Length: 20\r\n") != std::string::npos);
+    assert(index->notModifiedHeaders.compare(0, 27, "HTTP/1.1 304 Not Modified\r\n") == 0);
+    assert(cache.find("/img/logo.png")->contentType == "image/png");
+    
+    // If-None-Match lists, weak prefixes and the wildcard
+    assert(index->matches(index->etag));
+    assert(index->matches("\"other\", W/" + index->etag));
+    assert(index->matches("*"));
+    assert(!index->matches("\"other\""));
+    assert(!index->matches(""));
+    
+    // Text is gzipped once, under its own ETag, when that saves space
+    std::shared_ptr<const StaticAsset> app = cache.find("/app.js");
+#ifdef ELECTION_HAVE_ZLIB
+    assert(app->gzipped && app->gzipped->size < app->size);
+    assert(app->gzipped->etag != app->etag);
+    assert(app->gzipped->okHeaders.find("Content-Encoding: gzip\r\n") != std::string::npos);
+    assert(app->okHeaders.find("Vary: Accept-Encoding\r\n") != std::string::npos);
+#endif
+    assert(!cache.find("/img/logo.png")->gzipped);
+    
+    // A reload swaps in new contents; assets already handed out stay valid
+    writeBytes(root + "/index.html", "<html>updated</html>");
+    cache.load();
+    assert(cache.find("/index.html")->body == "<html>updated</html>");
+    assert(cache.find("/index.html")->etag != index->etag);
+    assert(index->body == "<html>results</html>");
+    
+    std::filesystem::remove_all(root);
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+#ifndef _WIN32
+// Everything readable from a non-blocking socket right now
+static std::string drainSocket(int fd) {
+    std::string received;
+    char chunk[65536];
+    ssize_t n;
+    while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+        received.append(chunk, n);
+    }
+    return received;
+}
+#endif
+
+/**
+ * @brief Test queued response segments, streams and partial writes
+ */
+void testOutputQueue() {
+    std::cout << "Testing output queue..." << std::endl;
+    
+    // Small strings merge; shared buffers stay separate and alive
+    OutputQueue queue;
+    queue.append(std::string("HTTP/1.1 200 OK\r\n"));
+    queue.append("\r\n", 2);
+    auto owner = std::make_shared<std::string>("shared body|");
+    queue.appendShared(owner->data(), owner->length(), owner);
+    int pieces = 0;
+    queue.appendStream([&pieces](std::string& out) {
+        out += "piece" + std::to_string(++pieces) + "|";
+        return pieces < 3;
+    });
+    queue.append(std::string("tail"));
+    assert(!queue.empty());
+    // Streamed bytes only count once produced
+    assert(queue.pending() == 19 + owner->length() + 4);
+    assert(pieces == 0);
+    
+#ifndef _WIN32
+    int fds[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    
+#ifdef __linux__
+    // Memory segments in front of the stream are gathered together
+    iovec iov[8];
+    bool all = true;
+    assert(queue.gather(iov, 8, all) == 2 && !all);
+#endif
+    
+    assert(queue.flush(fds[0]) == OutputQueue::FlushResult::Done);
+    assert(queue.empty() && queue.pending() == 0 && pieces == 3);
+    assert(drainSocket(fds[1]) == "HTTP/1.1 200 OK\r\n\r\nshared body|piece1|piece2|piece3|tail");
+    
+#ifdef __linux__
+    // File ranges go out with sendfile
+    std::string path = std::filesystem::temp_directory_path().string() + "/election_tests_output.bin";
+    writeBytes(path, "0123456789");
+    queue.append(std::string("["));
+    queue.appendFile(std::make_shared<SharedFile>(::open(path.c_str(), O_RDONLY)), 2, 5);
+    queue.append(std::string("]"));
+    assert(queue.flush(fds[0]) == OutputQueue::FlushResult::Done);
+    assert(drainSocket(fds[1]) == "[23456]");
+    std::remove(path.c_str());
+#endif
+    
+    // A full socket leaves the rest queued until it is writable again
+    std::string big(8 * 1024 * 1024, 'x');
+    queue.append(std::string(big));
+    assert(queue.flush(fds[0]) == OutputQueue::FlushResult::WouldBlock);
+    assert(queue.pending() > 0 && queue.pending() < big.length());
+    std::string received;
+    while (true) {
+        received += drainSocket(fds[1]);
+        OutputQueue::FlushResult result = queue.flush(fds[0]);
+        assert(result != OutputQueue::FlushResult::Error);
+        if (result == OutputQueue::FlushResult::Done) break;
+    }
+    received += drainSocket(fds[1]);
+    assert(received == big);
+    
+    // A closed peer is an error, not a signal
+    queue.append(std::string("late"));
+    close(fds[1]);
+    assert(queue.flush(fds[0]) == OutputQueue::FlushResult::Error);
+    close(fds[0]);
+#endif
+    
+    queue.clear();
+    assert(queue.empty() && queue.pending() == 0);
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+static std::shared_ptr<const CachedResponse> cachedResponse(const std::string& body, unsigned long long version) {
+    auto response = std::make_shared<CachedResponse>();
+    response->body = body;
+    response->dataVersion = version;
+    return response;
+}
+
+/**
+ * @brief Test response cache keys, LRU eviction and version invalidation
+ */
+void testResponseCache() {
+    std::cout << "Testing response cache..." << std::endl;
+    
+    // Parameter order does not matter; values cannot forge other parameters
+    std::map<std::string, std::string> params = {{"year", "2016"}, {"country", "Jordan"}};
+    assert(ResponseCache::makeKey("/api/stats", params) ==
+           ResponseCache::makeKey("/api/stats", {{"country", "Jordan"}, {"year", "2016"}}));
+    assert(ResponseCache::makeKey("/api/stats", params) != ResponseCache::makeKey("/api/dashboard", params));
+    assert(ResponseCache::makeKey("/api/x", {{"a", "1\n1:b1:2"}}) !=
+           ResponseCache::makeKey("/api/x", {{"a", "1"}, {"b", "2"}}));
+    
+    // Room for two of these entries but not three
+    std::string body(200, 'x');
+    ResponseCache cache(2 * (200 + 160 + 8) + 100);
+    cache.insert("/key/a", cachedResponse(body, 1));
+    cache.insert("/key/b", cachedResponse(body, 1));
+    assert(cache.find("/key/a", 1));        // a is now the most recent
+    cache.insert("/key/c", cachedResponse(body, 1));
+    assert(cache.find("/key/b", 1) == nullptr);
+    assert(cache.find("/key/a", 1) && cache.find("/key/c", 1));
+    
+    ResponseCacheStats stats = cache.getStats();
+    assert(stats.entries == 2 && stats.evictions == 1);
+    assert(stats.hits == 3 && stats.misses == 1);
+    assert(stats.bytes <= stats.capacityBytes);
+    
+    // Entries built from an older version are dropped on lookup
+    assert(cache.find("/key/a", 2) == nullptr);
+    assert(cache.getStats().entries == 1);
+    
+    // Replacing an entry does not count it twice; oversized ones are not kept
+    cache.insert("/key/c", cachedResponse("short", 2));
+    assert(cache.find("/key/c", 2)->body == "short");
+    cache.insert("/key/d", cachedResponse(std::string(2000, 'y'), 2));
+    assert(cache.find("/key/d", 2) == nullptr);
+    assert(cache.getStats().entries == 1);
+    
+    cache.clear();
+    assert(cache.getStats().entries == 0 && cache.getStats().bytes == 0);
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+/**
+ * @brief Test live delta fan-out to subscribers
+ */
+void testLiveHub() {
+    std::cout << "Testing live hub..." << std::endl;
+    
+    auto data = std::make_shared<ElectionData>();
+    data->addRecord(ElectionRecord("Jordan", 2016, "Amman 1", "Cand1", "Party1", 100, true));
+    data->addRecord(ElectionRecord("Jordan", 2016, "Amman 2", "Cand2", "Party2", 200, false));
+    LiveHub hub(data);
+    data->setChangeListener([&hub](const ElectionRecord& record) { hub.publish(record); });
+    
+    // The first event is a snapshot of every party
+    std::shared_ptr<LiveSubscription> first = hub.subscribe("Jordan", 2016);
+    std::shared_ptr<LiveSubscription> second = hub.subscribe("Jordan", 2016);
+    std::deque<std::shared_ptr<const std::string>> events;
+    assert(first->take(events) && events.size() == 1);
+    assert(events[0]->compare(0, 22, "event: snapshot\ndata: ") == 0);
+    assert(events[0]->find("\"totalVotes\":300") != std::string::npos);
+    assert(events[0]->find("\"party\":\"Party2\",\"votes\":200") != std::string::npos);
+    events.clear();
+    second->take(events);
+    events.clear();
+    assert(hub.subscriberCount() == 2);
+    
+    int wakes = 0;
+    first->setWake([&wakes]() { wakes++; });
+    
+    // One delta, serialized once and shared by both subscribers
+    data->addRecord(ElectionRecord("Jordan", 2016, "Amman 3", "Cand3", "Party1", 50, true));
+    std::deque<std::shared_ptr<const std::string>> others;
+    assert(first->take(events) && second->take(others));
+    assert(events.size() == 1 && others.size() == 1 && events[0] == others[0]);
+    assert(events[0]->compare(0, 19, "event: delta\ndata: ") == 0);
+    assert(events[0]->find("\"votes\":150,\"seats\":2,\"totalVotes\":350") != std::string::npos);
+    assert(events[0]->find("\"candidate\":\"Cand3\"") != std::string::npos);
+    assert(wakes == 1 && hub.eventsPublished() == 1);
+    events.clear();
+    
+    // Elections nobody watches publish nothing; a cleared wake is not called
+    first->setWake(nullptr);
+    data->addRecord(ElectionRecord("Jordan", 2020, "Amman 1", "Cand1", "Party1", 10, false));
+    data->addRecord(ElectionRecord("Jordan", 2016, "Amman 4", "Cand4", "Party2", 10, false));
+    assert(hub.eventsPublished() == 2 && wakes == 1);
+    first->take(events);
+    assert(events.size() == 1);
+    events.clear();
+    
+    // A subscriber that stops reading is closed instead of queueing forever
+    for (int i = 0; i < 1100; i++) {
+        data->addRecord(ElectionRecord("Jordan", 2016, "Amman 5", "Extra" + std::to_string(i), "Party3", 1, false));
+        assert(first->take(events));
+    }
+    assert(events.size() == 1100);
+    assert(!second->take(others));
+    
+    // A reload sends every subscriber a new snapshot
+    hub.unsubscribe(second);
+    assert(hub.subscriberCount() == 1);
+    auto fresh = std::make_shared<ElectionData>();
+    fresh->addRecord(ElectionRecord("Jordan", 2016, "Amman 1", "Cand1", "Party1", 7, true));
+    hub.setData(fresh);
+    events.clear();
+    assert(first->take(events) && events.size() == 1);
+    assert(events[0]->find("\"totalVotes\":7") != std::string::npos);
+    
+    hub.closeAll();
+    assert(!first->take(events) && hub.subscriberCount() == 0);
+    data->setChangeListener(nullptr);
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+/**
+ * @brief Test cost classes and per-class limits under saturation
+ */
+void testAdmissionControl() {
+    std::cout << "Testing admission control..." << std::endl;
+    
+    assert(AdmissionControl::classify("/api/countries") == CostClass::Cheap);
+    assert(AdmissionControl::classify("/api/stats") == CostClass::Standard);
+    assert(AdmissionControl::classify("/api/unknown") == CostClass::Standard);
+    assert(AdmissionControl::classify("/api/compare") == CostClass::Heavy);
+    assert(AdmissionControl::classify("/api/batch") == CostClass::Heavy);
+    assert(std::string(AdmissionControl::className(CostClass::Heavy)) == "heavy");
+    
+    AdmissionControl admission(2, 1);
+    
+    // Limits only apply while saturated
+    assert(admission.tryAdmit(CostClass::Heavy, false));
+    assert(admission.tryAdmit(CostClass::Heavy, false));
+    assert(!admission.tryAdmit(CostClass::Heavy, true));
+    admission.release(CostClass::Heavy);
+    admission.release(CostClass::Heavy);
+    
+    {
+        // The slot is given back when the guard goes out of scope
+        assert(admission.tryAdmit(CostClass::Heavy, true));
+        AdmissionSlot slot(admission, CostClass::Heavy);
+        assert(!admission.tryAdmit(CostClass::Heavy, true));
+        assert(admission.getStats(CostClass::Heavy).inFlight == 1);
+    }
+    assert(admission.getStats(CostClass::Heavy).inFlight == 0);
+    assert(admission.tryAdmit(CostClass::Heavy, true));
+    admission.release(CostClass::Heavy);
+    
+    // Classes are limited separately; cheap requests never are
+    assert(admission.tryAdmit(CostClass::Heavy, true));
+    assert(admission.tryAdmit(CostClass::Standard, true));
+    assert(admission.tryAdmit(CostClass::Standard, true));
+    assert(!admission.tryAdmit(CostClass::Standard, true));
+    for (int i = 0; i < 100; i++) {
+        assert(admission.tryAdmit(CostClass::Cheap, true));
+    }
+    
+    CostClassStats heavy = admission.getStats(CostClass::Heavy);
+    assert(heavy.limit == 1 && heavy.inFlight == 1 && heavy.admitted == 5 && heavy.shed == 2);
+    CostClassStats standard = admission.getStats(CostClass::Standard);
+    assert(standard.limit == 2 && standard.inFlight == 2 && standard.admitted == 2 && standard.shed == 1);
+    assert(admission.getStats(CostClass::Cheap).shed == 0);
+    
+    admission.recordShedConnection();
+    assert(admission.shedConnections() == 1);
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+/**
+ * @brief Test latency histograms and the Prometheus rendering of server metrics
+ */
+void testServerMetrics() {
+    std::cout << "Testing server metrics..." << std::endl;
+    
+    // 1 to 1000 microseconds, once each
+    LatencyHistogram histogram;
+    assert(histogram.quantile(0.5) == 0);
+    for (uint64_t micros = 1; micros <= 1000; micros++) {
+        histogram.record(micros * 1000);
+    }
+    assert(histogram.count() == 1000);
+    assert(histogram.sumNanos() == 500500ULL * 1000);
+    // Bucket bounds are within about 6% of the true value
+    assert(histogram.quantile(0.5) >= 500000 && histogram.quantile(0.5) <= 535000);
+    assert(histogram.quantile(0.99) >= 990000 && histogram.quantile(0.99) <= 1060000);
+    assert(histogram.countAtMost(100000) >= 90 && histogram.countAtMost(100000) <= 100);
+    assert(histogram.countAtMost(2000000) == 1000);
+    
+    LatencyHistogram other;
+    other.record(3600ULL * 1000000000ULL);     // Past the ~18 minute cap: last bucket, still counted
+    histogram.merge(other);
+    assert(histogram.count() == 1001 && histogram.quantile(1.0) >= 1000ULL * 1000000000ULL);
+    
+    // Query strings are ignored; unknown API paths and files share slots
+    assert(ServerMetrics::endpointIndex("/api/stats?country=Jordan") == ServerMetrics::endpointIndex("/api/stats"));
+    assert(ServerMetrics::endpointIndex("/api/stats") != ServerMetrics::endpointIndex("/api/stat"));
+    assert(ServerMetrics::endpointIndex("/api/nope") == ServerMetrics::endpointIndex("/api/other-nope"));
+    assert(ServerMetrics::endpointIndex("/app.js") == ServerMetrics::endpointIndex("/"));
+    assert(ServerMetrics::endpointIndex("/app.js") != ServerMetrics::endpointIndex("/api/nope"));
+    
+    // Threads record into their own shards; render adds them up
+    ServerMetrics metrics;
+    int stats = ServerMetrics::endpointIndex("/api/stats");
+    std::thread worker([&metrics, stats]() { metrics.recordRequest(stats, 2000000, 200, 100); });
+    worker.join();
+    metrics.recordRequest(stats, 50000, 400, 20);
+    metrics.recordAPI(stats, 1500000, 500000);
+    
+    std::string text;
+    metrics.render(text);
+    assert(text.find("# TYPE election_http_requests_total counter\n") != std::string::npos);
+    assert(text.find("election_http_requests_total{endpoint=\"/api/stats\"} 2\n") != std::string::npos);
+    assert(text.find("election_http_errors_total{endpoint=\"/api/stats\"} 1\n") != std::string::npos);
+    assert(text.find("election_http_response_bytes_total{endpoint=\"/api/stats\"} 120\n") != std::string::npos);
+    assert(text.find("election_http_request_duration_seconds_bucket{endpoint=\"/api/stats\",le=\"0.0001\"} 1\n") != std::string::npos);
+    assert(text.find("election_http_request_duration_seconds_bucket{endpoint=\"/api/stats\",le=\"+Inf\"} 2\n") != std::string::npos);
+    assert(text.find("election_api_compute_seconds_total{endpoint=\"/api/stats\"} 0.0015\n") != std::string::npos);
+    // Endpoints never requested are left out
+    assert(text.find("endpoint=\"/api/cube\"") == std::string::npos);
+    
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
+static size_t countOccurrences(const std::string& text, const std::string& pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Test span recording and the Chrome trace-event export
+ */
+void testTrace() {
+    std::cout << "Testing tracing..." << std::endl;
+    
+    uint64_t before = Trace::now();
+    assert(Trace::now() >= before);
+    
+    // Earlier tests record spans too when tracing is compiled in
+    Trace::clear();
+    {
+        TraceSpan outer("test::outer");
+        TraceSpan inner("test::inner");
+    }
+    std::thread worker([]() {
+        uint64_t start = Trace::now();
+        Trace::record("test::worker", start, start + 1500);
+    });
+    worker.join();
+    
+    std::string json;
+    Trace::writeChromeJSON(json);
+    assert(json.compare(0, 16, "{\"traceEvents\":[") == 0);
+    assert(json.find("\"displayTimeUnit\":\"ms\"}") != std::string::npos);
+    if (!Trace::isEnabled()) {
+        assert(json == "{\"traceEvents\":[],\"displayTimeUnit\":\"ms\"}");
+    } else {
+        // Inner closes first; each thread gets its own tid and a name event
+        assert(countOccurrences(json, "\"ph\":\"X\"") == 3);
+        assert(countOccurrences(json, "\"ph\":\"M\"") == 2);
+        assert(json.find("test::inner") < json.find("test::outer"));
+        assert(json.find("\"name\":\"test::worker\",\"ph\":\"X\"") != std::string::npos);
+        assert(json.find("\"dur\":1.5,") != std::string::npos);
+        
+        // Each thread keeps only its most recent RING_SIZE spans
+        Trace::clear();
+        for (size_t i = 0; i < Trace::RING_SIZE + 10; i++) {
+            Trace::record("test::ring", i * 1000, i * 1000 + 1);
+        }
+        json.clear();
+        Trace::writeChromeJSON(json);
+        assert(countOccurrences(json, "\"ph\":\"X\"") == Trace::RING_SIZE);
+        assert(json.find("\"ts\":9,") == std::string::npos && json.find("\"ts\":10,") != std::string::npos);
+    }
+    
+    // Cleared buffers export an empty timeline
+    Trace::clear();
+    json.clear();
+    Trace::writeChromeJSON(json);
+    assert(json == "{\"traceEvents\":[],\"displayTimeUnit\":\"ms\"}");
+    
+    std::string error;
+    std::string path = std::filesystem::temp_directory_path().string() + "/election_tests_trace.json";
+    assert(Trace::writeChromeJSON(path, error) && readBytes(path) == json);
+    std::remove(path.c_str());
+    assert(!Trace::writeChromeJSON(path + ".missing/trace.json", error) && !error.empty());
+    
+    std::cout << "  ✓ Passed" << std::endl;
+}
+
 /**
  * @brief Run all tests
  */
@@ -226,13 +1265,31 @@ int main() {
 
     try {
         testInsertAndRetrieve();
-        testUpdate();
+        testAppendOnly();
         testGetElectionRecords();
         testGetPartyRecords();
         testStatistics();
         testPartyVoteShares();
         testComparativeAnalysis();
+        testVoteDistribution();
+        testNameSearch();
+        testCandidateHistory();
+        testElectionCube();
+        testDashboard();
+        testJSONWriter();
+        testBinaryWriter();
         testCSVReading();
+        testCSVRowValidation();
+        testLargeVoteCounts();
+        testWriteAheadLog();
+        testRequestParser();
+        testStaticAssetCache();
+        testOutputQueue();
+        testResponseCache();
+        testLiveHub();
+        testAdmissionControl();
+        testServerMetrics();
+        testTrace();
         
         std::cout << "\n";
         std::cout << "╔══════════════════════════════════════════════════════════════════════════════╗\n";
@@ -4,6 +4,11 @@ const API_BASE = 'http://localhost:8080/api';
 
 // State management
 let availableCountries = [];
+let liveSource = null;
+let lastDashboard = null;    // Last /api/dashboard reply, reused by the candidates tab
+
+// The candidates tab asks for at most this many
+const MAX_CANDIDATES = 50;
 
 // Initialize the application
 document.addEventListener('DOMContentLoaded', async () => {
@@ -112,10 +117,13 @@ async function analyzeElection() {
     }
     
     try {
-        const response = await fetch(`${API_BASE}/stats?country=${encodeURIComponent(country)}&year=${year}`);
+        // One round trip brings the stats and the candidate ranking together
+        const response = await fetch(`${API_BASE}/dashboard?country=${encodeURIComponent(country)}&year=${year}&n=${MAX_CANDIDATES}`);
         const data = await response.json();
         
+        lastDashboard = { country, year, data };
         displayElectionStats(data);
+        watchElection(country, year);
     } catch (error) {
         console.error('Error analyzing election:', error);
         showError('Failed to analyze election data');
@@ -136,6 +144,8 @@ function displayElectionStats(data) {
     
     data.parties.forEach(party => {
         const row = document.createElement('tr');
+        row.dataset.party = party.party;
+        row.dataset.votes = party.totalVotes;
         row.innerHTML = `
             <td><strong>${escapeHtml(party.party)}</strong></td>
             <td>${party.totalVotes.toLocaleString()}</td>
@@ -153,6 +163,54 @@ function displayElectionStats(data) {
     document.getElementById('stats-results').scrollIntoView({ behavior: 'smooth' });
 }
 
+// Follow live results of the shown election; each change arrives once as a delta
+function watchElection(country, year) {
+    if (liveSource) {
+        liveSource.close();
+    }
+    if (!window.EventSource) {
+        return;
+    }
+    
+    liveSource = new EventSource(`${API_BASE}/live?country=${encodeURIComponent(country)}&year=${year}`);
+    liveSource.addEventListener('snapshot', (e) => {
+        const data = JSON.parse(e.data);
+        data.parties.forEach(party => applyPartyTotals(party));
+        applyElectionTotals(data.totalVotes, data.totalSeats);
+    });
+    liveSource.addEventListener('delta', (e) => {
+        const delta = JSON.parse(e.data);
+        applyPartyTotals(delta);
+        applyElectionTotals(delta.totalVotes, delta.totalSeats);
+    });
+}
+
+// Update (or add) one party's row in place
+function applyPartyTotals(party) {
+    const tbody = document.querySelector('#party-table tbody');
+    let row = Array.from(tbody.rows).find(r => r.dataset.party === party.party);
+    if (!row) {
+        row = tbody.insertRow();
+        row.dataset.party = party.party;
+        row.innerHTML = `<td><strong>${escapeHtml(party.party)}</strong></td><td></td><td></td><td></td><td>-</td>`;
+    }
+    row.dataset.votes = party.votes;
+    row.cells[1].textContent = party.votes.toLocaleString();
+    row.cells[3].textContent = party.seats;
+}
+
+// New totals change every party's share; recompute them from the row votes
+function applyElectionTotals(totalVotes, totalSeats) {
+    document.getElementById('total-votes').textContent = totalVotes.toLocaleString();
+    document.getElementById('total-seats').textContent = totalSeats;
+    
+    const rows = document.querySelectorAll('#party-table tbody tr');
+    rows.forEach(row => {
+        const share = totalVotes > 0 ? (Number(row.dataset.votes) * 100) / totalVotes : 0;
+        row.cells[2].textContent = `${share.toFixed(2)}%`;
+    });
+}
+
 // Compare two elections
 async function compareElections() {
     const country = document.getElementById('compare-country').value;
@@ -230,6 +288,12 @@ async function showTopCandidates() {
         return;
     }
     
+    // Already fetched with the election's stats
+    if (lastDashboard && lastDashboard.country === country && lastDashboard.year === year) {
+        displayTopCandidates(lastDashboard.data.topCandidates.slice(0, count));
+        return;
+    }
+    
     try {
         const response = await fetch(`${API_BASE}/top-candidates?country=${encodeURIComponent(country)}&year=${year}&n=${count}`);
         const data = await response.json();